@@ -0,0 +1,416 @@
+/**
+ * @file bench_common.hpp
+ * @brief Shared helpers for the eAlloc benchmark programs.
+ *
+ * Provides a monotonic nanosecond clock, a cycle counter, hardware performance counters, a
+ * log-bucketed latency histogram, a small deterministic PRNG and a JSON-lines result emitter so
+ * every benchmark prints one machine-readable object per measurement.
+ * Host-only; no dependencies beyond the C++17 standard library (and Linux headers for the
+ * performance counters, which are simply absent elsewhere).
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench
+{
+
+/// Returns a monotonic timestamp in nanoseconds.
+inline uint64_t now_ns()
+{
+    using namespace std::chrono;
+    return static_cast<uint64_t>(
+        duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+/// Name of the source behind ticks(): "rdtsc" on x86, "clock_gettime" elsewhere.
+inline const char* tick_source()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return "rdtsc";
+#else
+    return "clock_gettime";
+#endif
+}
+
+/**
+ * @brief Reads a cheap, monotonic per-core tick counter for timing single operations.
+ *
+ * On x86 this is the time-stamp counter fenced on both sides so the measured operation cannot
+ * be reordered across the read; elsewhere it falls back to CLOCK_MONOTONIC_RAW in nanoseconds.
+ */
+inline uint64_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    const uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+/// Measures ticks per nanosecond against the steady clock over roughly @p window_ns.
+inline double ticks_per_ns(uint64_t window_ns = 20000000)
+{
+    const uint64_t ns0 = now_ns();
+    const uint64_t t0 = ticks();
+    while(now_ns() - ns0 < window_ns)
+    {
+    }
+    const uint64_t t1 = ticks();
+    const uint64_t ns1 = now_ns();
+    return static_cast<double>(t1 - t0) / static_cast<double>(ns1 - ns0);
+}
+
+/// Counter values of one measured phase, scaled for multiplexing; see PerfCounters.
+struct PerfSample
+{
+    enum Event
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        DTLB_MISSES,
+        BRANCH_MISSES,
+        EVENTS
+    };
+
+    double value[EVENTS] = {};
+    bool valid[EVENTS] = {};
+
+    /// Accumulates another phase, e.g. the rounds of one measurement.
+    void add(const PerfSample& other)
+    {
+        for(int e = 0; e < EVENTS; ++e)
+        {
+            if(!other.valid[e]) continue;
+            value[e] += other.value[e];
+            valid[e] = true;
+        }
+    }
+
+    /// JSON key stem of an event.
+    static const char* name(int event)
+    {
+        static const char* const names[EVENTS] = {"cycles",      "instructions", "l1d_misses",
+                                                  "llc_misses",  "dtlb_misses",  "branch_misses"};
+        return names[event];
+    }
+};
+
+/**
+ * @brief Linux perf_event_open() counters (cycles, instructions, L1D/LLC/dTLB read misses,
+ *        branch misses) for the calling thread and the threads it starts while counting.
+ *
+ * Each event is opened on its own, user space only, so a PMU or a perf_event_paranoid setting
+ * that refuses some of them still leaves the rest; the kernel multiplexes them if they do not
+ * all fit, and the values are scaled by enabled/running time. When nothing can be opened (not
+ * Linux, no PMU in a VM, paranoid level 3, EALLOC_BENCH_PERF=0) a note goes to stderr once and
+ * every sample comes back empty, so the benchmarks run unchanged without the extra fields.
+ */
+class PerfCounters
+{
+   public:
+    PerfCounters()
+    {
+        const char* env = std::getenv("EALLOC_BENCH_PERF");
+        if(env && std::strcmp(env, "0") == 0)
+        {
+            std::fprintf(stderr, "perf counters disabled by EALLOC_BENCH_PERF=0\n");
+            return;
+        }
+#if defined(__linux__)
+        const uint64_t cache = PERF_TYPE_HW_CACHE;
+        const auto read_miss = [](uint64_t cache_id) {
+            return cache_id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        const uint64_t events[PerfSample::EVENTS][2] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {cache, read_miss(PERF_COUNT_HW_CACHE_L1D)},
+            {cache, read_miss(PERF_COUNT_HW_CACHE_LL)},
+            {cache, read_miss(PERF_COUNT_HW_CACHE_DTLB)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}};
+        for(int e = 0; e < PerfSample::EVENTS; ++e)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = static_cast<uint32_t>(events[e][0]);
+            attr.config = events[e][1];
+            attr.disabled = 1;
+            attr.inherit = 1; // worker threads started inside a phase are counted too
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd_[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            opened_ += fd_[e] >= 0;
+        }
+#endif
+        if(!opened_)
+            std::fprintf(stderr, "perf counters unavailable (no PMU access; see "
+                                 "/proc/sys/kernel/perf_event_paranoid); reporting timings only\n");
+    }
+
+    ~PerfCounters()
+    {
+#if defined(__linux__)
+        for(int fd : fd_)
+            if(fd >= 0) close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /// Number of events that could be opened.
+    int available() const { return opened_; }
+
+    /// Zeroes and starts every open counter.
+    void start()
+    {
+#if defined(__linux__)
+        for(int fd : fd_)
+        {
+            if(fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    /// Stops the counters and returns what they saw since start().
+    PerfSample stop()
+    {
+        PerfSample sample;
+#if defined(__linux__)
+        for(int fd : fd_)
+            if(fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        for(int e = 0; e < PerfSample::EVENTS; ++e)
+        {
+            uint64_t data[3] = {}; // value, time enabled, time running
+            if(fd_[e] < 0 || read(fd_[e], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)))
+                continue;
+            if(!data[2]) continue; // never scheduled on the PMU
+            sample.value[e] = static_cast<double>(data[0]) * static_cast<double>(data[1])
+                              / static_cast<double>(data[2]);
+            sample.valid[e] = true;
+        }
+#endif
+        return sample;
+    }
+
+   private:
+    int fd_[PerfSample::EVENTS] = {-1, -1, -1, -1, -1, -1};
+    int opened_ = 0;
+};
+
+/// The process-wide counter set every benchmark phase is measured with.
+inline PerfCounters& perf()
+{
+    static PerfCounters counters;
+    return counters;
+}
+
+/**
+ * @brief Latency histogram with logarithmic buckets and a fixed memory footprint.
+ *
+ * Each power of two is split into SUB linear sub-buckets, so a recorded value is known to within
+ * 1/SUB of itself (12.5%) across the whole 64-bit range. Percentiles report the upper bound of the
+ * bucket they fall in, so they never understate a tail; the maximum is tracked exactly.
+ */
+class Histogram
+{
+   public:
+    static constexpr unsigned SUB_BITS = 3;
+    static constexpr unsigned SUB = 1u << SUB_BITS;
+    static constexpr unsigned BUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+    void record(uint64_t value)
+    {
+        counts_[bucket(value)]++;
+        count_++;
+        if(value > max_) max_ = value;
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t max() const { return max_; }
+
+    /// Smallest bucket bound below which at least @p q (0..1] of the samples fall.
+    uint64_t percentile(double q) const
+    {
+        if(!count_) return 0;
+        const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count_) + 0.5);
+        uint64_t seen = 0;
+        for(unsigned i = 0; i < BUCKETS; ++i)
+        {
+            seen += counts_[i];
+            if(seen >= (rank ? rank : 1)) return upper(i) < max_ ? upper(i) : max_;
+        }
+        return max_;
+    }
+
+    void clear() { *this = Histogram(); }
+
+   private:
+    static unsigned bucket(uint64_t value)
+    {
+        if(value < SUB) return static_cast<unsigned>(value);
+        const unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(value));
+        const unsigned shift = msb - SUB_BITS;
+        return (shift + 1) * SUB + static_cast<unsigned>((value >> shift) & (SUB - 1));
+    }
+
+    static uint64_t upper(unsigned index)
+    {
+        if(index < SUB) return index;
+        const unsigned shift = index / SUB - 1;
+        const uint64_t base = (uint64_t{SUB} | (index % SUB)) << shift;
+        return base + ((uint64_t{1} << shift) - 1);
+    }
+
+    uint64_t counts_[BUCKETS] = {};
+    uint64_t count_ = 0;
+    uint64_t max_ = 0;
+};
+
+/**
+ * @brief xorshift64* generator; deterministic for a given seed so runs are comparable.
+ */
+class Rng
+{
+   public:
+    explicit Rng(uint64_t seed = 0x9E3779B97F4A7C15ull) : state_(seed ? seed : 1) {}
+
+    uint64_t next()
+    {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 0x2545F4914F6CDD1Dull;
+    }
+
+    /// Uniform value in [lo, hi].
+    size_t range(size_t lo, size_t hi) { return lo + static_cast<size_t>(next() % (hi - lo + 1)); }
+
+    /// Size skewed toward small requests: uniform in [lo, hi] after a power-of-two bucket pick.
+    size_t skewed(size_t lo, size_t hi)
+    {
+        size_t top = lo;
+        while(top < hi && (next() & 1)) top <<= 1;
+        if(top > hi) top = hi;
+        return range(lo, top);
+    }
+
+    /// True with probability percent/100.
+    bool chance(unsigned percent) { return next() % 100 < percent; }
+
+   private:
+    uint64_t state_;
+};
+
+/**
+ * @brief Builds one JSON object and prints it as a single line on destruction or print().
+ *
+ * Usage: bench::Result("malloc_free").str("alloc", "eAlloc").num("ns_per_op", 12.5);
+ */
+class Result
+{
+   public:
+    explicit Result(const char* bench) { str("bench", bench); }
+    ~Result() { print(); }
+    Result(const Result&) = delete;
+    Result& operator=(const Result&) = delete;
+
+    Result& str(const char* key, const char* value)
+    {
+        key_(key);
+        line_ += '"';
+        line_ += value;
+        line_ += '"';
+        return *this;
+    }
+
+    Result& num(const char* key, double value)
+    {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.6g", value);
+        key_(key);
+        line_ += buf;
+        return *this;
+    }
+
+    /**
+     * @brief Adds "<prefix><event>_per_op" for every counter in @p sample, plus "<prefix>ipc";
+     *        adds nothing when the counters were unavailable.
+     */
+    Result& counters(const PerfSample& sample, double ops, const char* prefix = "")
+    {
+        if(ops <= 0) return *this;
+        std::string key;
+        for(int e = 0; e < PerfSample::EVENTS; ++e)
+        {
+            if(!sample.valid[e]) continue;
+            key = prefix;
+            key += PerfSample::name(e);
+            key += "_per_op";
+            num(key.c_str(), sample.value[e] / ops);
+        }
+        if(sample.valid[PerfSample::CYCLES] && sample.valid[PerfSample::INSTRUCTIONS]
+           && sample.value[PerfSample::CYCLES] > 0)
+        {
+            key = prefix;
+            key += "ipc";
+            num(key.c_str(), sample.value[PerfSample::INSTRUCTIONS] / sample.value[PerfSample::CYCLES]);
+        }
+        return *this;
+    }
+
+    void print()
+    {
+        if(printed_) return;
+        printed_ = true;
+        std::printf("{%s}\n", line_.c_str());
+        std::fflush(stdout);
+    }
+
+   private:
+    void key_(const char* key)
+    {
+        if(!line_.empty()) line_ += ',';
+        line_ += '"';
+        line_ += key;
+        line_ += "\":";
+    }
+
+    std::string line_;
+    bool printed_ = false;
+};
+
+/// Prevents the optimiser from discarding a computed value.
+inline void keep(uint64_t value)
+{
+    asm volatile("" : : "r"(value) : "memory");
+}
+
+} // namespace bench
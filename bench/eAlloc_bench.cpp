@@ -0,0 +1,301 @@
+/**
+ * @file eAlloc_bench.cpp
+ * @brief Throughput suite comparing eAlloc with the system (glibc) malloc.
+ *
+ * Workloads, each run for both allocators unless noted:
+ *   - malloc_free:    random replacement in a window of live blocks, per size distribution,
+ *   - malloc_free_mt: the same from several threads sharing one allocator (eAlloc behind its
+ *                     global lock),
+ *   - realloc_growth: buffers grown geometrically to 1 MiB, two at a time so growth cannot
+ *                     always happen in place,
+ *   - memalign:       aligned allocate/free pairs for several alignments,
+ *   - report / defragment: eAlloc only, on a deliberately fragmented heap.
+ *
+ * Every measurement is printed as one JSON object per line (see bench_common.hpp), with hardware
+ * counters per operation (cycles, instructions, cache/TLB/branch misses) where perf_event_open()
+ * is permitted.
+ * Usage: eAlloc_bench [--quick]
+ */
+#include "eAlloc.hpp"
+#include "bench_common.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t POOL_BYTES = 256u << 20;
+size_t scale = 1; // divides iteration counts under --quick
+
+/// Size distribution of a workload.
+struct Distribution
+{
+    const char* name;
+    size_t lo;
+    size_t hi;
+    bool skewed;
+
+    size_t pick(bench::Rng& rng) const { return skewed ? rng.skewed(lo, hi) : rng.range(lo, hi); }
+};
+
+const Distribution distributions[] = {{"fixed_32", 32, 32, false},
+                                      {"uniform_16_256", 16, 256, false},
+                                      {"uniform_16_4096", 16, 4096, false},
+                                      {"skewed_16_64k", 16, 64 * 1024, true}};
+
+/// System allocator.
+struct SystemAlloc
+{
+    static constexpr const char* name = "glibc";
+    void* malloc(size_t size) { return std::malloc(size); }
+    void free(void* ptr) { std::free(ptr); }
+    void* realloc(void* ptr, size_t size) { return std::realloc(ptr, size); }
+    void* memalign(size_t align, size_t size)
+    {
+        void* ptr = nullptr;
+        return posix_memalign(&ptr, align, size) == 0 ? ptr : nullptr;
+    }
+};
+
+/// eAlloc over one large pool, optionally behind a global lock.
+class EAlloc
+{
+   public:
+    static constexpr const char* name = "eAlloc";
+
+    explicit EAlloc(bool locked = false) :
+        memory_(std::malloc(POOL_BYTES)), alloc_(new dsa::eAlloc(memory_, POOL_BYTES)),
+        lock_(mutex_)
+    {
+        if(locked) alloc_->setLock(&lock_);
+    }
+    ~EAlloc()
+    {
+        alloc_.reset();
+        std::free(memory_);
+    }
+    EAlloc(const EAlloc&) = delete;
+    EAlloc& operator=(const EAlloc&) = delete;
+
+    void* malloc(size_t size) { return alloc_->malloc(size); }
+    void free(void* ptr) { alloc_->free(ptr); }
+    void* realloc(void* ptr, size_t size) { return alloc_->realloc(ptr, size); }
+    void* memalign(size_t align, size_t size) { return alloc_->memalign(align, size); }
+    dsa::eAlloc& get() { return *alloc_; }
+
+   private:
+    void* memory_;
+    std::unique_ptr<dsa::eAlloc> alloc_;
+    std::timed_mutex mutex_;
+    elock::StdMutex lock_;
+};
+
+/// Random replacement over @p window slots; returns elapsed nanoseconds for @p ops operations
+/// and, given @p counters, the hardware counters of the same span.
+template <typename Alloc>
+uint64_t churn(Alloc& alloc, const Distribution& dist, size_t window, size_t ops, uint64_t seed,
+               bench::PerfSample* counters = nullptr)
+{
+    std::vector<void*> slots(window, nullptr);
+    bench::Rng rng(seed);
+    for(size_t i = 0; i < window / 2; ++i) slots[i] = alloc.malloc(dist.pick(rng));
+    if(counters) bench::perf().start();
+    const uint64_t start = bench::now_ns();
+    for(size_t op = 0; op < ops; ++op)
+    {
+        void*& slot = slots[rng.range(0, window - 1)];
+        if(slot)
+        {
+            alloc.free(slot);
+            slot = nullptr;
+        }
+        else
+        {
+            const size_t size = dist.pick(rng);
+            slot = alloc.malloc(size);
+            if(slot) static_cast<uint8_t*>(slot)[0] = 1;
+        }
+    }
+    const uint64_t elapsed = bench::now_ns() - start;
+    if(counters) *counters = bench::perf().stop();
+    for(void* slot : slots)
+        if(slot) alloc.free(slot);
+    return elapsed;
+}
+
+template <typename Alloc>
+void malloc_free(Alloc& alloc)
+{
+    const size_t ops = 2000000 / scale;
+    for(const Distribution& dist : distributions)
+    {
+        bench::PerfSample counters;
+        const uint64_t ns = churn(alloc, dist, 1024, ops, 1, &counters);
+        bench::Result("malloc_free")
+            .str("alloc", Alloc::name)
+            .str("sizes", dist.name)
+            .num("ns_per_op", static_cast<double>(ns) / ops)
+            .counters(counters, static_cast<double>(ops));
+    }
+}
+
+template <typename Alloc>
+void malloc_free_mt(Alloc& alloc, size_t threads)
+{
+    const size_t ops = 1000000 / scale;
+    const Distribution& dist = distributions[1];
+    std::vector<std::thread> workers;
+    bench::perf().start(); // inherited by the workers
+    const uint64_t start = bench::now_ns();
+    for(size_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&alloc, &dist, ops, t]() { churn(alloc, dist, 256, ops, t + 1); });
+    }
+    for(std::thread& worker : workers) worker.join();
+    const uint64_t ns = bench::now_ns() - start;
+    const bench::PerfSample counters = bench::perf().stop();
+    bench::Result("malloc_free_mt")
+        .str("alloc", Alloc::name)
+        .str("sizes", dist.name)
+        .num("threads", static_cast<double>(threads))
+        .num("mops_per_s", static_cast<double>(ops * threads) * 1e3 / ns)
+        .counters(counters, static_cast<double>(ops * threads));
+}
+
+template <typename Alloc>
+void realloc_growth(Alloc& alloc)
+{
+    const size_t rounds = 2000 / scale;
+    constexpr size_t LIMIT = 1u << 20;
+    size_t reallocs = 0;
+    bench::perf().start();
+    const uint64_t start = bench::now_ns();
+    for(size_t r = 0; r < rounds; ++r)
+    {
+        uint8_t* a = nullptr;
+        uint8_t* b = nullptr;
+        for(size_t size = 16; size <= LIMIT; size += size / 2)
+        {
+            a = static_cast<uint8_t*>(alloc.realloc(a, size));
+            b = static_cast<uint8_t*>(alloc.realloc(b, size));
+            if(!a || !b) break;
+            a[size - 1] = b[size - 1] = 1;
+            reallocs += 2;
+        }
+        alloc.free(a);
+        alloc.free(b);
+    }
+    const uint64_t ns = bench::now_ns() - start;
+    const bench::PerfSample counters = bench::perf().stop();
+    bench::Result("realloc_growth")
+        .str("alloc", Alloc::name)
+        .num("ns_per_realloc", static_cast<double>(ns) / reallocs)
+        .counters(counters, static_cast<double>(reallocs));
+}
+
+template <typename Alloc>
+void memalign(Alloc& alloc)
+{
+    const size_t ops = 500000 / scale;
+    for(size_t align : {16u, 64u, 256u, 4096u})
+    {
+        bench::Rng rng(align);
+        size_t misaligned = 0;
+        bench::perf().start();
+        const uint64_t start = bench::now_ns();
+        for(size_t op = 0; op < ops; ++op)
+        {
+            void* ptr = alloc.memalign(align, rng.range(16, 512));
+            misaligned += (reinterpret_cast<uintptr_t>(ptr) & (align - 1)) != 0;
+            alloc.free(ptr);
+        }
+        const uint64_t ns = bench::now_ns() - start;
+        const bench::PerfSample counters = bench::perf().stop();
+        bench::Result("memalign")
+            .str("alloc", Alloc::name)
+            .num("align", static_cast<double>(align))
+            .num("ns_per_pair", static_cast<double>(ns) / ops)
+            .num("misaligned", static_cast<double>(misaligned))
+            .counters(counters, static_cast<double>(ops));
+    }
+}
+
+void report_defragment(EAlloc& alloc)
+{
+    // Fragment the heap: every other block freed leaves many small holes
+    const size_t blocks = 20000;
+    std::vector<void*> ptrs(blocks);
+    bench::Rng rng(3);
+    for(void*& ptr : ptrs) ptr = alloc.malloc(rng.range(16, 256));
+    for(size_t i = 0; i < blocks; i += 2) alloc.free(ptrs[i]);
+
+    dsa::eAlloc& heap = alloc.get();
+    for(dsa::eAlloc::ReportMode mode : {dsa::eAlloc::ReportMode::FAST, dsa::eAlloc::ReportMode::EXACT})
+    {
+        const bool fast = mode == dsa::eAlloc::ReportMode::FAST;
+        const size_t calls = (fast ? 1000000 : 200) / scale;
+        uint64_t sink = 0;
+        bench::perf().start();
+        const uint64_t start = bench::now_ns();
+        for(size_t i = 0; i < calls; ++i) sink += heap.report(mode).freeBlockCount;
+        const uint64_t ns = bench::now_ns() - start;
+        const bench::PerfSample counters = bench::perf().stop();
+        bench::keep(sink);
+        bench::Result("report")
+            .str("alloc", EAlloc::name)
+            .str("mode", fast ? "fast" : "exact")
+            .num("free_blocks", static_cast<double>(blocks / 2))
+            .num("ns_per_call", static_cast<double>(ns) / calls)
+            .counters(counters, static_cast<double>(calls));
+    }
+
+    const size_t calls = 200 / scale;
+    bench::perf().start();
+    const uint64_t start = bench::now_ns();
+    for(size_t i = 0; i < calls; ++i) heap.defragment();
+    const uint64_t ns = bench::now_ns() - start;
+    const bench::PerfSample counters = bench::perf().stop();
+    bench::Result("defragment")
+        .str("alloc", EAlloc::name)
+        .num("blocks", static_cast<double>(blocks))
+        .num("ns_per_call", static_cast<double>(ns) / calls)
+        .counters(counters, static_cast<double>(calls));
+
+    for(size_t i = 1; i < blocks; i += 2) alloc.free(ptrs[i]);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--quick") == 0) scale = 10;
+    }
+
+    {
+        EAlloc ealloc;
+        SystemAlloc system;
+        malloc_free(ealloc);
+        malloc_free(system);
+        realloc_growth(ealloc);
+        realloc_growth(system);
+        memalign(ealloc);
+        memalign(system);
+        report_defragment(ealloc);
+    }
+
+    const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    for(size_t threads = 1; threads <= std::min<size_t>(8, 2 * cores); threads *= 2)
+    {
+        EAlloc ealloc(true);
+        SystemAlloc system;
+        malloc_free_mt(ealloc, threads);
+        malloc_free_mt(system, threads);
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file freelist_order_bench.cpp
+ * @brief Compares the TLSF free-list insertion disciplines (LIFO, FIFO, address-ordered).
+ *
+ * Built once per FreeListOrder (EALLOC_FREE_LIST_ORDER). Runs an aging workload that mixes
+ * long-lived and short-lived objects, then reports:
+ *   - churn throughput (ns per malloc/free),
+ *   - fragmentation from an exact storage report,
+ *   - layout locality: the address span and high-water offset of the live set, plus the time to
+ *     sweep every live object,
+ *   - hardware counters per churn operation and per swept object (cache/TLB misses explain the
+ *     locality differences) where perf_event_open() is permitted.
+ */
+#include "eAlloc.hpp"
+#include "bench_common.hpp"
+#include <cstdlib>
+#include <vector>
+
+#define BENCH_STR2(x) #x
+#define BENCH_STR(x) BENCH_STR2(x)
+
+namespace
+{
+
+constexpr size_t POOL_BYTES = 8u << 20;
+constexpr size_t SLOTS = 8192;
+constexpr size_t LONG_LIVED = SLOTS / 5;
+constexpr size_t CHURN_OPS = 400000;
+constexpr int SWEEPS = 20;
+
+struct Slot
+{
+    uint8_t* ptr = nullptr;
+    size_t size = 0;
+};
+
+} // namespace
+
+int main()
+{
+    void* pool = std::malloc(POOL_BYTES);
+    if(!pool) return 1;
+    dsa::eAlloc alloc(pool, POOL_BYTES);
+    std::vector<Slot> slots(SLOTS);
+    bench::Rng rng(42);
+
+    // Long-lived objects are allocated interleaved with the churn and never freed.
+    size_t long_lived = 0;
+    bench::perf().start();
+    uint64_t start = bench::now_ns();
+    for(size_t op = 0; op < CHURN_OPS; ++op)
+    {
+        if(long_lived < LONG_LIVED && rng.chance(2))
+        {
+            Slot& s = slots[long_lived++];
+            s.size = rng.skewed(16, 512);
+            s.ptr = static_cast<uint8_t*>(alloc.malloc(s.size));
+            if(s.ptr) memset(s.ptr, 1, s.size);
+            continue;
+        }
+        Slot& s = slots[rng.range(LONG_LIVED, SLOTS - 1)];
+        if(s.ptr)
+        {
+            alloc.free(s.ptr);
+            s.ptr = nullptr;
+        }
+        else
+        {
+            s.size = rng.skewed(16, 1024);
+            s.ptr = static_cast<uint8_t*>(alloc.malloc(s.size));
+        }
+    }
+    const uint64_t churn_ns = bench::now_ns() - start;
+    const bench::PerfSample churn_counters = bench::perf().stop();
+
+    // Locality of the long-lived set.
+    uintptr_t lo = UINTPTR_MAX, hi = 0;
+    size_t live_bytes = 0;
+    for(size_t i = 0; i < long_lived; ++i)
+    {
+        const Slot& s = slots[i];
+        if(!s.ptr) continue;
+        const uintptr_t a = reinterpret_cast<uintptr_t>(s.ptr);
+        lo = a < lo ? a : lo;
+        hi = a + s.size > hi ? a + s.size : hi;
+        live_bytes += s.size;
+    }
+    uint64_t sum = 0;
+    bench::perf().start();
+    start = bench::now_ns();
+    for(int pass = 0; pass < SWEEPS; ++pass)
+    {
+        for(size_t i = 0; i < long_lived; ++i)
+        {
+            const Slot& s = slots[i];
+            if(!s.ptr) continue;
+            for(size_t b = 0; b < s.size; b += 64) sum += s.ptr[b];
+        }
+    }
+    const uint64_t sweep_ns = bench::now_ns() - start;
+    const bench::PerfSample sweep_counters = bench::perf().stop();
+    bench::keep(sum);
+
+    uintptr_t top = 0;
+    for(const Slot& s : slots)
+    {
+        if(!s.ptr) continue;
+        const uintptr_t end = reinterpret_cast<uintptr_t>(s.ptr) + s.size;
+        top = end > top ? end : top;
+    }
+
+    const dsa::eAlloc::StorageReport sr = alloc.report(dsa::eAlloc::ReportMode::EXACT);
+    bench::Result("freelist_order")
+        .str("order", BENCH_STR(EALLOC_FREE_LIST_ORDER))
+        .num("churn_ns_per_op", static_cast<double>(churn_ns) / CHURN_OPS)
+        .num("fragmentation", sr.fragmentationFactor)
+        .num("free_blocks", static_cast<double>(sr.freeBlockCount))
+        .num("largest_free", static_cast<double>(sr.largestFreeRegion))
+        .num("long_lived_span_ratio", live_bytes ? static_cast<double>(hi - lo) / live_bytes : 0.0)
+        .num("high_water_offset", static_cast<double>(top - reinterpret_cast<uintptr_t>(pool)))
+        .num("sweep_ns_per_object", static_cast<double>(sweep_ns) / (SWEEPS * long_lived))
+        .counters(churn_counters, CHURN_OPS, "churn_")
+        .counters(sweep_counters, static_cast<double>(SWEEPS * long_lived), "sweep_");
+
+    for(Slot& s : slots)
+        if(s.ptr) alloc.free(s.ptr);
+    std::free(pool);
+    return 0;
+}
@@ -0,0 +1,394 @@
+/**
+ * @file mt_workloads_bench.cpp
+ * @brief Classic multi-threaded allocator stress workloads, run against eAlloc behind its global
+ *        lock, eAlloc with per-pool locks, and the system (glibc) malloc for reference.
+ *
+ * Workloads (after the Hoard / mimalloc-bench versions):
+ *   - larson:        server simulation; each thread replaces random blocks in its own array, and
+ *                    the arrays rotate between threads every round, so blocks are freed by a
+ *                    thread other than the one that allocated them,
+ *   - threadtest:    each thread allocates a batch of fixed-size objects, then frees them all,
+ *   - cache_scratch: passive false sharing; each thread first frees a small object allocated by
+ *                    the main thread, then allocates, writes and frees objects of that size,
+ *   - cache_thrash:  active false sharing; the same loop without the hand-off,
+ *   - xmalloc:       producer/consumer; producers allocate, consumers on other threads free,
+ *   - aging:         long-running churn with short-, medium- and long-lived blocks, reporting
+ *                    fragmentation after every phase to show how the heap ages.
+ * eAlloc runs over POOLS equally ranked pools; in per_pool mode each pool has its own lock and
+ * malloc passes over pools held by other threads.
+ *
+ * Every measurement is printed as one JSON object per line (see bench_common.hpp), with hardware
+ * counters per operation summed over all worker threads where perf_event_open() is permitted.
+ * Usage: eAlloc_bench_mt [--quick] [--threads N] [--only WORKLOAD]
+ */
+#include "eAlloc.hpp"
+#include "bench_common.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t POOLS = 8;
+constexpr size_t POOL_BYTES = 16u << 20;
+size_t scale = 1; // divides iteration counts under --quick
+
+/// Allocator under test; implementations must be thread-safe.
+class Heap
+{
+   public:
+    virtual ~Heap() = default;
+    virtual const char* name() const = 0;
+    virtual void* malloc(size_t size) = 0;
+    virtual void free(void* ptr) = 0;
+    /// Fragmentation figures of an idle heap; false if the allocator has none.
+    virtual bool report(double&, size_t&) { return false; }
+};
+
+class SystemHeap : public Heap
+{
+   public:
+    const char* name() const override { return "glibc"; }
+    void* malloc(size_t size) override { return std::malloc(size); }
+    void free(void* ptr) override { std::free(ptr); }
+};
+
+/// eAlloc over POOLS pools, behind the global lock or one lock per pool.
+class EAllocHeap : public Heap
+{
+   public:
+    explicit EAllocHeap(bool per_pool) : per_pool_(per_pool), global_(global_mutex_)
+    {
+        for(size_t i = 0; i < POOLS; ++i)
+        {
+            memory_[i] = std::malloc(POOL_BYTES);
+            pool_mutex_[i].reset(new std::timed_mutex);
+            pool_lock_[i].reset(new elock::StdMutex(*pool_mutex_[i]));
+        }
+        alloc_.reset(new dsa::eAlloc(memory_[0], POOL_BYTES));
+        for(size_t i = 1; i < POOLS; ++i) alloc_->add_pool(memory_[i], POOL_BYTES);
+        alloc_->setLock(&global_);
+        if(per_pool)
+        {
+            for(size_t i = 0; i < POOLS; ++i) alloc_->setLockForPool(i, pool_lock_[i].get());
+            alloc_->setPerPoolLocking(true);
+        }
+    }
+    ~EAllocHeap() override
+    {
+        alloc_.reset();
+        for(void* memory : memory_) std::free(memory);
+    }
+
+    const char* name() const override { return per_pool_ ? "eAlloc_per_pool" : "eAlloc_global"; }
+    void* malloc(size_t size) override { return alloc_->malloc(size); }
+    void free(void* ptr) override { alloc_->free(ptr); }
+    bool report(double& fragmentation, size_t& largest_free) override
+    {
+        const dsa::eAlloc::StorageReport sr = alloc_->report(dsa::eAlloc::ReportMode::EXACT);
+        fragmentation = sr.fragmentationFactor;
+        largest_free = sr.largestFreeRegion;
+        return true;
+    }
+
+   private:
+    bool per_pool_;
+    void* memory_[POOLS] = {};
+    std::unique_ptr<dsa::eAlloc> alloc_;
+    std::timed_mutex global_mutex_;
+    elock::StdMutex global_;
+    std::unique_ptr<std::timed_mutex> pool_mutex_[POOLS];
+    std::unique_ptr<elock::StdMutex> pool_lock_[POOLS];
+};
+
+/// Runs @p body(t) on @p threads threads and returns the wall time in nanoseconds; the
+/// workers' hardware counters are added to @p counters.
+template <typename Body>
+uint64_t run_threads(size_t threads, Body body, bench::PerfSample& counters)
+{
+    std::vector<std::thread> workers;
+    bench::perf().start(); // inherited by the workers
+    const uint64_t start = bench::now_ns();
+    for(size_t t = 0; t < threads; ++t) workers.emplace_back(body, t);
+    for(std::thread& worker : workers) worker.join();
+    const uint64_t ns = bench::now_ns() - start;
+    counters.add(bench::perf().stop());
+    return ns;
+}
+
+void touch(void* ptr, size_t size)
+{
+    if(ptr) std::memset(ptr, 0xA5, size < 64 ? size : 64);
+}
+
+void larson(Heap& heap, size_t threads)
+{
+    constexpr size_t SLOTS = 1000;
+    const size_t rounds = 10;
+    const size_t ops = 200000 / scale; // per thread and round
+    std::vector<std::vector<void*>> arrays(threads, std::vector<void*>(SLOTS, nullptr));
+    for(size_t t = 0; t < threads; ++t)
+    {
+        bench::Rng rng(t + 1);
+        for(void*& slot : arrays[t]) slot = heap.malloc(rng.range(16, 256));
+    }
+    std::atomic<size_t> failures{0};
+    uint64_t ns = 0;
+    bench::PerfSample counters;
+    for(size_t round = 0; round < rounds; ++round)
+    {
+        // Arrays rotate, so most frees hit blocks another thread allocated
+        ns += run_threads(threads, [&](size_t t) {
+            std::vector<void*>& slots = arrays[(t + round) % threads];
+            bench::Rng rng((round + 1) * 7919 + t);
+            for(size_t op = 0; op < ops; ++op)
+            {
+                void*& slot = slots[rng.range(0, SLOTS - 1)];
+                heap.free(slot);
+                const size_t size = rng.range(16, 256);
+                slot = heap.malloc(size);
+                if(!slot) failures++;
+                touch(slot, size);
+            }
+        }, counters);
+    }
+    for(std::vector<void*>& slots : arrays)
+        for(void* slot : slots) heap.free(slot);
+    bench::Result("larson")
+        .str("alloc", heap.name())
+        .num("threads", static_cast<double>(threads))
+        .num("mops_per_s", static_cast<double>(rounds * ops * threads) * 1e3 / ns)
+        .num("failures", static_cast<double>(failures.load()))
+        .counters(counters, static_cast<double>(rounds * ops * threads));
+}
+
+void threadtest(Heap& heap, size_t threads)
+{
+    constexpr size_t OBJECTS = 10000;
+    constexpr size_t SIZE = 64;
+    const size_t iterations = 100 / scale;
+    bench::PerfSample counters;
+    const uint64_t ns = run_threads(threads, [&](size_t) {
+        std::vector<void*> objects(OBJECTS);
+        for(size_t it = 0; it < iterations; ++it)
+        {
+            for(void*& obj : objects)
+            {
+                obj = heap.malloc(SIZE);
+                touch(obj, SIZE);
+            }
+            for(void* obj : objects) heap.free(obj);
+        }
+    }, counters);
+    bench::Result("threadtest")
+        .str("alloc", heap.name())
+        .num("threads", static_cast<double>(threads))
+        .num("mops_per_s", static_cast<double>(2 * iterations * OBJECTS * threads) * 1e3 / ns)
+        .counters(counters, static_cast<double>(2 * iterations * OBJECTS * threads));
+}
+
+/// Allocates, writes and frees small objects; @p handoff seeds each thread with a block
+/// allocated by the main thread (cache-scratch), else not (cache-thrash).
+void cache_sharing(Heap& heap, size_t threads, bool handoff)
+{
+    constexpr size_t SIZE = 8;
+    constexpr size_t WRITES = 1000;
+    const size_t iterations = 20000 / scale;
+    std::vector<void*> seeds(threads, nullptr);
+    if(handoff)
+        for(void*& seed : seeds) seed = heap.malloc(SIZE);
+    bench::PerfSample counters;
+    const uint64_t ns = run_threads(threads, [&](size_t t) {
+        heap.free(seeds[t]);
+        for(size_t it = 0; it < iterations; ++it)
+        {
+            volatile char* obj = static_cast<volatile char*>(heap.malloc(SIZE));
+            if(!obj) continue;
+            for(size_t w = 0; w < WRITES; ++w) obj[w % SIZE] = static_cast<char>(obj[w % SIZE] + 1);
+            heap.free(const_cast<char*>(obj));
+        }
+    }, counters);
+    bench::Result(handoff ? "cache_scratch" : "cache_thrash")
+        .str("alloc", heap.name())
+        .num("threads", static_cast<double>(threads))
+        .num("ms", static_cast<double>(ns) / 1e6)
+        .counters(counters, static_cast<double>(iterations * threads)); // per malloc/write/free
+}
+
+/// Batches of blocks handed from one producer to its consumer.
+struct Channel
+{
+    std::mutex mutex;
+    std::vector<void*> blocks;
+    bool done = false;
+};
+
+void xmalloc(Heap& heap, size_t threads)
+{
+    constexpr size_t BATCH = 64;
+    if(threads < 2) return; // needs a producer and a consumer
+    const size_t pairs = threads / 2;
+    const size_t blocks = 1000000 / scale; // per producer
+    std::vector<std::unique_ptr<Channel>> channels;
+    for(size_t i = 0; i < pairs; ++i) channels.emplace_back(new Channel);
+    std::atomic<size_t> freed{0};
+    bench::PerfSample counters;
+    const uint64_t ns = run_threads(2 * pairs, [&](size_t t) {
+        Channel& channel = *channels[t / 2];
+        std::vector<void*> batch;
+        if(t % 2 == 0)
+        {
+            bench::Rng rng(t + 1);
+            for(size_t i = 0; i < blocks; ++i)
+            {
+                const size_t size = rng.skewed(16, 1024);
+                void* ptr = heap.malloc(size);
+                touch(ptr, size);
+                batch.push_back(ptr);
+                if(batch.size() == BATCH || i + 1 == blocks)
+                {
+                    std::lock_guard<std::mutex> guard(channel.mutex);
+                    channel.blocks.insert(channel.blocks.end(), batch.begin(), batch.end());
+                    batch.clear();
+                }
+            }
+            std::lock_guard<std::mutex> guard(channel.mutex);
+            channel.done = true;
+            return;
+        }
+        for(bool done = false; !done;)
+        {
+            {
+                std::lock_guard<std::mutex> guard(channel.mutex);
+                batch.swap(channel.blocks);
+                done = channel.done && batch.empty();
+            }
+            if(batch.empty()) std::this_thread::yield();
+            for(void* ptr : batch) heap.free(ptr);
+            freed += batch.size();
+            batch.clear();
+        }
+    }, counters);
+    bench::Result("xmalloc")
+        .str("alloc", heap.name())
+        .num("threads", static_cast<double>(2 * pairs))
+        .num("mops_per_s", static_cast<double>(freed.load()) * 1e3 / ns)
+        .counters(counters, static_cast<double>(freed.load()));
+}
+
+void aging(Heap& heap, size_t threads)
+{
+    constexpr size_t PHASES = 8;
+    // The live set is split between the threads so its size does not grow with the thread count
+    const size_t SLOTS = 16384 / threads;
+    const size_t ops = 400000 / scale; // per thread and phase
+    struct Slot
+    {
+        void* ptr = nullptr;
+        size_t expires = 0; ///< Operation count after which the block may be freed.
+    };
+    std::vector<std::vector<Slot>> live(threads, std::vector<Slot>(SLOTS));
+    std::vector<size_t> clock(threads, 0);
+    for(size_t phase = 0; phase < PHASES; ++phase)
+    {
+        std::atomic<size_t> failures{0};
+        bench::PerfSample counters;
+        const uint64_t ns = run_threads(threads, [&](size_t t) {
+            std::vector<Slot>& slots = live[t];
+            bench::Rng rng((phase + 1) * 104729 + t);
+            for(size_t op = 0; op < ops; ++op, ++clock[t])
+            {
+                Slot& slot = slots[rng.range(0, SLOTS - 1)];
+                if(slot.ptr && clock[t] < slot.expires) continue;
+                heap.free(slot.ptr);
+                // Mostly short-lived blocks of any size; the few long-lived ones pin the pools
+                const unsigned kind = static_cast<unsigned>(rng.range(0, 99));
+                const size_t size = kind < 70   ? rng.skewed(16, 16384)
+                                    : kind < 95 ? rng.skewed(16, 4096)
+                                                : rng.range(64, 2048);
+                const size_t lifetime = kind < 70 ? 100 : kind < 95 ? 20000 : 2000000;
+                slot.ptr = heap.malloc(size);
+                slot.expires = clock[t] + rng.range(1, lifetime);
+                if(!slot.ptr) failures++;
+                touch(slot.ptr, size);
+            }
+        }, counters);
+        double fragmentation = 0.0;
+        size_t largest_free = 0;
+        bench::Result result("aging");
+        result.str("alloc", heap.name())
+            .num("threads", static_cast<double>(threads))
+            .num("phase", static_cast<double>(phase))
+            .num("mops_per_s", static_cast<double>(ops * threads) * 1e3 / ns)
+            .num("failures", static_cast<double>(failures.load()))
+            .counters(counters, static_cast<double>(ops * threads));
+        if(heap.report(fragmentation, largest_free))
+            result.num("fragmentation", fragmentation).num("largest_free", static_cast<double>(largest_free));
+    }
+    for(std::vector<Slot>& slots : live)
+        for(Slot& slot : slots) heap.free(slot.ptr);
+}
+
+struct Workload
+{
+    const char* name;
+    void (*run)(Heap&, size_t);
+};
+
+const Workload workloads[] = {
+    {"larson", larson},
+    {"threadtest", threadtest},
+    {"cache_scratch", [](Heap& heap, size_t threads) { cache_sharing(heap, threads, true); }},
+    {"cache_thrash", [](Heap& heap, size_t threads) { cache_sharing(heap, threads, false); }},
+    {"xmalloc", xmalloc},
+    {"aging", aging},
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t max_threads = std::thread::hardware_concurrency();
+    if(max_threads < 2) max_threads = 2;
+    if(max_threads > 16) max_threads = 16;
+    std::string only;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--quick") == 0)
+            scale = 10;
+        else if(std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            max_threads = std::strtoul(argv[++i], nullptr, 0);
+        else if(std::strcmp(argv[i], "--only") == 0 && i + 1 < argc)
+            only = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "usage: eAlloc_bench_mt [--quick] [--threads N] [--only WORKLOAD]\n");
+            return 2;
+        }
+    }
+
+    for(const Workload& workload : workloads)
+    {
+        if(!only.empty() && only != workload.name) continue;
+        for(size_t threads = 1; threads <= max_threads; threads *= 2)
+        {
+            // A fresh heap per run, so no workload inherits another's fragmentation
+            {
+                SystemHeap heap;
+                workload.run(heap, threads);
+            }
+            for(bool per_pool : {false, true})
+            {
+                EAllocHeap heap(per_pool);
+                workload.run(heap, threads);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file placement_bench.cpp
+ * @brief Compares the eAlloc pool placement strategies (priority, fullest-first, least-loaded,
+ *        round-robin).
+ *
+ * Every strategy runs the same aging workload over several equally ranked pools and reports:
+ *   - churn throughput (ns per malloc/free),
+ *   - fragmentation from an exact storage report,
+ *   - drainable pools: pools left without live blocks once the short-lived objects are freed
+ *     (what remove_pool() could hand back),
+ *   - contention proxy: share of allocations served by the busiest pool and the number of
+ *     pool switches between consecutive allocations (each switch is a per-pool lock hand-off),
+ *   - hardware counters per churn operation where perf_event_open() is permitted.
+ */
+#include "eAlloc.hpp"
+#include "bench_common.hpp"
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t POOLS = 8;
+constexpr size_t POOL_BYTES = 512u * 1024;
+constexpr size_t SLOTS = 16384;
+constexpr size_t LONG_LIVED = SLOTS / 8;
+constexpr size_t CHURN_OPS = 400000;
+
+struct Slot
+{
+    void* ptr = nullptr;
+    size_t size = 0;
+};
+
+struct Strategy
+{
+    const char* name;
+    dsa::eAlloc::PlacementStrategy value;
+};
+
+void run(const Strategy& strategy, std::vector<uint8_t*>& pools)
+{
+    dsa::eAlloc alloc(pools[0], POOL_BYTES);
+    for(size_t i = 1; i < POOLS; ++i) alloc.add_pool(pools[i], POOL_BYTES);
+    alloc.setPlacementStrategy(strategy.value);
+
+    std::vector<Slot> slots(SLOTS);
+    size_t served[POOLS] = {0};
+    size_t switches = 0;
+    size_t failures = 0;
+    size_t last_pool = POOLS;
+    bench::Rng rng(7);
+
+    auto allocate = [&](Slot& s, size_t size) {
+        s.size = size;
+        s.ptr = alloc.malloc(size);
+        if(!s.ptr)
+        {
+            failures++;
+            return;
+        }
+        const size_t pool = alloc.get_pool_index(alloc.get_pool(s.ptr));
+        served[pool]++;
+        switches += (last_pool != POOLS && pool != last_pool);
+        last_pool = pool;
+    };
+
+    size_t long_lived = 0;
+    bench::perf().start();
+    const uint64_t start = bench::now_ns();
+    for(size_t op = 0; op < CHURN_OPS; ++op)
+    {
+        if(long_lived < LONG_LIVED && rng.chance(1))
+        {
+            allocate(slots[long_lived++], rng.skewed(16, 512));
+            continue;
+        }
+        Slot& s = slots[rng.range(LONG_LIVED, SLOTS - 1)];
+        if(s.ptr)
+        {
+            alloc.free(s.ptr);
+            s.ptr = nullptr;
+        }
+        else
+        {
+            allocate(s, rng.skewed(16, 2048));
+        }
+    }
+    const uint64_t churn_ns = bench::now_ns() - start;
+    const bench::PerfSample counters = bench::perf().stop();
+    const dsa::eAlloc::StorageReport sr = alloc.report(dsa::eAlloc::ReportMode::EXACT);
+
+    // Drop the short-lived set and see which pools only the long-lived objects pin
+    for(size_t i = LONG_LIVED; i < SLOTS; ++i)
+    {
+        if(slots[i].ptr) alloc.free(slots[i].ptr);
+        slots[i].ptr = nullptr;
+    }
+    bool pinned[POOLS] = {false};
+    for(size_t i = 0; i < long_lived; ++i)
+    {
+        if(slots[i].ptr) pinned[alloc.get_pool_index(alloc.get_pool(slots[i].ptr))] = true;
+    }
+    size_t drainable = 0;
+    size_t busiest = 0;
+    size_t total = 0;
+    for(size_t i = 0; i < POOLS; ++i)
+    {
+        drainable += !pinned[i];
+        busiest = served[i] > busiest ? served[i] : busiest;
+        total += served[i];
+    }
+
+    bench::Result("placement")
+        .str("strategy", strategy.name)
+        .num("churn_ns_per_op", static_cast<double>(churn_ns) / CHURN_OPS)
+        .num("fragmentation", sr.fragmentationFactor)
+        .num("free_blocks", static_cast<double>(sr.freeBlockCount))
+        .num("failures", static_cast<double>(failures))
+        .num("drainable_pools", static_cast<double>(drainable))
+        .num("busiest_pool_share", total ? static_cast<double>(busiest) / total : 0.0)
+        .num("pool_switches_per_alloc", total ? static_cast<double>(switches) / total : 0.0)
+        .counters(counters, CHURN_OPS, "churn_");
+
+    for(size_t i = 0; i < long_lived; ++i)
+        if(slots[i].ptr) alloc.free(slots[i].ptr);
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<uint8_t*> pools(POOLS);
+    for(uint8_t*& pool : pools)
+    {
+        pool = static_cast<uint8_t*>(std::malloc(POOL_BYTES));
+        if(!pool) return 1;
+    }
+    using Placement = dsa::eAlloc::PlacementStrategy;
+    const Strategy strategies[] = {{"priority", Placement::PRIORITY},
+                                   {"fullest_first", Placement::FULLEST_FIRST},
+                                   {"least_loaded", Placement::LEAST_LOADED},
+                                   {"round_robin", Placement::ROUND_ROBIN}};
+    for(const Strategy& strategy : strategies) run(strategy, pools);
+    for(uint8_t* pool : pools) std::free(pool);
+    return 0;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file Logger.hpp
+ * @brief No-op stand-in for the Logger library used by the benchmark targets.
+ *
+ * Benchmarks measure the allocator, not logging, and must configure without network access, so
+ * they build against this header instead of the fetched Logger. Every LOG call compiles away.
+ */
+#pragma once
+
+namespace LOG
+{
+
+template <typename... Args>
+inline void ERROR(const Args&...)
+{
+}
+template <typename... Args>
+inline void WARNING(const Args&...)
+{
+}
+template <typename... Args>
+inline void INFO(const Args&...)
+{
+}
+template <typename... Args>
+inline void SUCCESS(const Args&...)
+{
+}
+template <typename... Args>
+inline void DEBUG(const Args&...)
+{
+}
+template <typename... Args>
+inline void TRACE(const Args&...)
+{
+}
+
+} // namespace LOG
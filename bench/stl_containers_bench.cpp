@@ -0,0 +1,340 @@
+/**
+ * @file stl_containers_bench.cpp
+ * @brief Standard containers over dsa::StackAllocator, an eAlloc-backed allocator and
+ *        std::allocator (glibc).
+ *
+ * Each container (vector, list, map, unordered_map, deque of 64-bit values) runs the same
+ * phases, and every (container, allocator) pair prints one JSON line with:
+ *   - insert:        ELEMENTS random values appended or inserted (ns per insert),
+ *   - iterate:       ITERATE_PASSES sums over the fresh container (ns per element visited),
+ *   - erase:         every other element in iteration order removed (ns per erased element),
+ *   - reinsert:      as many new values inserted again, reusing the freed memory,
+ *   - aged_iterate:  the iterate phase again over the aged layout,
+ *   - bytes_per_element: allocator bytes consumed per element after insert, headers and
+ *                    container slack included (the pool's in-use bytes for eAlloc, glibc's
+ *                    mallinfo2() for std::allocator),
+ *   - adjacent_ratio / aged_adjacent_ratio: share of consecutive elements in iteration order
+ *                    that lie within one cache line of each other, a layout-only locality
+ *                    measure that does not need hardware counters,
+ *   - hardware counters per operation of every phase where perf_event_open() is permitted.
+ *
+ * StackAllocator keeps its pool inside the allocator object and builds a fresh pool whenever it
+ * is rebound to another type, so a container may only ever use the one instance it holds.
+ * libstdc++'s deque and unordered_map allocate their map/bucket arrays through temporary rebound
+ * copies, which StackAllocator cannot serve; those pairs are reported as unsupported rather
+ * than run. StackAllocator bytes_per_element equals eAlloc's (same blocks) and is not measured,
+ * since its pool cannot be reached from outside the container without a copy.
+ *
+ * Usage: eAlloc_bench_stl [--quick]
+ */
+#include "StackAllocator.hpp"
+#include "eAlloc.hpp"
+#include "bench_common.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace
+{
+
+constexpr size_t HEAP_BYTES = 64u << 20;
+constexpr size_t STACK_POOL_BYTES = 16u << 20;
+constexpr int ITERATE_PASSES = 10;
+size_t elements = 100000; // reduced under --quick
+
+/// Heap the EAllocAllocator instances of the current run draw from, rebuilt for every run.
+void* arena = nullptr;
+std::unique_ptr<dsa::eAlloc> current_heap;
+
+/**
+ * @brief Minimal std allocator over one eAlloc; all instances share current_heap, so rebound
+ *        copies and temporaries are interchangeable.
+ */
+template <typename T>
+struct EAllocAllocator
+{
+    using value_type = T;
+
+    EAllocAllocator() = default;
+    template <typename U>
+    EAllocAllocator(const EAllocAllocator<U>&)
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        void* ptr = current_heap->malloc(n * sizeof(T));
+        if(!ptr) throw std::bad_alloc();
+        return static_cast<T*>(ptr);
+    }
+    void deallocate(T* ptr, size_t n) { current_heap->free_sized(ptr, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const EAllocAllocator<U>&) const
+    {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const EAllocAllocator<U>&) const
+    {
+        return false;
+    }
+};
+
+template <typename T>
+using StackAlloc = dsa::StackAllocator<T, STACK_POOL_BYTES>;
+
+/// Per-allocator setup around each run and the bytes handed out so far (0 when it cannot tell).
+struct SystemBackend
+{
+    static constexpr const char* name = "std::allocator";
+    template <typename T>
+    using alloc = std::allocator<T>;
+    static void begin() {}
+    static void end() {}
+    static size_t used()
+    {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+        const struct mallinfo2 info = mallinfo2();
+        return info.uordblks + info.hblkhd; // large vectors are mmap()ed outside the arenas
+#else
+        return 0;
+#endif
+    }
+};
+
+struct EAllocBackend
+{
+    static constexpr const char* name = "eAlloc";
+    template <typename T>
+    using alloc = EAllocAllocator<T>;
+    static void begin() { current_heap.reset(new dsa::eAlloc(arena, HEAP_BYTES)); }
+    static void end() { current_heap.reset(); }
+    static size_t used() { return current_heap->pool_stats(0).in_use; }
+};
+
+struct StackBackend
+{
+    static constexpr const char* name = "StackAllocator";
+    template <typename T>
+    using alloc = StackAlloc<T>;
+    static void begin() {}
+    static void end() {}
+    static size_t used() { return 0; }
+};
+
+// Container operations, overloaded per container kind.
+template <typename C>
+void insert(C& c, uint64_t value)
+{
+    c.push_back(value);
+}
+template <typename K, typename V, typename Cmp, typename A>
+void insert(std::map<K, V, Cmp, A>& c, uint64_t value)
+{
+    c.emplace(value, value);
+}
+template <typename K, typename V, typename H, typename E, typename A>
+void insert(std::unordered_map<K, V, H, E, A>& c, uint64_t value)
+{
+    c.emplace(value, value);
+}
+
+inline const uint64_t& element(const uint64_t& value) { return value; }
+template <typename K>
+const uint64_t& element(const std::pair<const K, uint64_t>& entry)
+{
+    return entry.second;
+}
+
+/// Removes every other element in iteration order; returns the number removed.
+template <typename C>
+size_t erase_half(C& c)
+{
+    size_t erased = 0;
+    for(auto it = c.begin(); it != c.end();)
+    {
+        it = c.erase(it);
+        erased++;
+        if(it != c.end()) ++it;
+    }
+    return erased;
+}
+/// Sequence containers drop the odd positions in one compacting pass instead of O(n^2) erases.
+template <typename C>
+size_t erase_compacting(C& c)
+{
+    size_t keep = 0;
+    for(size_t i = 0; i < c.size(); i += 2) c[keep++] = c[i];
+    const size_t erased = c.size() - keep;
+    c.erase(c.begin() + static_cast<ptrdiff_t>(keep), c.end());
+    return erased;
+}
+template <typename T, typename A>
+size_t erase_half(std::vector<T, A>& c)
+{
+    return erase_compacting(c);
+}
+template <typename T, typename A>
+size_t erase_half(std::deque<T, A>& c)
+{
+    return erase_compacting(c);
+}
+
+struct Walk
+{
+    uint64_t sum = 0;
+    size_t adjacent = 0;
+    size_t visited = 0;
+};
+
+template <typename C>
+Walk walk(const C& c)
+{
+    Walk w;
+    const char* last = nullptr;
+    for(const auto& entry : c)
+    {
+        const uint64_t& value = element(entry);
+        const char* here = reinterpret_cast<const char*>(&value);
+        if(last)
+        {
+            const ptrdiff_t stride = here - last;
+            w.adjacent += stride >= -64 && stride <= 64;
+        }
+        last = here;
+        w.sum += value;
+        w.visited++;
+    }
+    return w;
+}
+
+/// Times @p passes walks; returns ns per element and the counters of the span.
+template <typename C>
+double iterate(const C& c, int passes, bench::PerfSample& counters, Walk& last)
+{
+    uint64_t sum = 0;
+    bench::perf().start();
+    const uint64_t start = bench::now_ns();
+    for(int pass = 0; pass < passes; ++pass)
+    {
+        last = walk(c);
+        sum += last.sum;
+    }
+    const uint64_t ns = bench::now_ns() - start;
+    counters = bench::perf().stop();
+    bench::keep(sum);
+    return last.visited ? static_cast<double>(ns) / (static_cast<double>(last.visited) * passes) : 0.0;
+}
+
+template <typename Backend, typename C>
+void run(const char* container)
+{
+    Backend::begin();
+    bench::Rng rng(12345);
+    const size_t used_before = Backend::used();
+    std::unique_ptr<C> c(new C()); // large for StackAllocator: its pool is inside the container
+
+    bench::PerfSample insert_counters, iterate_counters, erase_counters, reinsert_counters, aged_counters;
+    bench::perf().start();
+    uint64_t start = bench::now_ns();
+    for(size_t i = 0; i < elements; ++i) insert(*c, rng.next());
+    const uint64_t insert_ns = bench::now_ns() - start;
+    insert_counters = bench::perf().stop();
+    const size_t used = Backend::used() - used_before;
+
+    Walk fresh, aged;
+    const double iterate_ns = iterate(*c, ITERATE_PASSES, iterate_counters, fresh);
+
+    bench::perf().start();
+    start = bench::now_ns();
+    const size_t erased = erase_half(*c);
+    const uint64_t erase_ns = bench::now_ns() - start;
+    erase_counters = bench::perf().stop();
+
+    bench::perf().start();
+    start = bench::now_ns();
+    for(size_t i = 0; i < erased; ++i) insert(*c, rng.next());
+    const uint64_t reinsert_ns = bench::now_ns() - start;
+    reinsert_counters = bench::perf().stop();
+
+    const double aged_ns = iterate(*c, ITERATE_PASSES, aged_counters, aged);
+    const double passes = static_cast<double>(ITERATE_PASSES);
+
+    bench::Result result("stl");
+    result.str("container", container)
+        .str("alloc", Backend::name)
+        .num("supported", 1)
+        .num("elements", static_cast<double>(elements))
+        .num("insert_ns_per_op", static_cast<double>(insert_ns) / elements)
+        .num("iterate_ns_per_element", iterate_ns)
+        .num("erase_ns_per_op", erased ? static_cast<double>(erase_ns) / erased : 0.0)
+        .num("reinsert_ns_per_op", erased ? static_cast<double>(reinsert_ns) / erased : 0.0)
+        .num("aged_iterate_ns_per_element", aged_ns)
+        .num("adjacent_ratio", fresh.visited > 1 ? static_cast<double>(fresh.adjacent) / (fresh.visited - 1) : 0.0)
+        .num("aged_adjacent_ratio", aged.visited > 1 ? static_cast<double>(aged.adjacent) / (aged.visited - 1) : 0.0);
+    if(used) result.num("bytes_per_element", static_cast<double>(used) / elements);
+    result.counters(insert_counters, static_cast<double>(elements), "insert_")
+        .counters(iterate_counters, static_cast<double>(fresh.visited) * passes, "iterate_")
+        .counters(erase_counters, static_cast<double>(erased), "erase_")
+        .counters(reinsert_counters, static_cast<double>(erased), "reinsert_")
+        .counters(aged_counters, static_cast<double>(aged.visited) * passes, "aged_iterate_");
+    c.reset();
+    Backend::end();
+}
+
+void unsupported(const char* container, const char* alloc, const char* reason)
+{
+    bench::Result("stl").str("container", container).str("alloc", alloc).num("supported", 0).str("reason", reason);
+}
+
+template <typename Backend>
+void run_node_and_vector()
+{
+    using A = typename Backend::template alloc<uint64_t>;
+    using PairA = typename Backend::template alloc<std::pair<const uint64_t, uint64_t>>;
+    run<Backend, std::vector<uint64_t, A>>("vector");
+    run<Backend, std::list<uint64_t, A>>("list");
+    run<Backend, std::map<uint64_t, uint64_t, std::less<uint64_t>, PairA>>("map");
+}
+
+template <typename Backend>
+void run_all()
+{
+    using A = typename Backend::template alloc<uint64_t>;
+    using PairA = typename Backend::template alloc<std::pair<const uint64_t, uint64_t>>;
+    run_node_and_vector<Backend>();
+    run<Backend, std::unordered_map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, PairA>>(
+        "unordered_map");
+    run<Backend, std::deque<uint64_t, A>>("deque");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--quick") == 0) elements = 10000;
+    }
+
+    arena = std::malloc(HEAP_BYTES);
+    if(!arena) return 1;
+    run_all<SystemBackend>();
+    run_all<EAllocBackend>();
+    run_node_and_vector<StackBackend>();
+    const char* reason = "libstdc++ allocates its map/bucket array through temporary rebound "
+                         "copies, each of which would own a separate StackAllocator pool";
+    unsupported("unordered_map", StackBackend::name, reason);
+    unsupported("deque", StackBackend::name, reason);
+    std::free(arena);
+    return 0;
+}
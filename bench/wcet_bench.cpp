@@ -0,0 +1,324 @@
+/**
+ * @file wcet_bench.cpp
+ * @brief Worst-case latency harness: per-operation tick counts for eAlloc in log-bucketed
+ *        histograms, reported as p50/p99/p99.9/max.
+ *
+ * Every operation is timed on its own with bench::ticks() (fenced rdtsc on x86,
+ * clock_gettime elsewhere) and recorded into a bench::Histogram per heap state and operation.
+ * Heap states:
+ *   - fresh:            one empty pool,
+ *   - fragmented:       pool filled with random sizes, then every other block freed at random,
+ *   - fragmented_cold:  as fragmented, with the data cache evicted before every operation,
+ *   - holes:            many tiny holes between live blocks while requests are large, so every
+ *                       allocation splits and every free merges on both sides,
+ *   - many_pools:       more pools than the inline registry holds, all but the lowest ranked one
+ *                       exhausted, so each allocation walks the whole route,
+ * plus add_pool timed while filling the inline registry and while growing past it.
+ * Pool buffers are pre-faulted so page faults do not masquerade as allocator latency.
+ *
+ * Operations inside a state are mixed: malloc, memalign (16..4096 alignment), realloc (shrink or
+ * grow, in place or moving) and free. realloc copies at most 8 KiB, so its tail includes the copy.
+ * The tick source overhead is reported as op "timer" and is not subtracted. Where perf_event_open()
+ * is permitted, "wcet_counters" adds hardware counters per operation of each state; they cover
+ * the whole loop (random numbers, and the cache eviction of the cold state, included).
+ *
+ * Usage: eAlloc_bench_wcet [--quick] [--cpu N]
+ * Pin to an isolated core (--cpu) for numbers worth certifying against.
+ */
+#include "eAlloc.hpp"
+#include "bench_common.hpp"
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace
+{
+
+constexpr size_t POOL_BYTES = 64u << 20;
+constexpr size_t EVICT_BYTES = 32u << 20;
+size_t scale = 1; // divides sample counts under --quick
+double tick_ns = 1.0;
+
+enum Op
+{
+    MALLOC,
+    MEMALIGN,
+    REALLOC,
+    FREE,
+    OP_COUNT
+};
+const char* const op_names[OP_COUNT] = {"malloc", "memalign", "realloc", "free"};
+
+void print(const char* state, const char* op, const bench::Histogram& h)
+{
+    bench::Result("wcet")
+        .str("state", state)
+        .str("op", op)
+        .str("ticks", bench::tick_source())
+        .num("samples", static_cast<double>(h.count()))
+        .num("p50", static_cast<double>(h.percentile(0.5)))
+        .num("p99", static_cast<double>(h.percentile(0.99)))
+        .num("p99_9", static_cast<double>(h.percentile(0.999)))
+        .num("max", static_cast<double>(h.max()))
+        .num("p99_9_ns", h.percentile(0.999) / tick_ns)
+        .num("max_ns", h.max() / tick_ns);
+}
+
+/// Request shape of a state.
+struct Workload
+{
+    size_t min_size;
+    size_t max_size;
+    bool cold; // evict the data cache before every operation
+};
+
+/// One owned pool buffer, pre-faulted as a real-time system would lock it in memory.
+struct Buffer
+{
+    explicit Buffer(size_t bytes) : ptr(static_cast<uint8_t*>(std::malloc(bytes)))
+    {
+        if(ptr) std::memset(ptr, 0, bytes);
+    }
+    ~Buffer() { std::free(ptr); }
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+    uint8_t* ptr;
+};
+
+void evict(std::vector<uint8_t>& scratch)
+{
+    // One write per cache line pushes the allocator's metadata out of every level
+    for(size_t i = 0; i < scratch.size(); i += 64) scratch[i]++;
+}
+
+/**
+ * @brief Random mixed operations over @p slots; each operation timed individually.
+ *
+ * Empty slots are filled by malloc (or memalign one time in five); live slots are freed or, one
+ * time in four, reallocated to a new size.
+ */
+void churn(const char* state, dsa::eAlloc& alloc, std::vector<void*>& slots, const Workload& w,
+           size_t ops, uint64_t seed)
+{
+    bench::Histogram hist[OP_COUNT];
+    bench::Rng rng(seed);
+    std::vector<uint8_t> scratch(w.cold ? EVICT_BYTES : 0);
+    size_t failures = 0;
+
+    bench::perf().start();
+    for(size_t i = 0; i < ops; ++i)
+    {
+        void*& slot = slots[rng.range(0, slots.size() - 1)];
+        const size_t size = rng.range(w.min_size, w.max_size);
+        Op op;
+        if(!slot)
+            op = rng.chance(20) ? MEMALIGN : MALLOC;
+        else
+            op = rng.chance(25) ? REALLOC : FREE;
+        const size_t align = size_t{16} << rng.range(0, 8);
+        if(w.cold) evict(scratch);
+
+        void* result = nullptr;
+        const uint64_t t0 = bench::ticks();
+        switch(op)
+        {
+            case MALLOC: result = alloc.malloc(size); break;
+            case MEMALIGN: result = alloc.memalign(align, size); break;
+            case REALLOC: result = alloc.realloc(slot, size); break;
+            case FREE: alloc.free(slot); break;
+            default: break;
+        }
+        const uint64_t t1 = bench::ticks();
+        hist[op].record(t1 - t0);
+
+        if(op == FREE)
+            slot = nullptr;
+        else if(result)
+            slot = result;
+        else
+            failures++; // a failed realloc leaves the slot as it was
+    }
+    const bench::PerfSample counters = bench::perf().stop();
+
+    for(int op = 0; op < OP_COUNT; ++op) print(state, op_names[op], hist[op]);
+    if(bench::perf().available())
+        bench::Result("wcet_counters").str("state", state).counters(counters, static_cast<double>(ops));
+    if(failures)
+        bench::Result("wcet_failures").str("state", state).num("failures", static_cast<double>(failures));
+}
+
+void release(dsa::eAlloc& alloc, std::vector<void*>& slots)
+{
+    for(void*& slot : slots)
+    {
+        if(slot) alloc.free(slot);
+        slot = nullptr;
+    }
+}
+
+void timer_overhead()
+{
+    bench::Histogram hist;
+    const size_t samples = 1000000 / scale;
+    for(size_t i = 0; i < samples; ++i)
+    {
+        const uint64_t t0 = bench::ticks();
+        const uint64_t t1 = bench::ticks();
+        hist.record(t1 - t0);
+    }
+    print("none", "timer", hist);
+}
+
+void single_pool_states()
+{
+    Buffer pool(POOL_BYTES);
+    if(!pool.ptr) return;
+    const size_t ops = 2000000 / scale;
+
+    {
+        dsa::eAlloc alloc(pool.ptr, POOL_BYTES);
+        std::vector<void*> slots(4096, nullptr);
+        churn("fresh", alloc, slots, {16, 4096, false}, ops, 1);
+        release(alloc, slots);
+    }
+
+    for(bool cold : {false, true})
+    {
+        // Fill to roughly 90%, then free a random half of the blocks
+        dsa::eAlloc alloc(pool.ptr, POOL_BYTES);
+        bench::Rng rng(2);
+        std::vector<void*> slots;
+        size_t used = 0;
+        while(used < POOL_BYTES / 10 * 9)
+        {
+            const size_t size = rng.range(16, 4096);
+            void* ptr = alloc.malloc(size);
+            if(!ptr) break;
+            slots.push_back(ptr);
+            used += size;
+        }
+        for(void*& slot : slots)
+        {
+            if(rng.chance(50))
+            {
+                alloc.free(slot);
+                slot = nullptr;
+            }
+        }
+        churn(cold ? "fragmented_cold" : "fragmented", alloc, slots, {16, 4096, cold},
+              cold ? ops / 20 : ops, 3);
+        release(alloc, slots);
+    }
+
+    {
+        // Live 256-byte blocks separated by 16..64-byte holes; requests are 1..8 KiB
+        dsa::eAlloc alloc(pool.ptr, POOL_BYTES);
+        bench::Rng rng(4);
+        std::vector<void*> holes;
+        std::vector<void*> slots;
+        for(;;)
+        {
+            void* hole = alloc.malloc(rng.range(16, 64));
+            void* live = alloc.malloc(256);
+            if(!hole || !live)
+            {
+                if(hole) alloc.free(hole);
+                if(live) alloc.free(live);
+                break;
+            }
+            holes.push_back(hole);
+            slots.push_back(live);
+            if(slots.size() * 320 > POOL_BYTES / 2) break;
+        }
+        for(void* hole : holes) alloc.free(hole);
+        // Churn over an evenly spaced subset; freeing one of those merges a hole on each side
+        std::vector<void*> window;
+        for(size_t i = 0; i < slots.size(); i += slots.size() / 2048)
+        {
+            window.push_back(slots[i]);
+            slots[i] = nullptr;
+        }
+        churn("holes", alloc, window, {1024, 8192, false}, ops, 5);
+        release(alloc, window);
+        release(alloc, slots);
+    }
+}
+
+void many_pools_state()
+{
+    constexpr size_t POOLS = 3 * dsa::MAX_POOL;
+    constexpr size_t SMALL_POOL = 256u * 1024;
+    std::vector<std::unique_ptr<Buffer>> pools;
+    for(size_t i = 0; i < POOLS; ++i) pools.emplace_back(new Buffer(i + 1 < POOLS ? SMALL_POOL : POOL_BYTES));
+
+    dsa::eAlloc alloc(pools[0]->ptr, SMALL_POOL);
+    for(size_t i = 1; i + 1 < POOLS; ++i)
+        alloc.add_pool(pools[i]->ptr, SMALL_POOL, dsa::eAlloc::PoolConfig(1));
+
+    // Exhaust every small pool before the large, lowest ranked one exists
+    std::vector<void*> pinned;
+    for(void* ptr; (ptr = alloc.malloc(16)) != nullptr;) pinned.push_back(ptr);
+    alloc.add_pool(pools.back()->ptr, POOL_BYTES, dsa::eAlloc::PoolConfig(-1));
+
+    std::vector<void*> slots(4096, nullptr);
+    churn("many_pools", alloc, slots, {16, 512, false}, 1000000 / scale, 6);
+    release(alloc, slots);
+    release(alloc, pinned);
+}
+
+void add_pool_state()
+{
+    constexpr size_t POOLS = 4 * dsa::MAX_POOL;
+    constexpr size_t POOL = 64u * 1024;
+    std::vector<std::unique_ptr<Buffer>> pools;
+    for(size_t i = 0; i < POOLS; ++i) pools.emplace_back(new Buffer(POOL));
+
+    bench::Histogram inline_registry;
+    bench::Histogram grown_registry;
+    const size_t rounds = 20000 / scale;
+    for(size_t r = 0; r < rounds; ++r)
+    {
+        dsa::eAlloc alloc(pools[0]->ptr, POOL);
+        for(size_t i = 1; i < POOLS; ++i)
+        {
+            const uint64_t t0 = bench::ticks();
+            void* added = alloc.add_pool(pools[i]->ptr, POOL);
+            const uint64_t t1 = bench::ticks();
+            if(!added) break;
+            (i < dsa::MAX_POOL ? inline_registry : grown_registry).record(t1 - t0);
+        }
+    }
+    print("inline_registry", "add_pool", inline_registry);
+    print("grown_registry", "add_pool", grown_registry);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--quick") == 0) scale = 10;
+#if defined(__linux__)
+        if(std::strcmp(argv[i], "--cpu") == 0 && i + 1 < argc)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(std::atoi(argv[++i]), &set);
+            if(sched_setaffinity(0, sizeof(set), &set) != 0) std::perror("sched_setaffinity");
+        }
+#endif
+    }
+
+    tick_ns = bench::ticks_per_ns();
+    bench::Result("wcet_clock").str("ticks", bench::tick_source()).num("ticks_per_ns", tick_ns);
+
+    timer_overhead();
+    single_pool_states();
+    many_pools_state();
+    add_pool_state();
+    return 0;
+}
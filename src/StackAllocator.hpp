@@ -20,7 +20,8 @@ namespace dsa
  * @brief Standard C++ allocator interface using a stack-allocated buffer and TLSF.
  *
  * @tparam T Type of object to allocate.
- * @tparam PoolSize Size of the internal stack buffer in bytes.
+ * @tparam PoolSize Bytes of the internal stack buffer available to the pool; the buffer also
+ *         holds the pool's TLSF control (eAlloc::pool_control_bytes()) on top of them.
  *
  * Usage:
  *   dsa::StackAllocator<int, 1024> alloc; // No lock
@@ -59,7 +60,7 @@ class StackAllocator
     /**
      * @brief Constructor initializes the stack allocator with a fixed-size buffer.
      */
-    StackAllocator() : allocator(memoryPool, PoolSize)
+    StackAllocator() : allocator(memoryPool, BUFFER_BYTES)
     {
         // Use setLock or the lock constructor if thread safety is needed
     }
@@ -68,7 +69,7 @@ class StackAllocator
      * @brief Constructor initializes the stack allocator with a specific lock instance.
      * @param lock Pointer to a lock instance to be used for thread safety.
      */
-    StackAllocator(elock::ILockable* lock) : allocator(memoryPool, PoolSize)
+    StackAllocator(elock::ILockable* lock) : allocator(memoryPool, BUFFER_BYTES)
     {
         allocator.setLock(lock);
     }
@@ -78,7 +79,7 @@ class StackAllocator
      * @tparam U Other type for rebind.
      */
     template <typename U>
-    StackAllocator(const StackAllocator<U, PoolSize>&) : allocator(memoryPool, PoolSize)
+    StackAllocator(const StackAllocator<U, PoolSize>&) : allocator(memoryPool, BUFFER_BYTES)
     {
         // Use setLock or the lock constructor if thread safety is needed
     }
@@ -102,10 +103,9 @@ class StackAllocator
     /**
      * @brief Deallocates storage previously allocated by this allocator.
      * @param p Pointer to the memory to deallocate.
-     * @note The number of objects parameter is present for interface compliance
-     *       but is not used by this specific deallocation function.
+     * @param n Number of objects passed to allocate(); forwarded as a sized free.
      */
-    void deallocate(pointer p, size_type /*n*/) { allocator.free(p); }
+    void deallocate(pointer p, size_type n) { allocator.free_sized(p, n * sizeof(T)); }
 
     /**
      * @brief Constructs an object of type T at the given memory location.
@@ -192,7 +192,8 @@ class StackAllocator
     }
 
    private:
-    char memoryPool[PoolSize]; ///< Stack-allocated memory pool
+    static constexpr size_t BUFFER_BYTES = dsa::eAlloc::pool_control_bytes() + PoolSize;
+    alignas(std::max_align_t) char memoryPool[BUFFER_BYTES]; ///< Stack-allocated memory pool
     dsa::eAlloc allocator;     ///< Internal TLSF allocator managing the pool
 };
 
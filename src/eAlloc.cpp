@@ -5,10 +5,53 @@
  * See eAlloc.hpp for API, usage, and thread safety notes.
  */
  #include "eAlloc.hpp"
+ #if defined(__SSE2__)
+     #include <emmintrin.h>
+ #endif
 
  namespace dsa
  {
  
+ namespace
+ {
+ /*
+  * Copies a large, non-overlapping region with non-temporal stores so the destination does not
+  * displace the working set. Falls back to memcpy where streaming stores are unavailable.
+  */
+ void stream_copy(void* dst, const void* src, size_t len)
+ {
+ #if defined(__SSE2__)
+     char* d = static_cast<char*>(dst);
+     const char* s = static_cast<const char*>(src);
+     const size_t head = (16 - (reinterpret_cast<uintptr_t>(d) & 15)) & 15;
+     if(head >= len)
+     {
+         memcpy(d, s, len);
+         return;
+     }
+     memcpy(d, s, head);
+     d += head;
+     s += head;
+     len -= head;
+     for(; len >= 64; len -= 64, d += 64, s += 64)
+     {
+         const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+         const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+         const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+         const __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+         _mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+         _mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+         _mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+         _mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+     }
+     _mm_sfence();
+     memcpy(d, s, len);
+ #else
+     memcpy(dst, src, len);
+ #endif
+ }
+ } // namespace
+ 
  eAlloc::eAlloc(void* memory, size_t bytes)
  {
      pool_count = 0;
@@ -26,17 +69,28 @@
  #if defined(EALLOC_ENABLE_OWNERSHIP_TAG) && EALLOC_ENABLE_OWNERSHIP_TAG
      ownership_tag_ = 0;
  #endif
+     records_ = inline_records_;
+     pool_order_ = inline_order_;
+     registry_capacity_ = MAX_POOL;
+     for(size_t p = 0; p < POLICY_COUNT; ++p)
+     {
+         route_head_[p] = INVALID_POOL_INDEX;
+         route_lead_[p] = 0;
+     }
      for(size_t i = 0; i < MAX_POOL; ++i)
      {
-         tlsf::initialise_control(&controls[i]);
-         pool_configs[i] = PoolConfig();
-         memory_pools[i] = nullptr;
-         pool_sizes[i] = 0;
-         pool_locks_[i] = nullptr;
+         inline_records_[i] = PoolRecord();
      }
+ #if EALLOC_INLINE_CONTROLS
+     for(size_t i = 0; i < INLINE_CONTROLS; ++i)
+     {
+         tlsf::initialise_control(&inline_controls_[i]);
+         inline_control_used_[i] = false;
+     }
+ #endif
      if(!add_pool(memory, bytes))
      {
-         LOG::ERROR("E_ALLOC", "Failed to initialize allocator with initial pool (%p, %zu bytes).\n",
+         EALLOC_LOG_ERROR("E_ALLOC", "Failed to initialize allocator with initial pool (%p, %zu bytes).\n",
                     memory, bytes);
      }
      else
@@ -45,44 +99,79 @@
      }
  }
  
- void* eAlloc::add_pool(void* mem, size_t bytes, const PoolConfig& config)
+ bool eAlloc::setup_pool(PoolRecord& pool, void* mem, size_t bytes, const PoolConfig& config)
  {
- #if !EALLOC_NO_LOCKING
-     if(usePerPoolLocking_ && pool_count < MAX_POOL && pool_locks_[pool_count])
+     size_t pool_overhead = tlsf::pool_overhead();
+     size_t align_size = tlsf::align_size();
+     size_t min_block_size = tlsf::min_block_size();
+     size_t max_block_size = tlsf::max_block_size();
+     if((reinterpret_cast<ptrdiff_t>(mem) % align_size) != 0)
      {
-         elock::LockGuard guard(*pool_locks_[pool_count]);
+         EALLOC_LOG_ERROR("E_ALLOC", "add_pool: Memory must be aligned by %zu bytes", align_size);
+         return false;
      }
-     else if(lock_)
+ 
+     // Bytes taken by a control placed at the head of the pool
+     const uintptr_t base = reinterpret_cast<uintptr_t>(mem);
+     const size_t embedded =
+         tlsf::align_up(tlsf::align_up(base, alignof(Control)) + sizeof(Control), alignof(Control))
+         - base;
+     const bool fits = bytes > embedded + pool_overhead + min_block_size;
+ #if EALLOC_INLINE_CONTROLS
+     size_t slot = INLINE_CONTROLS;
+     for(size_t i = 0; i < INLINE_CONTROLS; ++i)
      {
-         elock::LockGuard guard(*lock_);
+         if(!inline_control_used_[i])
+         {
+             slot = i;
+             break;
+         }
      }
- #endif
-     if(pool_count >= MAX_POOL)
+     const bool embed =
+         fits && (bytes >= EMBED_CONTROL_FACTOR * sizeof(Control) || slot == INLINE_CONTROLS);
+     if(!embed && slot == INLINE_CONTROLS)
      {
-         LOG::ERROR("E_ALLOC", "Maximum number of pools (%d) reached.\n", MAX_POOL);
-         return nullptr;
+         EALLOC_LOG_ERROR("E_ALLOC", "add_pool: All %zu inline control slots are in use and %zu bytes "
+                    "cannot hold a control (%zu bytes).\n", INLINE_CONTROLS, bytes, embedded);
+         return false;
      }
- 
-     size_t pool_overhead = tlsf::pool_overhead();
-     size_t align_size = tlsf::align_size();
-     size_t min_block_size = tlsf::min_block_size();
-     size_t max_block_size = tlsf::max_block_size();
-     size_t alloc_overhead = tlsf::alloc_overhead();
- 
-     const size_t pool_bytes = tlsf::align_down(bytes - pool_overhead, align_size);
-     if((reinterpret_cast<ptrdiff_t>(mem) % align_size) != 0)
+ #else
+     const bool embed = true;
+     if(!fits)
      {
-         LOG::ERROR("E_ALLOC", "add_pool: Memory must be aligned by %zu bytes", align_size);
-         return nullptr;
+         EALLOC_LOG_ERROR("E_ALLOC", "add_pool: %zu bytes cannot hold the pool's control (%zu bytes); "
+                    "the minimum pool is %zu bytes.\n", bytes, embedded, min_pool_size());
+         return false;
      }
+ #endif
  
-     if(pool_bytes < min_block_size || pool_bytes > max_block_size)
+     char* heap = static_cast<char*>(mem) + (embed ? embedded : 0);
+     const size_t heap_bytes = bytes - (embed ? embedded : 0);
+     const size_t pool_bytes = tlsf::align_down(heap_bytes - pool_overhead, align_size);
+     if(heap_bytes < pool_overhead || pool_bytes < min_block_size || pool_bytes > max_block_size)
      {
-         LOG::ERROR("E_ALLOC", "add_pool: Memory size must be between %zu and %zu bytes.\n",
+         EALLOC_LOG_ERROR("E_ALLOC", "add_pool: Memory size must be between %zu and %zu bytes.\n",
                     static_cast<unsigned int>(pool_overhead + min_block_size),
                     static_cast<unsigned int>(pool_overhead + max_block_size));
-         return nullptr;
+         return false;
+     }
+ 
+     Control* control = nullptr;
+     if(embed)
+     {
+         control = new(reinterpret_cast<void*>(tlsf::align_up(base, alignof(Control)))) Control();
      }
+ #if EALLOC_INLINE_CONTROLS
+     else
+     {
+         inline_control_used_[slot] = true;
+         control = &inline_controls_[slot];
+     }
+ #endif
+     tlsf::initialise_control(control);
+ #if EALLOC_ENABLE_CLASS_STATS
+     control->class_counters = class_counters_;
+ #endif
  
      /*
       ** Create the main free block. Offset the start of the block slightly
@@ -90,70 +179,208 @@
       ** it will never be used.
       */
  
-     BlockHeader* block =
-         tlsf::offset_to_block_nc(mem, -static_cast<tlsf::tlsfptr_t>(alloc_overhead));
+     BlockHeader* block = tlsf::first_block(heap);
  
      tlsf::set_size(block, pool_bytes);
      tlsf::set_free(block);
      tlsf::set_prev_used(block);
-     tlsf::insert(&controls[pool_count], block);
      /* Split the block to create a zero-size sentinel block. */
      BlockHeader* next = tlsf::link_next(block);
      tlsf::set_size(next, 0);
      tlsf::set_used(next);
      tlsf::set_prev_free(next);
+     /* The whole pool starts out as the wilderness. */
+     tlsf::insert(control, block);
+ 
+     pool.control = control;
+     pool.memory = mem;
+     pool.heap = heap;
+     pool.bytes = bytes;
+     pool.size = pool_bytes;
+     pool.config = config;
+     pool.zero_mark = config.zeroed ? heap : static_cast<char*>(mem) + bytes;
+     pool.peak_in_use = 0;
+     pool.allocations = 0;
+     pool.failures = 0;
+     return true;
+ }
+ 
+ void eAlloc::release_control(PoolRecord& pool)
+ {
+ #if EALLOC_INLINE_CONTROLS
+     if(pool.control >= inline_controls_ && pool.control < inline_controls_ + INLINE_CONTROLS)
+     {
+         const size_t slot = static_cast<size_t>(pool.control - inline_controls_);
+         tlsf::initialise_control(pool.control);
+         inline_control_used_[slot] = false;
+     }
+ #endif
+     pool.control = nullptr;
+ }
+ 
+ void* eAlloc::allocate_internal(PoolRecord& pool, size_t size)
+ {
+     const size_t adjusted = tlsf::adjust_request_size(size, tlsf::align_size());
+     BlockHeader* block = tlsf::locate_free(pool.control, adjusted);
+     if(!block) return nullptr;
+     void* ptr = tlsf::prepare_used(pool.control, block, adjusted);
+     raise_zero_mark(pool, ptr);
+     count_alloc(ptr, size);
+     return ptr;
+ }
+ 
+ void* eAlloc::allocate_from(size_t pool_index, size_t adjusted, size_t size, char** prev_zero_mark,
+                             bool wait)
+ {
+ #if !EALLOC_NO_LOCKING
+     elock::ILockable* lock = pool_lock(pool_index);
+     elock::OptionalLockGuard guard(lock, wait ? 0xFFFFFFFF : 0);
+     if(lock && !wait && !guard.acquired()) return nullptr;
+ #else
+     (void)wait;
+ #endif
+     PoolRecord& pool = records_[pool_index];
+     BlockHeader* block = tlsf::locate_free(pool.control, adjusted);
+     if(!block)
+     {
+         pool.failures++;
+         return nullptr;
+     }
+     void* ptr = tlsf::prepare_used(pool.control, block, adjusted);
+     char* mark = raise_zero_mark(pool, ptr);
+     if(prev_zero_mark) *prev_zero_mark = mark;
+     note_pool_alloc(pool);
+     count_alloc(ptr, size);
+     return ptr;
+ }
+ 
+ void eAlloc::note_pool_alloc(PoolRecord& pool)
+ {
+     pool.allocations++;
+     raise_pool_peak(pool);
+ }
+ 
+ void eAlloc::raise_pool_peak(PoolRecord& pool)
+ {
+     // Used blocks and every header are what the pool no longer has free
+     const size_t in_use = pool.size - pool.control->free_bytes;
+     if(in_use > pool.peak_in_use) pool.peak_in_use = in_use;
+ }
+ 
+ bool eAlloc::move_registry(size_t capacity, size_t skip, PoolRecord* pending)
+ {
+     PoolRecord* records = inline_records_;
+     size_t* order = inline_order_;
+     if(capacity > MAX_POOL)
+     {
+         const size_t bytes = capacity * (sizeof(PoolRecord) + sizeof(size_t));
+         void* storage = nullptr;
+         for(size_t i = 0; i < pool_count && !storage; ++i)
+         {
+             if(i != skip) storage = allocate_internal(records_[i], bytes);
+         }
+         if(!storage && pending) storage = allocate_internal(*pending, bytes);
+         if(!storage) return false;
+         records = static_cast<PoolRecord*>(storage);
+         order = reinterpret_cast<size_t*>(records + capacity);
+     }
+     else if(records_ == inline_records_)
+     {
+         return true;
+     }
+ 
+     const size_t keep = dsa_min(capacity, registry_capacity_);
+     PoolRecord* old = records_;
+     for(size_t i = 0; i < capacity; ++i)
+     {
+         new(&records[i]) PoolRecord(i < keep ? old[i] : PoolRecord());
+     }
+     records_ = records;
+     pool_order_ = order;
+     registry_capacity_ = capacity;
+     rebuild_pool_order();
+     if(old != inline_records_)
+     {
+         free_in_pool(old, find_pool_index(old));
+     }
+     return true;
+ }
+ 
+ void* eAlloc::add_pool(void* mem, size_t bytes, const PoolConfig& config)
+ {
+ #if !EALLOC_NO_LOCKING
+     if(registry_fixed("add_pool")) return nullptr;
+     elock::OptionalLockGuard guard(lock_);
+ #endif
+     PoolRecord pool;
+     if(!setup_pool(pool, mem, bytes, config))
+     {
+         return nullptr;
+     }
+     if(pool_count == registry_capacity_
+        && !move_registry(registry_capacity_ * 2, INVALID_POOL_INDEX, &pool))
+     {
+         EALLOC_LOG_ERROR("E_ALLOC", "add_pool: No room to grow the pool registry beyond %zu pools.\n",
+                    registry_capacity_);
+         release_control(pool);
+         return nullptr;
+     }
  
-     memory_pools[pool_count] = mem;
-     pool_sizes[pool_count] = pool_bytes;
-     pool_configs[pool_count] = config;
+ #if !EALLOC_NO_LOCKING
+     pool.lock = records_[pool_count].lock;
+ #endif
+     records_[pool_count] = pool;
      pool_count++;
-     LOG::SUCCESS("E_ALLOC", "Added pool %p (%zu bytes). Total pools: %d\n", mem, bytes, pool_count);
+     rebuild_pool_order();
+     EALLOC_LOG_SUCCESS("E_ALLOC", "Added pool %p (%zu bytes). Total pools: %d\n", mem, bytes, pool_count);
+     Observer::on_pool_add(*this, mem, bytes);
      return mem;
  }
  
  void eAlloc::remove_pool(void* pool)
  {
  #if !EALLOC_NO_LOCKING
-     size_t poolIndex = get_pool_index(pool);
-     if(usePerPoolLocking_ && poolIndex < MAX_POOL && pool_locks_[poolIndex])
+     if(registry_fixed("remove_pool")) return;
+     elock::OptionalLockGuard guard(lock_);
+ #endif
+     const size_t i = get_pool_index(pool);
+     if(i == INVALID_POOL_INDEX)
      {
-         elock::LockGuard guard(*pool_locks_[poolIndex]);
+         EALLOC_LOG_ERROR("E_ALLOC", "Pool %p not found.\n", pool);
+         return;
      }
-     else if(lock_)
+     // The registry may live in this pool; move it elsewhere before checking for live blocks
+     if(records_ != inline_records_ && find_pool_index(records_) == i
+        && !move_registry(registry_capacity_, i, nullptr))
      {
-         elock::LockGuard guard(*lock_);
+         EALLOC_LOG_ERROR("E_ALLOC", "Cannot remove pool %p: no room to relocate the pool registry.\n",
+                    pool);
+         return;
      }
- #endif
-     for(size_t i = 0; i < pool_count; ++i)
+ 
+     BlockHeader* block = tlsf::first_block(records_[i].heap);
+     BlockHeader* next = tlsf::next(block);
+     if(!tlsf::is_free(block) || tlsf::get_size(block) != records_[i].size
+        || !tlsf::is_last(next))
      {
-         if(memory_pools[i] == pool)
-         {
-             BlockHeader* block =
-                 tlsf::offset_to_block_nc(pool, -static_cast<int>(tlsf::alloc_overhead()));
-             BlockHeader* next = tlsf::next(block);
-             if(!tlsf::is_free(block) || tlsf::get_size(block) != pool_sizes[i]
-                || !tlsf::is_last(next))
-             {
-                 LOG::ERROR("E_ALLOC", "Cannot remove pool %p: it contains allocated blocks.\n",
-                            pool);
-                 return;
-             }
-             int fl = 0, sl = 0;
-             tlsf::mapping_insert(tlsf::get_size(block), &fl, &sl);
-             tlsf::remove_free_block(&controls[i], block, fl, sl);
-             if(i < pool_count - 1)
-             {
-                 memory_pools[i] = memory_pools[pool_count - 1];
-                 pool_sizes[i] = pool_sizes[pool_count - 1];
-                 pool_configs[i] = pool_configs[pool_count - 1];
-                 controls[i] = controls[pool_count - 1];
-             }
-             pool_count--;
-             LOG::INFO("E_ALLOC", "Removed pool %p. Remaining pools: %d\n", pool, pool_count);
-             return;
-         }
+         EALLOC_LOG_ERROR("E_ALLOC", "Cannot remove pool %p: it contains allocated blocks.\n",
+                    pool);
+         return;
      }
-     LOG::ERROR("E_ALLOC", "Pool %p not found.\n", pool);
+     int fl = 0, sl = 0;
+     tlsf::mapping_insert(tlsf::get_size(block), &fl, &sl);
+     tlsf::remove_free_block(records_[i].control, block, fl, sl);
+     release_control(records_[i]);
+     // Controls are referenced, not copied, so moving the last record into the gap is safe
+     records_[i] = records_[pool_count - 1];
+     records_[pool_count - 1] = PoolRecord();
+     pool_count--;
+     rebuild_pool_order();
+     if(records_ != inline_records_ && pool_count <= MAX_POOL)
+     {
+         move_registry(MAX_POOL, INVALID_POOL_INDEX, nullptr);
+     }
+     EALLOC_LOG_INFO("E_ALLOC", "Removed pool %p. Remaining pools: %d\n", pool, pool_count);
  }
  
  void* eAlloc::get_pool(void* ptr)
@@ -164,61 +391,158 @@
  
  size_t eAlloc::get_pool_index(void* pool) const
  {
-     for(size_t i = 0; i < pool_count; ++i)
-     {
-         if(memory_pools[i] == pool) return i;
-     }
-     return MAX_POOL;
+     const size_t index = find_pool_index(pool);
+     return (index != INVALID_POOL_INDEX && records_[index].memory == pool) ? index :
+                                                                              INVALID_POOL_INDEX;
  }
  
- void* eAlloc::get_pool_from_block(const void* ptr)
+ void eAlloc::rebuild_pool_order()
  {
-     if(!ptr) return nullptr;
-     const BlockHeader* block = tlsf::from_ptr(ptr);
+     // Insertion sort: pools change rarely and the table is small.
      for(size_t i = 0; i < pool_count; ++i)
      {
-         void* pool_start = memory_pools[i];
-         void* pool_end = static_cast<char*>(pool_start) + pool_sizes[i];
-         if(pool_start <= ptr && ptr < pool_end)
+         size_t index = i;
+         size_t j = i;
+         while(j > 0 && records_[pool_order_[j - 1]].memory > records_[index].memory)
          {
-             return pool_start;
+             pool_order_[j] = pool_order_[j - 1];
+             --j;
+         }
+         pool_order_[j] = index;
+     }
+ 
+     // Routes are singly linked through the records; insert each pool behind every pool that
+     // ranks at least as high, so equal ranks keep index order.
+     for(size_t p = 0; p < POLICY_COUNT; ++p)
+     {
+         const Policy policy = static_cast<Policy>(p);
+         route_head_[p] = INVALID_POOL_INDEX;
+         for(size_t i = 0; i < pool_count; ++i)
+         {
+             const bool matches =
+                 policy == Policy::DEFAULT_POLICY || records_[i].config.policy == policy;
+             const int priority = records_[i].config.priority;
+             size_t* link = &route_head_[p];
+             while(*link != INVALID_POOL_INDEX)
+             {
+                 const PoolRecord& other = records_[*link];
+                 const bool other_matches =
+                     policy == Policy::DEFAULT_POLICY || other.config.policy == policy;
+                 if(matches && !other_matches) break;
+                 if(matches == other_matches && priority > other.config.priority) break;
+                 link = &records_[*link].route_next[p];
+             }
+             records_[i].route_next[p] = *link;
+             *link = i;
+         }
+         // Count the leading pools that rank like the head: placement strategies choose among them
+         route_lead_[p] = 0;
+         for(size_t i = route_head_[p]; i != INVALID_POOL_INDEX; i = records_[i].route_next[p])
+         {
+             const PoolConfig& head = records_[route_head_[p]].config;
+             const PoolConfig& config = records_[i].config;
+             const bool same_match = policy == Policy::DEFAULT_POLICY
+                                     || (config.policy == policy) == (head.policy == policy);
+             if(!same_match || config.priority != head.priority) break;
+             route_lead_[p]++;
          }
      }
-     return nullptr;
  }
  
- int eAlloc::check_pool(void* pool)
+ size_t eAlloc::place(size_t route, size_t size)
  {
- #if !EALLOC_NO_LOCKING
-     size_t poolIndex = get_pool_index(pool);
-     if(usePerPoolLocking_ && poolIndex < MAX_POOL && pool_locks_[poolIndex])
+     const size_t lead = route_lead_[route];
+     const size_t start = (placement_ == PlacementStrategy::ROUND_ROBIN) ?
+                              round_robin_.fetch_add(1, std::memory_order_relaxed) % lead :
+                              0;
+     size_t best = INVALID_POOL_INDEX;
+     size_t best_score = 0;
+     size_t index = route_head_[route];
+     for(size_t pos = 0; pos < lead; ++pos, index = records_[index].route_next[route])
      {
-         elock::LockGuard guard(*pool_locks_[poolIndex]);
+ #if !EALLOC_NO_LOCKING
+         // Each pool is scored under its own lock; a busy pool is not a candidate
+         elock::ILockable* lock = pool_lock(index);
+         elock::OptionalLockGuard guard(lock, 0);
+         if(lock && !guard.acquired()) continue;
+ #endif
+         const Control* control = records_[index].control;
+         if(tlsf::largest_free_size(control) < size) continue;
+         size_t score = 0;
+         switch(placement_)
+         {
+             case PlacementStrategy::FULLEST_FIRST:
+                 score = control->free_bytes;
+                 break;
+             case PlacementStrategy::LEAST_LOADED:
+                 score = records_[index].size - control->free_bytes;
+                 break;
+             default:
+                 // Round robin: the first fit at or after the start wins, else the first fit
+                 if(pos >= start) return index;
+                 if(best == INVALID_POOL_INDEX) best = index;
+                 continue;
+         }
+         if(best == INVALID_POOL_INDEX || score < best_score)
+         {
+             best = index;
+             best_score = score;
+         }
      }
-     else if(lock_)
+     return best;
+ }
+ 
+ size_t eAlloc::find_pool_index(const void* ptr) const
+ {
+     // Find the last pool starting at or below ptr, then check that ptr lies inside it.
+     const char* p = static_cast<const char*>(ptr);
+     size_t lo = 0;
+     size_t hi = pool_count;
+     while(lo < hi)
      {
-         elock::LockGuard guard(*lock_);
+         const size_t mid = (lo + hi) / 2;
+         if(static_cast<const char*>(records_[pool_order_[mid]].memory) <= p)
+             lo = mid + 1;
+         else
+             hi = mid;
      }
+     if(lo == 0) return INVALID_POOL_INDEX;
+     const size_t index = pool_order_[lo - 1];
+     const char* end = static_cast<const char*>(records_[index].heap) + records_[index].size;
+     return (p < end) ? index : INVALID_POOL_INDEX;
+ }
+ 
+ void* eAlloc::get_pool_from_block(const void* ptr)
+ {
+     if(!ptr) return nullptr;
+ #if !EALLOC_NO_LOCKING
+     elock::OptionalLockGuard guard(entry_lock());
+ #endif
+     const size_t index = find_pool_index(ptr);
+     return index != INVALID_POOL_INDEX ? records_[index].memory : nullptr;
+ }
+ 
+ int eAlloc::check_pool(void* pool)
+ {
+ #if !EALLOC_NO_LOCKING
+     elock::OptionalLockGuard guard(lock_for_pool(get_pool_index(pool)));
  #endif
      size_t index = get_pool_index(pool);
-     if(index == MAX_POOL) return -1;
+     if(index == INVALID_POOL_INDEX) return -1;
      IntegrityResult integ = {0, 0};
-     walk_pool(pool, integrity_walker, &integ);
+     walk_pool_impl(index, integrity_walker, &integ);
      return integ.status;
  }
  
  int eAlloc::check()
  {
  #if !EALLOC_NO_LOCKING
-     if(lock_)
-     {
-         elock::LockGuard guard(*lock_);
-     }
+     HeapGuard guard(*this);
  #endif
      int status = 0;
      for(size_t i = 0; i < pool_count; ++i)
      {
-         status += tlsf::check(&controls[i]);
+         status += tlsf::check(records_[i].control);
      }
      return status;
  }
@@ -241,49 +565,105 @@
  
  void eAlloc::walk_pool(void* pool, Walker walker, void* user)
  {
+     const size_t index = get_pool_index(pool);
+     if(index == INVALID_POOL_INDEX) return;
  #if !EALLOC_NO_LOCKING
-     size_t poolIndex = get_pool_index(pool);
-     elock::ILockable* poolLock =
-         (poolIndex < MAX_POOL && pool_locks_[poolIndex]) ? pool_locks_[poolIndex] : lock_;
-     if(poolLock)
-     {
-         elock::LockGuard guard(*poolLock);
-     }
+     elock::OptionalLockGuard guard(lock_for_pool(index));
  #endif
+     walk_pool_impl(index, walker, user);
+ }
+ 
+ void eAlloc::walk_pool_impl(size_t pool_index, Walker walker, void* user)
+ {
      Walker pool_walker = walker ? walker : tlsf::default_walker;
-     BlockHeader* block = tlsf::offset_to_block_nc(pool, -static_cast<int>(tlsf::alloc_overhead()));
-     while(block && !tlsf::is_last(block))
-     {
+     for_each_block(pool_index, [&](BlockHeader* block) {
          pool_walker(tlsf::to_ptr_nc(block), tlsf::get_size(block), !tlsf::is_free(block), user);
-         block = tlsf::next(block);
+     });
+ }
+ 
+ size_t eAlloc::snapshot(SnapshotSink sink, void* user)
+ {
+     SnapshotWriter writer(sink, user);
+     uint64_t flags = 0;
+ #if defined(EALLOC_ENABLE_OWNERSHIP_TAG) && EALLOC_ENABLE_OWNERSHIP_TAG
+     flags |= SnapshotWriter::FLAG_OWNER_TAGS;
+ #endif
+     writer.begin(tlsf::align_size(), tlsf::alloc_overhead(), tlsf::first_payload_offset(), flags);
+     for(size_t i = 0;; ++i)
+     {
+ #if !EALLOC_NO_LOCKING
+         elock::OptionalLockGuard guard(lock_for_pool(i));
+ #endif
+         if(i >= pool_count) break;
+         writer.pool(i, records_[i].heap, records_[i].size);
+         for_each_block(i, [&](BlockHeader* block) {
+             const bool used = !tlsf::is_free(block);
+             uint32_t tag = 0;
+ #if defined(EALLOC_ENABLE_OWNERSHIP_TAG) && EALLOC_ENABLE_OWNERSHIP_TAG
+             if(used) tag = tlsf::get_owner_tag(block);
+ #endif
+             writer.block(tlsf::get_size(block), used, tag);
+         });
+         writer.end_pool();
      }
+     return writer.finish();
  }
  
  void* eAlloc::malloc(size_t size) { return malloc(size, -1, Policy::DEFAULT_POLICY); }
  
  void* eAlloc::malloc(size_t size, int priority, Policy policy)
  {
+     (void)priority; // pools are ranked by PoolConfig::priority, see the route
+     void* ptr = nullptr;
+     {
  #if !EALLOC_NO_LOCKING
-     if(lock_)
+         elock::OptionalLockGuard guard(entry_lock());
+ #endif
+         ptr = malloc_impl(size, policy, nullptr);
+ #if EALLOC_ENABLE_TRACE
+         if(trace_) trace_->record(TraceOp::MALLOC, ptr, nullptr, size, 0);
+ #endif
+ #if EALLOC_ENABLE_PROFILER
+         if(profiler_) profiler_->on_alloc(ptr, size);
+ #endif
+         if(ptr) Observer::on_malloc(*this, ptr, size);
+     }
+     // Outside the lock: the handler may well call back into the allocator
+     if(!ptr && size)
      {
-         elock::LockGuard guard(*lock_);
+         Observer::on_failure(*this, size);
+         if(failure_handler_) failure_handler_(size, failure_handler_data_);
      }
- #endif
+     return ptr;
+ }
+ 
+ char* eAlloc::raise_zero_mark(PoolRecord& pool, void* ptr)
+ {
+     // The next block's size word sits right behind the payload, so it is covered as well.
+     char* prev = pool.zero_mark;
+     char* end = static_cast<char*>(ptr) + tlsf::block_size(ptr) + tlsf::alloc_overhead();
+     if(end > prev) pool.zero_mark = end;
+     return prev;
+ }
+ 
+ void* eAlloc::malloc_impl(size_t size, Policy policy, char** prev_zero_mark)
+ {
      if(!size) return nullptr;
-     if(auto_defragment_)
+     // The sampling and the defragmentation both span every pool, which only the global lock covers
+     if(auto_defragment_ && !usePerPoolLocking_)
      {
          alloc_count_++;
-         // Only check fragmentation every 10 allocations to avoid overhead
+         // report() is O(1) per pool; sample every 10 allocations to keep malloc lean
          if(alloc_count_ % 10 == 0)
          {
-             StorageReport sr = report();
+             StorageReport sr = report_impl(ReportMode::FAST);
              if(sr.fragmentationFactor > defragment_threshold_)
              {
-                 LOG::INFO("E_ALLOC",
+                 EALLOC_LOG_INFO("E_ALLOC",
                            "High fragmentation (%.2f) detected during malloc. Triggering "
                            "auto-defragmentation.",
                            sr.fragmentationFactor);
-                 defragment();
+                 defragment_impl();
              }
          }
      }
@@ -291,84 +671,36 @@
      size_t adjusted_size = tlsf::adjust_request_size(size, tlsf::align_size());
      if(!adjusted_size) return nullptr;
  
-     // Select pool based on priority and policy
-     size_t selected_pool = 0;
-     bool found = false;
-     int highest_priority = -1;
-     for(size_t i = 0; i < pool_count; ++i)
-     {
-         if(priority >= 0 && pool_configs[i].priority < priority) continue;
-         if(policy != Policy::DEFAULT_POLICY && pool_configs[i].policy != policy) continue;
-         if(pool_configs[i].priority > highest_priority)
-         {
-             highest_priority = pool_configs[i].priority;
-             selected_pool = i;
-             found = true;
-         }
-     }
-     if(!found && priority >= 0)
-     {
-         // Relax priority constraint if no matching pool found
-         for(size_t i = 0; i < pool_count; ++i)
-         {
-             if(policy != Policy::DEFAULT_POLICY && pool_configs[i].policy != policy) continue;
-             if(pool_configs[i].priority > highest_priority)
-             {
-                 highest_priority = pool_configs[i].priority;
-                 selected_pool = i;
-                 found = true;
-             }
-         }
-     }
+     // The route already orders the candidates by policy and priority; take the first with room.
+     const size_t route = static_cast<size_t>(policy);
      void* ptr = nullptr;
-     if(!found)
+     size_t preferred = INVALID_POOL_INDEX;
+     if(placement_ != PlacementStrategy::PRIORITY && route_head_[route] != INVALID_POOL_INDEX)
      {
-         // If still not found, ignore policy and select based on availability
-         for(size_t i = 0; i < pool_count; ++i)
+         // The chosen pool may fill up before allocate_from() locks it; the route walk covers that
+         preferred = place(route, adjusted_size);
+         if(preferred != INVALID_POOL_INDEX)
          {
-             BlockHeader* block = tlsf::locate_free(&controls[i], adjusted_size);
-             if(block)
-             {
-                 ptr = tlsf::prepare_used(&controls[i], block, adjusted_size);
-                 selected_pool = i;
-                 break;
-             }
+             ptr = allocate_from(preferred, adjusted_size, size, prev_zero_mark);
          }
      }
-     else
+     // Under per-pool locking a pool busy with another thread is passed over on the first walk;
+     // the second walk waits for each pool in turn.
+     const int walks = usePerPoolLocking_ ? 2 : 1;
+     for(int walk = 0; walk < walks && !ptr; ++walk)
      {
-         BlockHeader* block = tlsf::locate_free(&controls[selected_pool], adjusted_size);
-         if(block)
-         {
-             ptr = tlsf::prepare_used(&controls[selected_pool], block, adjusted_size);
-         }
-         // If selected pool has no space, try others
-         if(!ptr)
+         const bool wait = walk + 1 == walks;
+         for(size_t index = route_head_[route]; !ptr && index != INVALID_POOL_INDEX;
+             index = records_[index].route_next[route])
          {
-             for(size_t i = 0; i < pool_count; ++i)
-             {
-                 if(i == selected_pool) continue;
-                 block = tlsf::locate_free(&controls[i], adjusted_size);
-                 if(block)
-                 {
-                     ptr = tlsf::prepare_used(&controls[i], block, adjusted_size);
-                     selected_pool = i;
-                     break;
-                 }
-             }
+             if(index != preferred)
+                 ptr = allocate_from(index, adjusted_size, size, prev_zero_mark, wait);
          }
      }
- 
-     if(!ptr && failure_handler_)
-     {
-         failure_handler_(size, failure_handler_data_);
-     }
  #if defined(EALLOC_ENABLE_OWNERSHIP_TAG) && EALLOC_ENABLE_OWNERSHIP_TAG && !EALLOC_NO_OWNERSHIP_CHECKING
      if(ptr)
      {
-         tlsf::BlockHeader* block = tlsf::from_ptr_nc(ptr);
-         tlsf::set_owner_tag(block, ownership_tag_);
-         LOG::INFO("E_ALLOC", "Allocated block %p with owner tag %u.\n", ptr, ownership_tag_);
+         log_event<EventId::ALLOC_TAGGED>(ptr, ownership_tag_);
      }
  #endif
      return ptr;
@@ -376,28 +708,52 @@
  
  void eAlloc::free(void* ptr)
  {
-     if(!ptr) return;
+     if(!ptr || !initialised) return;
  #if !EALLOC_NO_LOCKING
-     size_t poolIndex = get_pool_index(get_pool(ptr));
-     if(usePerPoolLocking_ && poolIndex < MAX_POOL && pool_locks_[poolIndex])
-     {
-         elock::LockGuard guard(*pool_locks_[poolIndex]);
-     }
-     else if(lock_)
-     {
-         elock::LockGuard guard(*lock_);
-     }
+     // add_pool/remove_pool rewrite the registry under the global lock, so it covers the lookup
+     elock::OptionalLockGuard guard(entry_lock());
  #endif
+     free_at(ptr, find_pool_index(ptr), 0);
+ }
+ 
+ void eAlloc::free_sized(void* ptr, size_t size)
+ {
      if(!ptr || !initialised) return;
+ #if !EALLOC_NO_LOCKING
+     elock::OptionalLockGuard guard(entry_lock());
+ #endif
+     free_at(ptr, find_pool_index(ptr), size);
+ }
+ 
+ void eAlloc::free_at(void* ptr, size_t pool_index, size_t size)
+ {
+ #if !EALLOC_NO_LOCKING
+     elock::OptionalLockGuard guard(pool_lock(pool_index));
+ #endif
+     // The header is only stable under the pool's lock
+     dsa_assert((pool_index == INVALID_POOL_INDEX || size <= tlsf::block_size(ptr))
+                && "free_sized: size exceeds the block");
+     (void)size;
+ #if EALLOC_ENABLE_TRACE
+     if(trace_ && pool_index != INVALID_POOL_INDEX) trace_->record(TraceOp::FREE, ptr, nullptr, 0, 0);
+ #endif
+ #if EALLOC_ENABLE_PROFILER
+     if(profiler_) profiler_->on_free(ptr);
+ #endif
+     if(pool_index != INVALID_POOL_INDEX) Observer::on_free(*this, ptr);
+     free_in_pool(ptr, pool_index);
+ }
+ 
+ void eAlloc::free_in_pool(void* ptr, size_t pool_index)
+ {
+     if(pool_index == INVALID_POOL_INDEX) return;
      BlockHeader* block = tlsf::from_ptr_nc(ptr);
-     size_t pool_index = get_pool_index(get_pool(ptr));
-     if(pool_index == MAX_POOL) return;
  
  #if defined(EALLOC_ENABLE_OWNERSHIP_TAG) && EALLOC_ENABLE_OWNERSHIP_TAG && !EALLOC_NO_OWNERSHIP_CHECKING
      uint32_t tag = tlsf::get_owner_tag(block);
      if(tag != ownership_tag_)
      {
-         LOG::WARNING("E_ALLOC", "Freeing block %p with mismatched owner tag %u (expected %u).\n", ptr, tag, ownership_tag_);
+         log_event<EventId::OWNER_TAG_MISMATCH>(ptr, tag, ownership_tag_);
      }
  #endif
  
@@ -407,27 +763,63 @@
      {
          if(tlsf::is_free(block))
          {
-             LOG::ERROR("E_ALLOC", "Double free detected for block %p! Ignoring.\n", actual_ptr);
+             log_event<EventId::DOUBLE_FREE>(actual_ptr);
              return;
          }
+         count_release(block);
          tlsf::mark_as_free(block);
-         block = tlsf::merge_prev(&controls[pool_index], block);
-         block = tlsf::merge_next(&controls[pool_index], block);
-         tlsf::insert(&controls[pool_index], block);
+         block = tlsf::merge_prev(records_[pool_index].control, block);
+         block = tlsf::merge_next(records_[pool_index].control, block);
+         tlsf::insert(records_[pool_index].control, block);
      }
  }
  
+ eAlloc::AllocationResult eAlloc::allocate_at_least(size_t size)
+ {
+     AllocationResult result = {nullptr, 0};
+     const size_t adjusted = tlsf::adjust_request_size(size, tlsf::align_size());
+     if(!adjusted) return result;
+     size_t rounded = tlsf::round_request_size(adjusted);
+     if(rounded >= tlsf::max_block_size()) rounded = adjusted;
+     result.ptr = malloc(rounded);
+     result.count = result.ptr ? usable_size(result.ptr) : 0;
+     return result;
+ }
+ 
+ size_t eAlloc::usable_size(const void* ptr) const
+ {
+     return ptr ? tlsf::get_size(tlsf::from_ptr(ptr)) : 0;
+ }
+ 
  void* eAlloc::memalign(size_t align, size_t size)
  {
+     void* ptr = nullptr;
+     {
  #if !EALLOC_NO_LOCKING
-     if(lock_)
+         elock::OptionalLockGuard guard(entry_lock());
+ #endif
+         ptr = memalign_impl(align, size);
+ #if EALLOC_ENABLE_TRACE
+         if(trace_) trace_->record(TraceOp::MEMALIGN, ptr, nullptr, size, align);
+ #endif
+ #if EALLOC_ENABLE_PROFILER
+         if(profiler_) profiler_->on_alloc(ptr, size);
+ #endif
+         if(ptr) Observer::on_malloc(*this, ptr, size);
+     }
+     if(!ptr && size)
      {
-         elock::LockGuard guard(*lock_);
+         Observer::on_failure(*this, size);
+         if(failure_handler_) failure_handler_(size, failure_handler_data_);
      }
- #endif
+     return ptr;
+ }
+ 
+ void* eAlloc::memalign_impl(size_t align, size_t size)
+ {
      if((align & (align - 1)) != 0 || align == 0)
      {
-         LOG::ERROR("E_ALLOC", "Alignment must be a non-zero power of two.");
+         EALLOC_LOG_ERROR("E_ALLOC", "Alignment must be a non-zero power of two.");
          return nullptr;
      }
  
@@ -439,7 +831,10 @@
      // Try to find a block in any pool
      for(size_t i = 0; i < pool_count; ++i)
      {
-         BlockHeader* block = tlsf::locate_free(&controls[i], aligned_size);
+ #if !EALLOC_NO_LOCKING
+         elock::OptionalLockGuard guard(pool_lock(i));
+ #endif
+         BlockHeader* block = tlsf::locate_free(records_[i].control, aligned_size);
          if(block)
          {
              void* ptr = tlsf::to_ptr_nc(block);
@@ -459,103 +854,193 @@
  
              if(gap)
              {
-                 BlockHeader* remaining = tlsf::trim_free_leading(&controls[i], block, gap);
+                 BlockHeader* remaining = tlsf::trim_free_leading(records_[i].control, block, gap);
                  if(!remaining) continue; // Try next pool if trimming fails
                  block = remaining;
              }
-             return tlsf::prepare_used(&controls[i], block, adjust);
+             ptr = tlsf::prepare_used(records_[i].control, block, adjust);
+             raise_zero_mark(records_[i], ptr);
+             note_pool_alloc(records_[i]);
+             count_alloc(ptr, size);
+             return ptr;
          }
-     }
- 
-     // If allocation fails and a handler is set, invoke it
-     if(failure_handler_)
-     {
-         failure_handler_(size, failure_handler_data_);
+         records_[i].failures++;
      }
      return nullptr;
  }
  
  void* eAlloc::realloc(void* ptr, size_t size)
  {
- #if !EALLOC_NO_LOCKING
-     size_t poolIndex = get_pool_index(get_pool(ptr));
-     if(usePerPoolLocking_ && poolIndex < MAX_POOL && pool_locks_[poolIndex])
+     // old_used is clamped to the block size under the pool lock, so this keeps the whole block
+     return realloc_sized(ptr, SIZE_MAX, size);
+ }
+ 
+ void* eAlloc::realloc_sized(void* ptr, size_t old_used, size_t size)
+ {
+     void* new_ptr = nullptr;
      {
-         elock::LockGuard guard(*pool_locks_[poolIndex]);
+ #if !EALLOC_NO_LOCKING
+         elock::OptionalLockGuard guard(entry_lock());
+ #endif
+         new_ptr = realloc_impl(ptr, old_used, size);
+ #if EALLOC_ENABLE_TRACE
+         if(trace_) trace_->record(TraceOp::REALLOC, new_ptr, ptr, size, 0);
+ #endif
+ #if EALLOC_ENABLE_PROFILER
+         // A successful realloc ends the old block's life (size 0 frees it); failure keeps it
+         if(profiler_ && (new_ptr || !size))
+         {
+             profiler_->on_free(ptr);
+             profiler_->on_alloc(new_ptr, size);
+         }
+ #endif
+         if(new_ptr || !size) Observer::on_realloc(*this, ptr, new_ptr, size);
      }
-     else if(lock_)
+     if(!new_ptr && size)
      {
-         elock::LockGuard guard(*lock_);
+         Observer::on_failure(*this, size);
+         if(failure_handler_) failure_handler_(size, failure_handler_data_);
      }
- #endif
+     return new_ptr;
+ }
+ 
+ void* eAlloc::realloc_impl(void* ptr, size_t old_used, size_t size)
+ {
      if(!ptr)
      {
-         return malloc(size);
+         return malloc_impl(size, Policy::DEFAULT_POLICY, nullptr);
      }
+     size_t pool_index = find_pool_index(ptr);
      if(!size)
      {
-         free(ptr);
+ #if !EALLOC_NO_LOCKING
+         elock::OptionalLockGuard guard(pool_lock(pool_index));
+ #endif
+         free_in_pool(ptr, pool_index);
          return nullptr;
      }
+     if(pool_index == INVALID_POOL_INDEX) return nullptr;
  
-     size_t pool_index = get_pool_index(get_pool(ptr));
-     if(pool_index == MAX_POOL) return nullptr;
- 
-     BlockHeader* block = tlsf::from_ptr_nc(ptr);
-     size_t current_size = tlsf::get_size(block);
      size_t adjusted_size = tlsf::adjust_request_size(size, tlsf::align_size());
      if(!adjusted_size) return nullptr;
  
-     if(adjusted_size <= current_size)
-     {
-         tlsf::trim_used(&controls[pool_index], block, adjusted_size);
-         return ptr;
-     }
- 
-     BlockHeader* next_block = tlsf::next(block);
-     if(tlsf::is_free(next_block))
+     size_t current_size = 0;
      {
-         size_t combined_size =
-             current_size + tlsf::get_size(next_block)
-             + sizeof(size_t); // Use sizeof(size_t) as the overhead value directly
-         if(combined_size >= adjusted_size)
+         // The pool lock covers the in-place paths only; a move allocates through malloc_impl(),
+         // which locks whichever pools it tries.
+ #if !EALLOC_NO_LOCKING
+         elock::OptionalLockGuard guard(pool_lock(pool_index));
+ #endif
+         BlockHeader* block = tlsf::from_ptr_nc(ptr);
+         current_size = tlsf::get_size(block);
+         if(adjusted_size <= current_size)
          {
-             int fl = 0, sl = 0;
-             tlsf::mapping_insert(tlsf::get_size(next_block), &fl, &sl);
-             tlsf::remove_free_block(&controls[pool_index], next_block, fl, sl);
-             block = tlsf::absorb(block, next_block);
-             tlsf::trim_used(&controls[pool_index], block, adjusted_size);
+             count_release(block);
+             tlsf::trim_used(records_[pool_index].control, block, adjusted_size);
+             count_alloc(ptr, size);
              return ptr;
          }
+ 
+         BlockHeader* next_block = tlsf::next(block);
+         if(tlsf::is_free(next_block))
+         {
+             size_t combined_size =
+                 current_size + tlsf::get_size(next_block)
+                 + tlsf::alloc_overhead(); // The neighbour's header becomes payload
+             if(combined_size >= adjusted_size)
+             {
+                 int fl = 0, sl = 0;
+                 tlsf::mapping_insert(tlsf::get_size(next_block), &fl, &sl);
+                 tlsf::remove_free_block(records_[pool_index].control, next_block, fl, sl);
+                 count_release(block);
+                 block = tlsf::absorb(block, next_block);
+                 tlsf::count_merge(records_[pool_index].control, block);
+                 // The successor no longer follows a free block, even if nothing is split off below
+                 tlsf::mark_as_used(block);
+                 tlsf::trim_used(records_[pool_index].control, block, adjusted_size);
+                 raise_zero_mark(records_[pool_index], ptr);
+                 raise_pool_peak(records_[pool_index]);
+                 count_alloc(ptr, size);
+                 return ptr;
+             }
+         }
      }
  
-     void* new_ptr = malloc(size);
+     void* new_ptr = malloc_impl(size, Policy::DEFAULT_POLICY, nullptr);
      if(!new_ptr) return nullptr;
  
-     memcpy(new_ptr, ptr, current_size);
-     free(ptr);
+     const size_t live = dsa_min(old_used, current_size);
+     if(live >= STREAM_COPY_THRESHOLD)
+     {
+         stream_copy(new_ptr, ptr, live);
+     }
+     else
+     {
+         memcpy(new_ptr, ptr, live);
+     }
+ #if !EALLOC_NO_LOCKING
+     elock::OptionalLockGuard guard(pool_lock(pool_index));
+ #endif
+     free_in_pool(ptr, pool_index);
      return new_ptr;
  }
  
  void* eAlloc::calloc(size_t num, size_t size)
  {
      size_t total = num * size;
-     void* ptr = malloc(total);
+     char* zero_mark = nullptr;
+     char* ptr = nullptr;
+     {
+ #if !EALLOC_NO_LOCKING
+         elock::OptionalLockGuard guard(entry_lock());
+ #endif
+         ptr = static_cast<char*>(malloc_impl(total, Policy::DEFAULT_POLICY, &zero_mark));
+ #if EALLOC_ENABLE_TRACE
+         if(trace_) trace_->record(TraceOp::CALLOC, ptr, nullptr, total, 0);
+ #endif
+ #if EALLOC_ENABLE_PROFILER
+         if(profiler_) profiler_->on_alloc(ptr, total);
+ #endif
+         if(ptr) Observer::on_malloc(*this, ptr, total);
+     }
+     if(!ptr && total)
+     {
+         Observer::on_failure(*this, total);
+         if(failure_handler_) failure_handler_(total, failure_handler_data_);
+     }
+     // The block is private to the caller now, so it is cleared outside the lock
      if(ptr)
      {
-         memset(ptr, 0, total);
+         char* end = ptr + total;
+         if(zero_mark >= end)
+         {
+             memset(ptr, 0, total);
+         }
+         else
+         {
+             // Bytes from the zero mark on were never handed out. Only allocator metadata can live
+             // there: free-list links at the payload head and the next block's
+             // prev_phys_block in the last word.
+             const size_t head = dsa_min(total, sizeof(BlockHeader));
+             const size_t tail = dsa_min(total, tlsf::alloc_overhead());
+             if(zero_mark > ptr) memset(ptr, 0, static_cast<size_t>(zero_mark - ptr));
+             memset(ptr, 0, head);
+             memset(end - tail, 0, tail);
+         }
      }
      return ptr;
  }
  
- eAlloc::StorageReport eAlloc::report() const
+ eAlloc::StorageReport eAlloc::report(ReportMode mode) const
  {
  #if !EALLOC_NO_LOCKING
-     if(lock_)
-     {
-         elock::LockGuard guard(*lock_);
-     }
+     HeapGuard guard(*this);
  #endif
+     return report_impl(mode);
+ }
+ 
+ eAlloc::StorageReport eAlloc::report_impl(ReportMode mode) const
+ {
      StorageReport report;
      report.totalFreeSpace = 0;
      report.largestFreeRegion = 0;
@@ -566,24 +1051,35 @@
      size_t fragmented_sum = 0;
      for(size_t i = 0; i < pool_count; ++i)
      {
-         BlockHeader* block =
-             tlsf::offset_to_block_nc(memory_pools[i], -static_cast<int>(tlsf::alloc_overhead()));
          size_t free_space = 0;
          size_t free_blocks = 0;
          size_t largest = 0;
-         size_t smallest = pool_sizes[i];
-         while(block && !tlsf::is_last(block))
+         size_t smallest = 0;
+         if(mode == ReportMode::FAST)
          {
-             size_t block_size = tlsf::get_size(block);
-             if(tlsf::is_free(block))
+             free_space = records_[i].control->free_bytes;
+             free_blocks = records_[i].control->free_blocks;
+             largest = tlsf::largest_free_size(records_[i].control);
+             smallest = tlsf::smallest_free_size(records_[i].control);
+         }
+         else
+         {
+             BlockHeader* block = tlsf::first_block(records_[i].heap);
+             smallest = records_[i].size;
+             while(block && !tlsf::is_last(block))
              {
-                 free_space += block_size;
-                 free_blocks++;
-                 largest = (block_size > largest) ? block_size : largest;
-                 smallest = (block_size < smallest) ? block_size : smallest;
+                 size_t block_size = tlsf::get_size(block);
+                 if(tlsf::is_free(block))
+                 {
+                     free_space += block_size;
+                     free_blocks++;
+                     largest = (block_size > largest) ? block_size : largest;
+                     smallest = (block_size < smallest) ? block_size : smallest;
+                 }
+                 block = tlsf::next(block);
              }
-             block = tlsf::next(block);
          }
+         if(!free_blocks) continue;
          report.totalFreeSpace += free_space;
          report.freeBlockCount += free_blocks;
          report.largestFreeRegion =
@@ -592,7 +1088,7 @@
              (smallest < report.smallestFreeRegion || report.smallestFreeRegion == 0) ?
                  smallest :
                  report.smallestFreeRegion;
-         if(free_space > 0 && largest > 0)
+         if(free_space > largest)
              fragmented_sum += (free_space - largest);
      }
      if(report.freeBlockCount > 0)
@@ -606,33 +1102,85 @@
      return report;
  }
  
- void eAlloc::logStorageReport() const
+ void eAlloc::fill_pool_stats(PoolStats& stats, size_t index) const
+ {
+     const PoolRecord& pool = records_[index];
+     stats.index = index;
+     stats.memory = pool.memory;
+     stats.bytes = pool.bytes;
+     stats.size = pool.size;
+     stats.in_use = pool.size - pool.control->free_bytes;
+     // Paths that bypass the counters (the pool registry) can only have raised usage since
+     stats.peak_in_use = dsa_max(pool.peak_in_use, stats.in_use);
+     stats.allocations = pool.allocations;
+     stats.failures = pool.failures;
+ }
+ 
+ eAlloc::PoolStats eAlloc::pool_stats(size_t index) const
+ {
+     PoolStats stats;
+ #if !EALLOC_NO_LOCKING
+     elock::OptionalLockGuard guard(lock_for_pool(index));
+ #endif
+     if(index < pool_count) fill_pool_stats(stats, index);
+     return stats;
+ }
+ 
+ size_t eAlloc::pool_report(PoolStats* out, size_t capacity) const
  {
+     size_t count = 0;
+     for(size_t i = 0;; ++i)
+     {
  #if !EALLOC_NO_LOCKING
-     if(lock_)
+         elock::OptionalLockGuard guard(lock_for_pool(i));
+ #endif
+         if(i >= pool_count) break;
+         if(out && i < capacity)
+         {
+             out[i] = PoolStats();
+             fill_pool_stats(out[i], i);
+         }
+         count++;
+     }
+     return count;
+ }
+ 
+ void eAlloc::reset_pool_peaks()
+ {
+     for(size_t i = 0;; ++i)
      {
-         elock::LockGuard guard(*lock_);
+ #if !EALLOC_NO_LOCKING
+         elock::OptionalLockGuard guard(lock_for_pool(i));
+ #endif
+         if(i >= pool_count) break;
+         records_[i].peak_in_use = records_[i].size - records_[i].control->free_bytes;
      }
+ }
+ 
+ void eAlloc::logStorageReport() const
+ {
+ #if !EALLOC_NO_LOCKING
+     HeapGuard guard(*this);
  #endif
-     StorageReport sr = report();
-     LOG::INFO("E_ALLOC", "=== Storage Report ===");
-     LOG::INFO("E_ALLOC", "Total Free Space: %zu bytes", sr.totalFreeSpace);
-     LOG::INFO("E_ALLOC", "Largest Free Region: %zu bytes", sr.largestFreeRegion);
-     LOG::INFO("E_ALLOC", "Smallest Free Region: %zu bytes", sr.smallestFreeRegion);
-     LOG::INFO("E_ALLOC", "Number of Free Blocks: %zu", sr.freeBlockCount);
-     LOG::INFO("E_ALLOC", "Average Free Block Size: %zu bytes", sr.averageFreeBlockSize);
-     LOG::INFO("E_ALLOC", "Average Fragmentation Factor: %.4f", sr.fragmentationFactor);
+     StorageReport sr = report_impl(ReportMode::EXACT);
+     EALLOC_LOG_INFO("E_ALLOC", "=== Storage Report ===");
+     EALLOC_LOG_INFO("E_ALLOC", "Total Free Space: %zu bytes", sr.totalFreeSpace);
+     EALLOC_LOG_INFO("E_ALLOC", "Largest Free Region: %zu bytes", sr.largestFreeRegion);
+     EALLOC_LOG_INFO("E_ALLOC", "Smallest Free Region: %zu bytes", sr.smallestFreeRegion);
+     EALLOC_LOG_INFO("E_ALLOC", "Number of Free Blocks: %zu", sr.freeBlockCount);
+     EALLOC_LOG_INFO("E_ALLOC", "Average Free Block Size: %zu bytes", sr.averageFreeBlockSize);
+     EALLOC_LOG_INFO("E_ALLOC", "Average Fragmentation Factor: %.4f", sr.fragmentationFactor);
      // Add per-pool breakdown to diagnose fragmentation
-     LOG::INFO("E_ALLOC", "Per-Pool Breakdown:");
+     EALLOC_LOG_INFO("E_ALLOC", "Per-Pool Breakdown:");
      for(size_t i = 0; i < pool_count; ++i)
      {
-         if(memory_pools[i])
+         if(records_[i].heap)
          {
-             size_t pool_size = pool_sizes[i];
+             size_t pool_size = records_[i].size;
              size_t free_space = 0;
              size_t free_blocks = 0;
              size_t largest_free = 0;
-             BlockHeader* block = tlsf::offset_to_block_nc(memory_pools[i], -tlsf::alloc_overhead());
+             BlockHeader* block = tlsf::first_block(records_[i].heap);
              while(block && !tlsf::is_last(block))
              {
                  if(tlsf::is_free(block))
@@ -646,31 +1194,272 @@
              }
              double pool_frag =
                  (free_space > 0) ? 1.0 - static_cast<double>(largest_free) / free_space : 0.0;
-             LOG::INFO(
+             EALLOC_LOG_INFO(
                  "E_ALLOC",
                  "  Pool %zu: Total Size=%zu, Free=%zu, Blocks=%zu, Largest Free=%zu, Frag=%.4f", i,
                  pool_size, free_space, free_blocks, largest_free, pool_frag);
+             PoolStats stats;
+             fill_pool_stats(stats, i);
+             EALLOC_LOG_INFO("E_ALLOC", "    In Use=%zu, Peak=%zu, Allocations=%zu, Failures=%zu",
+                             stats.in_use, stats.peak_in_use, stats.allocations, stats.failures);
          }
      }
      if(sr.fragmentationFactor > defragment_threshold_)
      {
-         LOG::INFO("E_ALLOC", "High fragmentation detected. Consider calling defragment().");
+         EALLOC_LOG_INFO("E_ALLOC", "High fragmentation detected. Consider calling defragment().");
      }
  }
  
- size_t eAlloc::defragment()
+ #if EALLOC_ENABLE_CLASS_STATS || EALLOC_ENABLE_OWNERSHIP_TAG
+ void eAlloc::count_alloc(void* ptr, size_t requested)
+ {
+     BlockHeader* block = tlsf::from_ptr_nc(ptr);
+     const size_t granted = tlsf::get_size(block);
+     (void)requested;
+ #if EALLOC_ENABLE_OWNERSHIP_TAG
+     tlsf::set_owner_tag(block, ownership_tag_);
+     OwnerSlot& owner = owner_slot(ownership_tag_);
+     owner.allocations.fetch_add(1, std::memory_order_relaxed);
+     owner.live_blocks.fetch_add(1, std::memory_order_relaxed);
+     const size_t live = owner.live_bytes.fetch_add(granted, std::memory_order_relaxed) + granted;
+     size_t peak = owner.peak_bytes.load(std::memory_order_relaxed);
+     while(live > peak
+           && !owner.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+     {
+     }
+ #endif
+ #if EALLOC_ENABLE_CLASS_STATS
+     int fl = 0, sl = 0;
+     tlsf::mapping_insert(granted, &fl, &sl);
+     tlsf::ClassCounters& c = class_counters_[fl * tlsf::shelves() + sl];
+     c.allocations.fetch_add(1, std::memory_order_relaxed);
+     c.live.fetch_add(1, std::memory_order_relaxed);
+     c.requested_bytes.fetch_add(requested, std::memory_order_relaxed);
+     c.granted_bytes.fetch_add(granted, std::memory_order_relaxed);
+ #endif
+ }
+ 
+ void eAlloc::count_release(const BlockHeader* block)
+ {
+     const size_t granted = tlsf::get_size(block);
+     (void)granted;
+ #if EALLOC_ENABLE_OWNERSHIP_TAG
+     OwnerSlot& owner = owner_slot(tlsf::get_owner_tag(block));
+     owner.live_blocks.fetch_sub(1, std::memory_order_relaxed);
+     owner.live_bytes.fetch_sub(granted, std::memory_order_relaxed);
+ #endif
+ #if EALLOC_ENABLE_CLASS_STATS
+     int fl = 0, sl = 0;
+     tlsf::mapping_insert(granted, &fl, &sl);
+     class_counters_[fl * tlsf::shelves() + sl].live.fetch_sub(1, std::memory_order_relaxed);
+ #endif
+ }
+ #endif
+ 
+ #if EALLOC_ENABLE_CLASS_STATS
+ eAlloc::SizeClassStats eAlloc::size_class_stats(size_t fl, size_t sl) const
  {
+     SizeClassStats stats;
+     if(fl >= tlsf::cabinets() || sl >= tlsf::shelves()) return stats;
+     const tlsf::ClassCounters& c = class_counters_[fl * tlsf::shelves() + sl];
+     stats.fl = fl;
+     stats.sl = sl;
+     stats.min_size = tlsf::class_floor(static_cast<int>(fl), static_cast<int>(sl));
+     stats.allocations = c.allocations.load(std::memory_order_relaxed);
+     stats.live = c.live.load(std::memory_order_relaxed);
+     stats.requested_bytes = c.requested_bytes.load(std::memory_order_relaxed);
+     stats.granted_bytes = c.granted_bytes.load(std::memory_order_relaxed);
+     stats.splits = c.splits.load(std::memory_order_relaxed);
+     stats.merges = c.merges.load(std::memory_order_relaxed);
+     return stats;
+ }
+ 
+ eAlloc::SizeClassStats eAlloc::size_class_stats_for(size_t size) const
+ {
+     int fl = 0, sl = 0;
+     tlsf::mapping_insert(size, &fl, &sl);
+     return size_class_stats(static_cast<size_t>(fl), static_cast<size_t>(sl));
+ }
+ 
+ size_t eAlloc::size_class_report(SizeClassStats* out, size_t capacity) const
+ {
+     size_t active = 0;
+     for(size_t fl = 0; fl < tlsf::cabinets(); ++fl)
+     {
+         for(size_t sl = 0; sl < tlsf::shelves(); ++sl)
+         {
+             const SizeClassStats stats = size_class_stats(fl, sl);
+             if(!stats.allocations && !stats.live && !stats.splits && !stats.merges) continue;
+             if(out && active < capacity) out[active] = stats;
+             active++;
+         }
+     }
+     return active;
+ }
+ 
+ void eAlloc::reset_size_class_stats()
+ {
+     for(tlsf::ClassCounters& c : class_counters_)
+     {
+         c.allocations.store(0, std::memory_order_relaxed);
+         c.requested_bytes.store(0, std::memory_order_relaxed);
+         c.granted_bytes.store(0, std::memory_order_relaxed);
+         c.splits.store(0, std::memory_order_relaxed);
+         c.merges.store(0, std::memory_order_relaxed);
+     }
+ }
+ #endif
+ 
+ #if EALLOC_ENABLE_OWNERSHIP_TAG
+ eAlloc::OwnerSlot& eAlloc::owner_slot(uint32_t tag)
+ {
+     const uint64_t key = static_cast<uint64_t>(tag) + 1;
+     size_t slot = (tag * 2654435761u) % MAX_OWNER_TAGS;
+     for(size_t probe = 0; probe < MAX_OWNER_TAGS; ++probe)
+     {
+         OwnerSlot& owner = owners_[slot];
+         uint64_t current = owner.key.load(std::memory_order_acquire);
+         if(current == key) return owner;
+         if(!current)
+         {
+             // Claim the empty slot; a racing claim for another tag sends us probing on
+             if(owner.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)
+                || current == key)
+                 return owner;
+         }
+         slot = (slot + 1) % MAX_OWNER_TAGS;
+     }
+     return owners_[MAX_OWNER_TAGS];
+ }
+ 
+ const eAlloc::OwnerSlot* eAlloc::find_owner_slot(uint32_t tag) const
+ {
+     const uint64_t key = static_cast<uint64_t>(tag) + 1;
+     size_t slot = (tag * 2654435761u) % MAX_OWNER_TAGS;
+     for(size_t probe = 0; probe < MAX_OWNER_TAGS; ++probe)
+     {
+         const uint64_t current = owners_[slot].key.load(std::memory_order_acquire);
+         if(current == key) return &owners_[slot];
+         if(!current) return nullptr;
+         slot = (slot + 1) % MAX_OWNER_TAGS;
+     }
+     return nullptr;
+ }
+ 
+ namespace
+ {
+ template <typename Slot>
+ void fill_owner_stats(eAlloc::OwnerStats& stats, const Slot& owner)
+ {
+     stats.live_bytes = owner.live_bytes.load(std::memory_order_relaxed);
+     stats.live_blocks = owner.live_blocks.load(std::memory_order_relaxed);
+     stats.peak_bytes = owner.peak_bytes.load(std::memory_order_relaxed);
+     stats.allocations = owner.allocations.load(std::memory_order_relaxed);
+ }
+ } // namespace
+ 
+ eAlloc::OwnerStats eAlloc::owner_stats(uint32_t tag) const
+ {
+     OwnerStats stats;
+     stats.tag = tag;
+     if(const OwnerSlot* owner = find_owner_slot(tag)) fill_owner_stats(stats, *owner);
+     return stats;
+ }
+ 
+ size_t eAlloc::owner_report(OwnerStats* out, size_t capacity) const
+ {
+     size_t count = 0;
+     for(size_t i = 0; i <= MAX_OWNER_TAGS; ++i)
+     {
+         const OwnerSlot& owner = owners_[i];
+         const uint64_t key = owner.key.load(std::memory_order_acquire);
+         const bool overflow = i == MAX_OWNER_TAGS;
+         if(overflow ? !owner.allocations.load(std::memory_order_relaxed) : !key) continue;
+         if(out && count < capacity)
+         {
+             OwnerStats& stats = out[count];
+             stats = OwnerStats();
+             stats.tag = overflow ? 0 : static_cast<uint32_t>(key - 1);
+             stats.overflow = overflow;
+             fill_owner_stats(stats, owner);
+         }
+         count++;
+     }
+     return count;
+ }
+ 
+ void eAlloc::reset_owner_peaks()
+ {
+     for(OwnerSlot& owner : owners_)
+         owner.peak_bytes.store(owner.live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+ }
+ 
+ size_t eAlloc::leak_report(LeakVisitor visitor, void* user)
+ {
+     size_t outstanding = 0;
+     for(size_t i = 0;; ++i)
+     {
  #if !EALLOC_NO_LOCKING
-     if(lock_)
+         elock::OptionalLockGuard guard(lock_for_pool(i));
+ #endif
+         if(i >= pool_count) break;
+         for_each_block(i, [&](BlockHeader* block) {
+             void* ptr = tlsf::to_ptr_nc(block);
+             if(tlsf::is_free(block) || ptr == records_) return;
+             outstanding++;
+             if(visitor) visitor(ptr, tlsf::get_size(block), tlsf::get_owner_tag(block), user);
+         });
+     }
+     return outstanding;
+ }
+ 
+ size_t eAlloc::logLeakReport(size_t max_blocks)
+ {
+     OwnerStats owners[MAX_OWNER_TAGS + 1];
+     const size_t count = owner_report(owners, MAX_OWNER_TAGS + 1);
+     EALLOC_LOG_INFO("E_ALLOC", "=== Leak Report ===");
+     for(size_t i = 0; i < count; ++i)
      {
-         elock::LockGuard guard(*lock_);
+         if(!owners[i].live_blocks) continue;
+         if(owners[i].overflow)
+             EALLOC_LOG_WARNING("E_ALLOC", "Untracked tags: %zu bytes in %zu blocks (peak %zu)",
+                          owners[i].live_bytes, owners[i].live_blocks, owners[i].peak_bytes);
+         else
+             EALLOC_LOG_WARNING("E_ALLOC", "Tag %u: %zu bytes in %zu blocks (peak %zu)", owners[i].tag,
+                          owners[i].live_bytes, owners[i].live_blocks, owners[i].peak_bytes);
      }
+     struct Listing
+     {
+         size_t remaining;
+     } listing = {max_blocks};
+     const size_t outstanding = leak_report(
+         [](void* ptr, size_t size, uint32_t tag, void* user) {
+             Listing* l = static_cast<Listing*>(user);
+             if(!l->remaining) return;
+             l->remaining--;
+             EALLOC_LOG_WARNING("E_ALLOC", "  %p: %zu bytes, tag %u", ptr, size, tag);
+         },
+         &listing);
+     if(outstanding > max_blocks)
+         EALLOC_LOG_WARNING("E_ALLOC", "  ... %zu more blocks", outstanding - max_blocks);
+     return outstanding;
+ }
+ #endif
+ 
+ size_t eAlloc::defragment()
+ {
+ #if !EALLOC_NO_LOCKING
+     HeapGuard guard(*this);
  #endif
+     return defragment_impl();
+ }
+ 
+ size_t eAlloc::defragment_impl()
+ {
      size_t merged = 0;
      for(size_t i = 0; i < pool_count; ++i)
      {
-         BlockHeader* block =
-             tlsf::offset_to_block_nc(memory_pools[i], -static_cast<int>(tlsf::alloc_overhead()));
+         BlockHeader* block = tlsf::first_block(records_[i].heap);
          while(!tlsf::is_last(block))
          {
              if(tlsf::is_free(block))
@@ -680,8 +1469,9 @@
                  {
                      int fl = 0, sl = 0;
                      tlsf::mapping_insert(tlsf::get_size(next_block), &fl, &sl);
-                     tlsf::remove_free_block(&controls[i], next_block, fl, sl);
+                     tlsf::remove_free_block(records_[i].control, next_block, fl, sl);
                      block = tlsf::absorb(block, next_block);
+                     tlsf::count_merge(records_[i].control, block);
                      merged++;
                  }
                  else
@@ -698,27 +1488,156 @@
      return merged;
  }
  
- bool eAlloc::resize_pool(void* pool, size_t new_bytes)
+ eAlloc::Handle eAlloc::allocate_handle(size_t size)
  {
  #if !EALLOC_NO_LOCKING
-     size_t poolIndex = get_pool_index(pool);
-     if(usePerPoolLocking_ && poolIndex < MAX_POOL && pool_locks_[poolIndex])
+     elock::OptionalLockGuard guard(lock_);
+ #endif
+     Handle handle = INVALID_HANDLE;
+     for(size_t i = 0; i < MAX_HANDLES; ++i)
      {
-         elock::LockGuard guard(*pool_locks_[poolIndex]);
+         if(!handles_[i].ptr)
+         {
+             handle = i;
+             break;
+         }
      }
-     else if(lock_)
+     if(handle == INVALID_HANDLE)
      {
-         elock::LockGuard guard(*lock_);
+         EALLOC_LOG_ERROR("E_ALLOC", "Handle table full (%zu entries).\n", MAX_HANDLES);
+         return INVALID_HANDLE;
      }
+     void* ptr = malloc_impl(size, Policy::DEFAULT_POLICY, nullptr);
+     if(!ptr) return INVALID_HANDLE;
+     handles_[handle].ptr = ptr;
+     handles_[handle].pins = 0;
+     return handle;
+ }
+ 
+ void* eAlloc::pin(Handle handle)
+ {
+ #if !EALLOC_NO_LOCKING
+     elock::OptionalLockGuard guard(lock_);
+ #endif
+     if(handle >= MAX_HANDLES || !handles_[handle].ptr) return nullptr;
+     handles_[handle].pins++;
+     return handles_[handle].ptr;
+ }
+ 
+ void eAlloc::unpin(Handle handle)
+ {
+ #if !EALLOC_NO_LOCKING
+     elock::OptionalLockGuard guard(lock_);
+ #endif
+     if(handle >= MAX_HANDLES || !handles_[handle].ptr) return;
+     if(handles_[handle].pins > 0) handles_[handle].pins--;
+ }
+ 
+ void eAlloc::free_handle(Handle handle)
+ {
+ #if !EALLOC_NO_LOCKING
+     elock::OptionalLockGuard guard(lock_);
+ #endif
+     if(handle >= MAX_HANDLES || !handles_[handle].ptr) return;
+     if(handles_[handle].pins)
+     {
+         EALLOC_LOG_WARNING("E_ALLOC", "Freeing handle %zu while it is still pinned.\n", handle);
+     }
+     void* ptr = handles_[handle].ptr;
+     handles_[handle].ptr = nullptr;
+     handles_[handle].pins = 0;
+     const size_t pool_index = find_pool_index(ptr);
+ #if !EALLOC_NO_LOCKING
+     elock::OptionalLockGuard pool_guard(pool_lock(pool_index));
+ #endif
+     free_in_pool(ptr, pool_index);
+ }
+ 
+ size_t eAlloc::compact()
+ {
+ #if !EALLOC_NO_LOCKING
+     HeapGuard guard(*this);
+ #endif
+     size_t moved = 0;
+     for(size_t i = 0; i < pool_count; ++i)
+     {
+         Control* control = records_[i].control;
+         BlockHeader* block = tlsf::first_block(records_[i].heap);
+         while(!tlsf::is_last(block))
+         {
+             BlockHeader* next_block = tlsf::next(block);
+             if(!tlsf::is_free(block) || tlsf::is_last(next_block))
+             {
+                 block = next_block;
+                 continue;
+             }
+             // block is free and next_block is used (free neighbours are always coalesced)
+             HandleEntry* entry = nullptr;
+             void* payload = tlsf::to_ptr_nc(next_block);
+             for(size_t h = 0; h < MAX_HANDLES; ++h)
+             {
+                 if(handles_[h].ptr == payload && handles_[h].pins == 0)
+                 {
+                     entry = &handles_[h];
+                     break;
+                 }
+             }
+             if(!entry)
+             {
+                 block = next_block;
+                 continue;
+             }
+ 
+             const size_t hole_size = tlsf::get_size(block);
+             const size_t used_size = tlsf::get_size(next_block);
+ #if defined(EALLOC_ENABLE_OWNERSHIP_TAG) && EALLOC_ENABLE_OWNERSHIP_TAG
+             // Read before the payload moves over the old header
+             const uint32_t tag = tlsf::get_owner_tag(next_block);
+ #endif
+             tlsf::remove(control, block);
+ 
+             // The moved block takes the hole's header; its predecessor is used since the hole was
+             // coalesced.
+             BlockHeader* moved_block = block;
+             tlsf::set_size(moved_block, used_size);
+             tlsf::set_used(moved_block);
+             tlsf::set_prev_used(moved_block);
+ #if defined(EALLOC_ENABLE_OWNERSHIP_TAG) && EALLOC_ENABLE_OWNERSHIP_TAG
+             tlsf::set_owner_tag(moved_block, tag);
+ #endif
+             memmove(tlsf::to_ptr_nc(moved_block), payload, used_size);
+             entry->ptr = tlsf::to_ptr_nc(moved_block);
+ 
+             // Re-create the hole behind the moved block. Its prev_phys_block is left untouched as
+             // it overlaps the moved block's payload and is only meaningful for free predecessors.
+             BlockHeader* hole = tlsf::next(moved_block);
+             tlsf::set_size(hole, hole_size);
+             tlsf::set_prev_used(hole);
+             tlsf::mark_as_free(hole);
+             hole = tlsf::merge_next(control, hole);
+             tlsf::insert(control, hole);
+             block = hole;
+             moved++;
+         }
+     }
+     return moved;
+ }
+ 
+ bool eAlloc::resize_pool(void* pool, size_t new_bytes)
+ {
+ #if !EALLOC_NO_LOCKING
+     if(registry_fixed("resize_pool")) return false;
+     elock::OptionalLockGuard guard(lock_);
  #endif
      size_t index = get_pool_index(pool);
      if(index >= pool_count)
      {
-         LOG::ERROR("E_ALLOC", "Pool %p not found for resizing.\n", pool);
+         EALLOC_LOG_ERROR("E_ALLOC", "Pool %p not found for resizing.\n", pool);
          return false;
      }
  
-     size_t current_size = pool_sizes[index];
+     // Sizes are compared as memory bytes, which include the control the pool may host
+     size_t current_size = records_[index].bytes;
      if(new_bytes == current_size)
      {
          return true; // No change needed
@@ -726,37 +1645,48 @@
  
      if(new_bytes < tlsf::min_block_size() || new_bytes > tlsf::max_block_size())
      {
-         LOG::ERROR("E_ALLOC", "New pool size must be between %zu and %zu bytes.\n",
+         EALLOC_LOG_ERROR("E_ALLOC", "New pool size must be between %zu and %zu bytes.\n",
                     tlsf::min_block_size(), tlsf::max_block_size());
          return false;
      }
  
      // Check if pool has allocated blocks (prevent resizing if data would be lost)
-     BlockHeader* block = tlsf::offset_to_block_nc(pool, -static_cast<int>(tlsf::alloc_overhead()));
+     BlockHeader* block = tlsf::first_block(records_[index].heap);
      BlockHeader* next = tlsf::next(block);
      if(!tlsf::is_free(block) || !tlsf::is_last(next))
      {
          // If there are allocated blocks beyond the first, or first block isn't free
-         LOG::ERROR("E_ALLOC", "Cannot resize pool %p: it contains allocated blocks.\n", pool);
+         EALLOC_LOG_ERROR("E_ALLOC", "Cannot resize pool %p: it contains allocated blocks.\n", pool);
          return false;
      }
  
      // If shrinking, check if the first free block can accommodate the reduction
      if(new_bytes < current_size)
      {
-         if(tlsf::get_size(block) < new_bytes)
+         PoolRecord& record = records_[index];
+         const size_t head =
+             static_cast<size_t>(static_cast<char*>(record.heap) - static_cast<char*>(record.memory));
+         const size_t block_bytes =
+             new_bytes > head + tlsf::pool_overhead()
+                 ? tlsf::align_down(new_bytes - head - tlsf::pool_overhead(), tlsf::align_size())
+                 : 0;
+         if(block_bytes < tlsf::min_block_size())
          {
-             LOG::ERROR("E_ALLOC", "Cannot shrink pool %p: free space less than new size.\n", pool);
+             EALLOC_LOG_ERROR("E_ALLOC", "Cannot shrink pool %p: %zu bytes cannot hold its control.\n",
+                        pool, new_bytes);
              return false;
          }
-         // Adjust the size of the free block
-         tlsf::set_size(block, new_bytes);
+         // Adjust the size of the free block, re-filing it under its new size class
+         tlsf::remove(record.control, block);
+         tlsf::set_size(block, block_bytes);
          next = tlsf::link_next(block);
          tlsf::set_size(next, 0);
          tlsf::set_used(next);
          tlsf::set_prev_free(next);
-         pool_sizes[index] = new_bytes;
-         LOG::SUCCESS("E_ALLOC", "Shrunk pool %p to %zu bytes.\n", pool, new_bytes);
+         tlsf::insert(record.control, block);
+         record.size = block_bytes;
+         record.bytes = new_bytes;
+         EALLOC_LOG_SUCCESS("E_ALLOC", "Shrunk pool %p to %zu bytes.\n", pool, new_bytes);
          return true;
      }
  
@@ -766,36 +1696,38 @@
          void* new_pool = resize_handler_(pool, current_size, new_bytes, resize_handler_data_);
          if(new_pool)
          {
-             // Remove old pool entry and its TLSF control structure
-             tlsf::initialise_control(&controls[index]); // Reset the control structure for this pool index
-             memory_pools[index] = nullptr;
-             pool_sizes[index] = 0;
-             pool_count--; // Decrease pool count as we're replacing this pool
-             // Add new pool with the expanded size at the same index
-             if(add_pool(new_pool, new_bytes, pool_configs[index]))
+             // The old pool is empty, so its record is rebuilt in place over the new memory
+             PoolRecord& record = records_[index];
+             const PoolRecord old = record;
+             // Neither the handler's memory nor the used old pool is known to be zero-filled
+             PoolConfig config = old.config;
+             config.zeroed = false;
+             release_control(record);
+             if(setup_pool(record, new_pool, new_bytes, config))
              {
-                 LOG::SUCCESS("E_ALLOC", "Expanded pool from %p to %p with size %zu bytes.\n",
+                 rebuild_pool_order();
+                 EALLOC_LOG_SUCCESS("E_ALLOC", "Expanded pool from %p to %p with size %zu bytes.\n",
                               pool, new_pool, new_bytes);
                  return true;
              }
              else
              {
-                 LOG::ERROR("E_ALLOC", "Failed to add expanded pool %p with size %zu bytes.\n",
+                 EALLOC_LOG_ERROR("E_ALLOC", "Failed to add expanded pool %p with size %zu bytes.\n",
                             new_pool, new_bytes);
-                 pool_count++; // Restore pool count if add_pool failed
+                 setup_pool(record, old.memory, old.bytes, config); // Restore the old pool
                  return false;
              }
          }
          else
          {
-             LOG::ERROR("E_ALLOC", "Resize handler failed to allocate memory for pool %p to size %zu bytes.\n",
+             EALLOC_LOG_ERROR("E_ALLOC", "Resize handler failed to allocate memory for pool %p to size %zu bytes.\n",
                         pool, new_bytes);
              return false;
          }
      }
  
      // If no handler or handler failed, report expansion not supported
-     LOG::ERROR("E_ALLOC", "Expanding pool %p is not supported without additional memory mapping or resize handler.\n",
+     EALLOC_LOG_ERROR("E_ALLOC", "Expanding pool %p is not supported without additional memory mapping or resize handler.\n",
                 pool);
      return false;
  }
@@ -809,11 +1741,53 @@
  #if !EALLOC_NO_LOCKING
  void eAlloc::setLock(elock::ILockable* lock) { lock_ = lock; }
  
+ elock::ILockable* eAlloc::lock_for_pool(size_t pool_index) const
+ {
+     if(!usePerPoolLocking_) return lock_;
+     return pool_index < registry_capacity_ ? records_[pool_index].lock : nullptr;
+ }
+ 
+ elock::ILockable* eAlloc::entry_lock() const { return usePerPoolLocking_ ? nullptr : lock_; }
+ 
+ eAlloc::HeapGuard::HeapGuard(const eAlloc& heap) : heap_(heap)
+ {
+     global_ = heap_.lock_ && heap_.lock_->lock(0xFFFFFFFF);
+     if(!heap_.usePerPoolLocking_) return;
+     for(; pools_ < heap_.pool_count; ++pools_)
+     {
+         elock::ILockable* lock = heap_.records_[pools_].lock;
+         if(lock && !lock->lock(0xFFFFFFFF)) break;
+     }
+ }
+ 
+ eAlloc::HeapGuard::~HeapGuard()
+ {
+     while(pools_ > 0)
+     {
+         elock::ILockable* lock = heap_.records_[--pools_].lock;
+         if(lock) lock->unlock();
+     }
+     if(global_) heap_.lock_->unlock();
+ }
+ 
+ bool eAlloc::registry_fixed(const char* caller) const
+ {
+     if(!usePerPoolLocking_) return false;
+     EALLOC_LOG_ERROR("E_ALLOC", "%s: Pools cannot change while per-pool locking is enabled.\n",
+                      caller);
+     return true;
+ }
+ 
+ elock::ILockable* eAlloc::pool_lock(size_t pool_index) const
+ {
+     return usePerPoolLocking_ ? lock_for_pool(pool_index) : nullptr;
+ }
+ 
  void eAlloc::setLockForPool(size_t poolIndex, elock::ILockable* lock)
  {
-     if(poolIndex < MAX_POOL)
+     if(poolIndex < registry_capacity_)
      {
-         pool_locks_[poolIndex] = lock;
+         records_[poolIndex].lock = lock;
      }
  }
  
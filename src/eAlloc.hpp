@@ -16,8 +16,11 @@
  */
  #pragma once
  #include "Logger.hpp"
+ #include "eLog.hpp"
  #include "tlsf.hpp"
  #include "globalELock.hpp"
+ #include "eSnapshot.hpp"
+ #include "eObserver.hpp"
  
  #ifndef EALLOC_NO_LOCKING
      #define EALLOC_NO_LOCKING 0
@@ -31,6 +34,36 @@
      #define EALLOC_ENABLE_OWNERSHIP_TAG 0
  #endif
  
+ #ifndef EALLOC_ENABLE_TRACE
+     #define EALLOC_ENABLE_TRACE 0
+ #endif
+ 
+ #if EALLOC_ENABLE_TRACE
+     #include "eTrace.hpp"
+ #endif
+ 
+ #ifndef EALLOC_ENABLE_PROFILER
+     #define EALLOC_ENABLE_PROFILER 0
+ #endif
+ 
+ #if EALLOC_ENABLE_PROFILER
+     #include "eProfiler.hpp"
+ #endif
+ 
+ #ifndef EALLOC_ENABLE_CLASS_STATS
+     #define EALLOC_ENABLE_CLASS_STATS 0
+ #endif
+ 
+ #include <atomic>
+ 
+ #ifdef EALLOC_OBSERVER_HEADER
+     #include EALLOC_OBSERVER_HEADER
+ #endif
+ 
+ #ifndef EALLOC_OBSERVER
+     #define EALLOC_OBSERVER ::dsa::NullObserver
+ #endif
+ 
  namespace dsa
  {
  
@@ -80,6 +113,20 @@
          LOW_FRAGMENTATION ///< Optimized for low fragmentation.
      };
  
+     /**
+      * @brief How malloc() chooses among the best-ranked pools of a route.
+      *
+      * Priority and policy still decide which pools are eligible first; the strategy picks one of
+      * the pools sharing the top rank from O(1) per-pool occupancy counters. If the chosen pool
+      * cannot serve the request, the rest of the route is tried in order.
+      */
+     enum class PlacementStrategy {
+         PRIORITY,      ///< First pool of the route (pool index order among equals).
+         FULLEST_FIRST, ///< Fewest free bytes: packs allocations and lets other pools drain.
+         LEAST_LOADED,  ///< Fewest bytes in use: spreads work, e.g. across per-pool locks.
+         ROUND_ROBIN    ///< Rotates through the pools on every allocation.
+     };
+
      /**
       * @brief Pool configuration for advanced memory pool management.
       */
@@ -88,14 +135,18 @@
          size_t min_block_size;      ///< Minimum block size for allocations in this pool (reduces
                                      ///< fragmentation).
          size_t preferred_alignment; ///< Preferred alignment for allocations in this pool.
-         int priority;  ///< Priority for pool selection (higher value = higher priority).
+         int priority;  ///< Rank in the allocation route: pools of the requested policy are tried
+                        ///< by descending priority, then all other pools the same way.
          Policy policy; ///< Allocation policy for this pool.
+         bool zeroed;   ///< Pool memory is known to be zero-filled (e.g. fresh mmap or .bss),
+                        ///< letting calloc skip clearing never-used bytes.
          PoolConfig()
          {
              this->priority = 0;
              this->min_block_size = tlsf::min_block_size();
              this->preferred_alignment = tlsf::align_size();
              this->policy = Policy::DEFAULT_POLICY;
+             this->zeroed = false;
          }
          PoolConfig(int priority)
          {
@@ -103,6 +154,7 @@
              this->min_block_size = tlsf::min_block_size();
              this->preferred_alignment = tlsf::align_size();
              this->policy = Policy::DEFAULT_POLICY;
+             this->zeroed = false;
          }
          PoolConfig(int priority, size_t min_block_size, size_t preferred_alignment)
          {
@@ -110,6 +162,7 @@
              this->min_block_size = min_block_size;
              this->preferred_alignment = preferred_alignment;
              this->policy = Policy::DEFAULT_POLICY;
+             this->zeroed = false;
          }
          PoolConfig(int priority, size_t min_block_size, size_t preferred_alignment, Policy policy)
          {
@@ -117,19 +170,220 @@
              this->min_block_size = min_block_size;
              this->preferred_alignment = preferred_alignment;
              this->policy = policy;
+             this->zeroed = false;
          }
      };
  
       private:
-     Control controls[MAX_POOL];        ///< TLSF control structure.
-     void* memory_pools[MAX_POOL];      ///< Array of memory pool pointers.
-     size_t pool_sizes[MAX_POOL];       ///< store all pool sizes
-     PoolConfig pool_configs[MAX_POOL]; ///< Array of pool configurations.
-     size_t pool_count = 0;             ///< Number of active pools.
+     // The *_impl functions expect the caller to hold entry_lock(), so public entry points can
+     // share them without re-locking; under per-pool locking they take each pool's lock
+     // themselves.
+
+     /**
+      * @brief Core of malloc(); optionally reports the allocating pool's zero mark as it was
+      *        before this allocation raised it.
+      */
+     void* malloc_impl(size_t size, Policy policy, char** prev_zero_mark);
+
+     /// @brief Core of memalign().
+     void* memalign_impl(size_t align, size_t size);
+
+     /// @brief Core of realloc_sized().
+     void* realloc_impl(void* ptr, size_t old_used, size_t size);
+
+     /// @brief Core of defragment().
+     size_t defragment_impl();
+
+     /// @brief Core of walk_pool() for a registered pool.
+     void walk_pool_impl(size_t pool_index, Walker walker, void* user);
+
+     /// @brief Visits every block of a registered pool in address order; the walk behind
+     ///        walk_pool_impl() and snapshot(), inlined into each caller.
+     template <typename Visit>
+     void for_each_block(size_t pool_index, Visit&& visit)
+     {
+         BlockHeader* block = tlsf::first_block(records_[pool_index].heap);
+         while(block && !tlsf::is_last(block))
+         {
+             visit(block);
+             block = tlsf::next(block);
+         }
+     }
+
+ #if !EALLOC_NO_LOCKING
+     /// @brief Lock guarding operations on one pool: its own lock under per-pool locking (none if
+     ///        it was not given one), else the global lock (which may be null).
+     elock::ILockable* lock_for_pool(size_t pool_index) const;
+ 
+     /// @brief Lock malloc, calloc, memalign, realloc and free take on entry: the global lock, or
+     ///        none under per-pool locking.
+     elock::ILockable* entry_lock() const;
+ 
+     /// @brief Lock the allocation cores take while working on one pool: lock_for_pool() under
+     ///        per-pool locking, else none because the entry lock already covers every pool.
+     elock::ILockable* pool_lock(size_t pool_index) const;
+
+     /// @brief Refuses (and logs) a pool registry change from @p caller under per-pool locking,
+     ///        where frees look their pool up before taking any lock.
+     bool registry_fixed(const char* caller) const;
+
+     /**
+      * @brief Holds every lock that guards the heap for its scope: the global lock, then under
+      *        per-pool locking each pool's lock in index order.
+      *
+      * Whole-heap operations (report(), check(), defragment(), compact()) take it. Allocation
+      * paths hold at most one pool lock at a time and take the global lock only before one, so
+      * the order cannot deadlock.
+      */
+     class HeapGuard
+     {
+        public:
+         explicit HeapGuard(const eAlloc& heap);
+         ~HeapGuard();
+         HeapGuard(const HeapGuard&) = delete;
+         HeapGuard& operator=(const HeapGuard&) = delete;
+
+        private:
+         const eAlloc& heap_;
+         bool global_ = false; ///< Whether the global lock was acquired.
+         size_t pools_ = 0;    ///< Pool locks acquired, always those of pools [0, pools_).
+     };
+ #endif
+ 
+     /// @brief Number of Policy values; one allocation route is kept per policy.
+     static constexpr size_t POLICY_COUNT = 4;
+
+     /// @brief Book-keeping for one registered pool.
+     struct PoolRecord
+     {
+         Control* control = nullptr; ///< TLSF control: an inline slot or the head of the pool.
+         void* memory = nullptr;     ///< Pool address as passed to add_pool() (the pool's key).
+         void* heap = nullptr;       ///< First byte managed by the TLSF control.
+         size_t bytes = 0;           ///< Raw size passed to add_pool().
+         size_t size = 0;            ///< Size of the pool's initial free block.
+         PoolConfig config;          ///< Pool configuration.
+         char* zero_mark = nullptr;  ///< Bytes at or above this address have never been handed
+                                     ///< out and are zero (pool end if unknown).
+ #if !EALLOC_NO_LOCKING
+         elock::ILockable* lock = nullptr; ///< Per-pool lock; stays with the pool.
+ #endif
+         size_t route_next[POLICY_COUNT] = {}; ///< Next pool to try after this one, per policy.
+         size_t peak_in_use = 0; ///< Highest size - control->free_bytes seen after an allocation.
+         size_t allocations = 0; ///< Blocks handed out from this pool.
+         size_t failures = 0;    ///< Allocations tried in this pool that it could not serve.
+     };
+
+     /**
+      * @brief Raises a pool's zero mark past a block that is being handed out.
+      * @return The mark before the update.
+      */
+     char* raise_zero_mark(PoolRecord& pool, void* ptr);
+
+     /**
+      * @brief Shared body of free() and free_sized(): takes the pool's lock (the callers hold the
+      *        global one), checks @p size against the block, reports the free to the trace,
+      *        profiler and observer, then releases the block.
+      * @param size Size the caller claims for the block; 0 when unknown.
+      */
+     void free_at(void* ptr, size_t pool_index, size_t size);
+
+     /**
+      * @brief Returns a block to the given pool (the pool lookup is done once by the caller).
+      */
+     void free_in_pool(void* ptr, size_t pool_index);
+
+     /**
+      * @brief Re-sorts pool_order_ by pool start address and rebuilds the allocation routes;
+      *        called whenever pools change.
+      *
+      * The route of a policy lists the pools of that policy by descending priority, followed by
+      * all other pools by descending priority (ties keep pool index order). The head of a route
+      * is the highest-priority candidate, so it also satisfies any priority filter that some
+      * candidate could, and malloc() just walks the route until a pool has room.
+      */
+     void rebuild_pool_order();
+
+     /**
+      * @brief Finds the pool whose range contains @p ptr by binary search over pool_order_.
+      * @return Index of the owning pool, or INVALID_POOL_INDEX if no pool contains the address.
+      */
+     size_t find_pool_index(const void* ptr) const;
+
+     /**
+      * @brief Picks the pool preferred by the placement strategy among the top-ranked pools of
+      *        a route, considering only pools whose largest free block can hold @p size.
+      * @return Pool index, or INVALID_POOL_INDEX to just walk the route.
+      */
+     size_t place(size_t route, size_t size);
+
+     /**
+      * @brief Places the TLSF control for a new pool and carves its initial free block.
+      *
+      * The control sits at the pool's head, so a pool needs at least min_pool_size() bytes.
+      * Builds with EALLOC_INLINE_CONTROLS keep that many slots for smaller pools; pools of at
+      * least EMBED_CONTROL_FACTOR control sizes (or any pool that fits one once the slots are
+      * exhausted) still host their own.
+      */
+     bool setup_pool(PoolRecord& pool, void* mem, size_t bytes, const PoolConfig& config);
+
+     /// @brief Returns an inline control slot taken by setup_pool(), if any.
+     void release_control(PoolRecord& pool);
+
+     /// @brief Carves @p size bytes straight from one pool, bypassing selection and hooks.
+     void* allocate_internal(PoolRecord& pool, size_t size);
+
+     /// @brief Serves @p size bytes (@p adjusted after rounding) from one pool under its
+     ///        pool_lock(); reports the pool's previous zero mark through @p prev_zero_mark.
+     ///        Without @p wait, a pool whose lock is held elsewhere is skipped (nullptr).
+     void* allocate_from(size_t pool_index, size_t adjusted, size_t size, char** prev_zero_mark,
+                         bool wait = true);
+
+     /// @brief Counts an allocation served by @p pool and raises its peak; the caller holds the
+     ///        pool's lock.
+     static void note_pool_alloc(PoolRecord& pool);
+
+     /// @brief Raises @p pool's peak to its current usage; the caller holds the pool's lock.
+     static void raise_pool_peak(PoolRecord& pool);
+
+ #if EALLOC_ENABLE_CLASS_STATS || EALLOC_ENABLE_OWNERSHIP_TAG
+     /**
+      * @brief Book-keeping for a block just handed out for a request of @p requested bytes:
+      *        tags it with the current owner and charges the owner and size-class counters.
+      */
+     void count_alloc(void* ptr, size_t requested);
+
+     /// @brief Reverses count_alloc() for a used block about to be freed or resized.
+     void count_release(const BlockHeader* block);
+ #else
+     void count_alloc(void*, size_t) {}
+     void count_release(const BlockHeader*) {}
+ #endif
+
+     /**
+      * @brief Moves the pool registry into storage for @p capacity records.
+      *
+      * Beyond the inline capacity the storage is carved from the pools themselves (any pool but
+      * @p skip, then @p pending, a pool that is not registered yet).
+      */
+     bool move_registry(size_t capacity, size_t skip, PoolRecord* pending);
+
+ #if EALLOC_INLINE_CONTROLS
+     Control inline_controls_[INLINE_CONTROLS]; ///< Control slots for pools too small to host one.
+     bool inline_control_used_[INLINE_CONTROLS] = {false};
+ #endif
+     PoolRecord inline_records_[MAX_POOL];  ///< Registry storage until more pools are added.
+     size_t inline_order_[MAX_POOL];
+     PoolRecord* records_ = inline_records_; ///< Registered pools, indexed by pool index.
+     size_t* pool_order_ = inline_order_;    ///< Pool indices sorted by start address.
+     size_t registry_capacity_ = MAX_POOL;   ///< Records available at records_.
+     size_t route_head_[POLICY_COUNT];       ///< First pool of each policy's route.
+     size_t route_lead_[POLICY_COUNT];       ///< Pools sharing the head's rank on each route.
+     PlacementStrategy placement_ = PlacementStrategy::PRIORITY; ///< Strategy used by malloc().
+     std::atomic<size_t> round_robin_{0};    ///< Rotation counter for ROUND_ROBIN placement.
+     size_t pool_count = 0;                  ///< Number of active pools.
      bool initialised = false;          ///< Flag indicating if the allocator is initialized.
  #if !EALLOC_NO_LOCKING
      elock::ILockable* lock_ = nullptr;
-     elock::ILockable* pool_locks_[MAX_POOL] = {nullptr};
  #endif
      AllocationFailureHandler failure_handler_ = nullptr;
      void* failure_handler_data_ = nullptr;
@@ -140,12 +394,51 @@
      size_t alloc_count_ =
          0; ///< Counter for malloc calls to control auto-defragmentation frequency.
      bool usePerPoolLocking_ = false; // Flag to toggle between global and per-pool locking
+ 
+     /// @brief Indirection table entry backing a relocatable handle.
+     struct HandleEntry
+     {
+         void* ptr = nullptr; ///< Current address of the block, nullptr if the slot is unused.
+         uint16_t pins = 0;   ///< Outstanding pin() calls; pinned blocks are never moved.
+     };
+     HandleEntry handles_[MAX_HANDLES]; ///< Handle table for relocatable allocations.
  #if defined(EALLOC_ENABLE_OWNERSHIP_TAG) && EALLOC_ENABLE_OWNERSHIP_TAG
      uint32_t ownership_tag_ = 0; ///< Default ownership tag for new allocations.
+
+     /// @brief Live-usage counters of one owner tag.
+     struct OwnerSlot
+     {
+         std::atomic<uint64_t> key{0}; ///< Tag + 1 once claimed, 0 while free.
+         std::atomic<size_t> live_bytes{0};
+         std::atomic<size_t> live_blocks{0};
+         std::atomic<size_t> peak_bytes{0};
+         std::atomic<size_t> allocations{0};
+     };
+     /// @brief Open-addressing table of MAX_OWNER_TAGS tags; the extra last slot collects every
+     ///        tag that found the table full. Slots are never released, so probes stay short.
+     OwnerSlot owners_[MAX_OWNER_TAGS + 1];
+
+     /// @brief Slot counting @p tag, claimed on first use; the overflow slot if the table is full.
+     OwnerSlot& owner_slot(uint32_t tag);
+
+     /// @brief Slot already holding @p tag, or nullptr.
+     const OwnerSlot* find_owner_slot(uint32_t tag) const;
+ #endif
+ #if EALLOC_ENABLE_TRACE
+     TraceRecorder* trace_ = nullptr; ///< Event sink for allocation tracing, if attached.
+ #endif
+ #if EALLOC_ENABLE_PROFILER
+     HeapProfiler* profiler_ = nullptr; ///< Sampling heap profiler, if attached.
+ #endif
+ #if EALLOC_ENABLE_CLASS_STATS
+     tlsf::ClassCounters class_counters_[tlsf::total_shelves()]; ///< Indexed fl * shelves() + sl.
  #endif
  
  public:
  
+     /// @brief Observer policy notified of allocator events (see EALLOC_OBSERVER).
+     using Observer = EALLOC_OBSERVER;
+ 
      /**
       * @brief Walks through the blocks in a pool with a specified walker function.
       * @param pool Pointer to the pool to walk.
@@ -157,7 +450,7 @@
      /**
       * @brief Allocates raw memory of a specified size without constructing an object.
       * @param size Size of memory to allocate in bytes.
-      * @param priority Optional priority for pool selection (-1 for default).
+      * @param priority Ignored, see malloc(size_t, int, Policy).
       * @param policy Optional policy for pool selection.
       * @return Pointer to the allocated raw memory, or nullptr if allocation fails.
       */
@@ -174,7 +467,7 @@
      /**
       * @brief Template version of allocate_raw for type-safe size calculation.
       * @tparam T The type whose size will be used for allocation.
-      * @param priority Optional priority for pool selection (-1 for default).
+      * @param priority Ignored, see malloc(size_t, int, Policy).
       * @param policy Optional policy for pool selection.
       * @return Pointer to the allocated raw memory, or nullptr if allocation fails.
       */
@@ -229,16 +522,20 @@
      /**
      * @brief Allocates a block of memory of the specified size.
      * @param size The size of the memory block to allocate in bytes.
-     * @param priority Optional priority for pool selection (-1 for default).
- 
      * @return Pointer to the allocated memory, or nullptr if allocation fails.
      */
      void* malloc(size_t size);
  
      /**
       * @brief Allocates a block of memory of the specified size.
+      *
+      * Pools are tried along a route precomputed when pools change: pools with @p policy by
+      * descending priority, then every other pool by descending priority. The priorities are
+      * those of each pool's PoolConfig; the route head is already the highest-priority pool, so
+      * the per-call @p priority has nothing left to select and is ignored.
+      *
       * @param size The size of the memory block to allocate in bytes.
-      * @param priority Optional priority for pool selection (-1 for default).
+      * @param priority Ignored; kept for source compatibility (pass -1).
       * @param policy Optional policy for pool selection.
       * @return Pointer to the allocated memory, or nullptr if allocation fails.
       */
@@ -250,6 +547,40 @@
       */
      void free(void* ptr);
  
+     /**
+      * @brief Frees a block whose size is known to the caller.
+      * @param ptr Pointer to the memory block to free.
+      * @param size Size originally requested (or any value up to usable_size(ptr)); checked in
+      *             debug builds. It is only checked: the pool lookup runs as in free(), so a
+      *             sized free is no faster.
+      */
+     void free_sized(void* ptr, size_t size);
+ 
+     /// @brief Result of allocate_at_least(): the block and its usable capacity.
+     struct AllocationResult
+     {
+         void* ptr;    ///< Allocated memory, or nullptr on failure.
+         size_t count; ///< Usable bytes at ptr (>= the requested size), 0 on failure.
+     };
+ 
+     /**
+      * @brief Allocates at least @p size bytes and reports the real capacity granted.
+      *
+      * The request is rounded up to its TLSF size class, which every candidate block satisfies
+      * anyway, so containers can grow into the slack instead of reallocating early.
+      *
+      * @param size Minimum number of bytes required.
+      * @return Pointer and usable size of the block.
+      */
+     AllocationResult allocate_at_least(size_t size);
+ 
+     /**
+      * @brief Returns the number of usable bytes in an allocated block.
+      * @param ptr Pointer returned by one of the allocation functions.
+      * @return Usable size in bytes (>= the requested size), or 0 for nullptr.
+      */
+     size_t usable_size(const void* ptr) const;
+ 
      /**
       * @brief Allocates a memory block with specified alignment and size.
       * @param align The alignment requirement in bytes (must be a power of 2).
@@ -267,8 +598,26 @@
       */
      void* realloc(void* ptr, size_t size);
  
+     /**
+      * @brief Reallocates a memory block, copying only the bytes the caller reports as live.
+      *
+      * Behaves like realloc(), but when the block has to move only the first @p old_used bytes
+      * are copied. Moves of at least STREAM_COPY_THRESHOLD bytes use non-temporal stores where
+      * the target supports them, so the copy does not evict the caller's working set.
+      *
+      * @param ptr Pointer to the memory block to reallocate.
+      * @param old_used Number of leading bytes of the current block that must be preserved.
+      * @param size The new size of the memory block in bytes.
+      * @return Pointer to the reallocated memory, or nullptr if reallocation fails.
+      */
+     void* realloc_sized(void* ptr, size_t old_used, size_t size);
+ 
      /**
       * @brief Allocates memory for an array and initializes it to zero.
+      *
+      * Only bytes below the pool's zero mark (see PoolConfig::zeroed) are cleared; memory that
+      * has never been handed out from a zeroed pool is returned as is.
+      *
       * @param num Number of elements in the array.
       * @param size Size of each element in bytes.
       * @return Pointer to the allocated memory, or nullptr if allocation fails.
@@ -297,7 +646,7 @@
          }
          if(!memory)
          {
-             LOG::ERROR("E_ALLOC", "Memory allocation failed for object.");
+             EALLOC_LOG_ERROR("E_ALLOC", "Memory allocation failed for object.");
              return nullptr;
          }
          return new(memory) T(obj);
@@ -320,7 +669,7 @@
          }
          if(!memory)
          {
-             LOG::ERROR("E_ALLOC", "Memory allocation failed for object.");
+             EALLOC_LOG_ERROR("E_ALLOC", "Memory allocation failed for object.");
              return nullptr;
          }
          T* obj = new(memory) T(std::forward<Args>(args)...);
@@ -346,10 +695,16 @@
  
      /**
       * @brief Adds a new memory pool to the allocator.
+      *
+      * The number of pools is not bounded by MAX_POOL: once the inline registry is full it grows
+      * inside the pools. Each pool hosts its TLSF control at its head, so @p bytes must be at
+      * least min_pool_size() (unless built with EALLOC_INLINE_CONTROLS).
+      *
       * @param mem Pointer to the memory block to add as a pool.
       * @param bytes Size of the memory block in bytes.
       * @param config Configuration for the pool.
-      * @return Pointer to the added pool, or nullptr if addition fails.
+      * @return Pointer to the added pool, or nullptr if addition fails or per-pool locking is
+      *         enabled (see setPerPoolLocking()).
       */
      void* add_pool(void* mem, size_t bytes, const PoolConfig& config = PoolConfig());
  
@@ -358,7 +713,7 @@
       * @param pool Pointer to the pool to remove.
       * @note The pool must contain no allocated blocks; all memory allocated
       *       from it must be freed prior to removal, or undefined behavior
-      *       will result.
+      *       will result. Refused while per-pool locking is enabled.
       */
      void remove_pool(void* pool);
  
@@ -366,7 +721,8 @@
       * @brief Resizes an existing memory pool at runtime.
       * @param pool Pointer to the existing pool memory to resize.
       * @param new_bytes New size of the memory pool in bytes.
-      * @return True if resizing was successful, false otherwise.
+      * @return True if resizing was successful, false otherwise (always while per-pool locking
+      *         is enabled).
       */
      bool resize_pool(void* pool, size_t new_bytes);
  
@@ -406,11 +762,87 @@
       */
      static void integrity_walker(void* ptr, size_t size, int used, void* user);
  
+     /**
+      * @brief Accuracy of a storage report.
+      */
+     enum class ReportMode {
+         FAST,  ///< O(1) per pool from the TLSF counters and bitmaps; extremes are class estimates.
+         EXACT  ///< Walks every block of every pool; intended for diagnostics.
+     };
+ 
      /**
       * @brief Generates a storage usage report.
+      *
+      * In FAST mode totalFreeSpace and freeBlockCount are exact, while largestFreeRegion and
+      * smallestFreeRegion are taken from the highest/lowest populated size class and may differ
+      * from the true extremes by less than one second-level class width.
+      *
+      * @param mode Report accuracy (defaults to the constant-time FAST mode).
       * @return StorageReport containing free space and fragmentation details.
       */
-     StorageReport report() const;
+     StorageReport report(ReportMode mode = ReportMode::FAST) const;
+
+     /**
+      * @brief Usage counters of one pool, kept up to date by every allocation and free.
+      *
+      * Byte figures include block headers, so they measure how much of the pool a workload
+      * really consumes: a pool whose peak_in_use stays well below size can be shrunk by the
+      * difference, and one with failures is too small for what is routed to it.
+      */
+     struct PoolStats
+     {
+         size_t index = 0;       ///< Position in the pool list.
+         void* memory = nullptr; ///< Pool address as passed to add_pool().
+         size_t bytes = 0;       ///< Raw size passed to add_pool().
+         size_t size = 0;        ///< Bytes the pool can hand out (bytes minus pool overhead).
+         size_t in_use = 0;      ///< Bytes taken by used blocks and their headers.
+         size_t peak_in_use = 0; ///< Highest in_use seen (see reset_pool_peaks()).
+         size_t allocations = 0; ///< Blocks handed out; a realloc in place is not counted.
+         size_t failures = 0;    ///< Allocations tried in this pool that it could not serve; a
+                                 ///< request that spills over to another pool counts here too.
+     };
+
+     /// @brief Counters of the pool at @p index; all zero if there is no such pool.
+     PoolStats pool_stats(size_t index) const;
+
+     /**
+      * @brief Copies the counters of every pool, in pool order. Each pool is read under its
+      *        own lock.
+      * @return Number of pools, which may exceed @p capacity.
+      */
+     size_t pool_report(PoolStats* out, size_t capacity) const;
+
+     /// @brief Restarts peak tracking of every pool from its current usage.
+     void reset_pool_peaks();
+
+   private:
+     /// @brief Fills @p stats from the pool at @p index; the caller holds the pool's lock.
+     void fill_pool_stats(PoolStats& stats, size_t index) const;
+
+   public:
+
+     /// @brief Receives the bytes of a snapshot; see eSnapshot.hpp.
+     using SnapshotSink = SnapshotWriter::Sink;
+
+     /**
+      * @brief Serialises the block map of every pool (offset, size, used/free, owner tag).
+      *
+      * Each pool is encoded under its own lock (the global lock unless per-pool locking is on)
+      * and the lock is released between pools, so a live system only pauses for one pool walk
+      * at a time. The sink runs while that lock is held: hand it a RAM buffer or a fast stream
+      * and write the file afterwards. Decode with SnapshotReader or the ealloc_snapshot tool.
+      *
+      * @param sink Receives the encoded bytes in chunks of a few hundred bytes.
+      * @param user Passed through to @p sink.
+      * @return Total number of bytes produced.
+      */
+     size_t snapshot(SnapshotSink sink, void* user);
+
+   private:
+     /// @brief Core of report(); the caller holds the lock.
+     StorageReport report_impl(ReportMode mode) const;
+
+   public:
  
      /**
       * @brief Logs the storage usage report.
@@ -453,7 +885,7 @@
          void* memory = allocate_raw(sizeof(LockType));
          if(!memory)
          {
-             LOG::ERROR("E_ALLOC", "Memory allocation failed for lock object.");
+             EALLOC_LOG_ERROR("E_ALLOC", "Memory allocation failed for lock object.");
              return nullptr;
          }
          LockType* lock = new(memory) LockType(std::forward<Args>(args)...);
@@ -487,6 +919,62 @@
       */
      size_t defragment();
  
+     /// @brief Identifier of a relocatable allocation (index into the handle table).
+     using Handle = size_t;
+ 
+     /// @brief Value returned by allocate_handle() when no handle could be created.
+     static constexpr Handle INVALID_HANDLE = MAX_HANDLES;
+ 
+     /**
+      * @brief Allocates a relocatable block that compact() may move while it is unpinned.
+      * @param size Size of the block in bytes.
+      * @return Handle of the block, or INVALID_HANDLE if the table is full or memory is exhausted.
+      */
+     Handle allocate_handle(size_t size);
+ 
+     /**
+      * @brief Pins a handle and returns its current address.
+      *
+      * The address stays valid until the matching unpin(). Pins nest.
+      *
+      * @param handle Handle returned by allocate_handle().
+      * @return Pointer to the block, or nullptr if the handle is invalid.
+      */
+     void* pin(Handle handle);
+ 
+     /**
+      * @brief Releases one pin taken with pin(); the block becomes movable once all pins are released.
+      * @param handle Handle returned by allocate_handle().
+      */
+     void unpin(Handle handle);
+ 
+     /**
+      * @brief Frees the block behind a handle and releases the handle slot.
+      * @param handle Handle returned by allocate_handle().
+      * @note Any pointer previously obtained through pin() becomes invalid.
+      */
+     void free_handle(Handle handle);
+ 
+     /**
+      * @brief Compacts every pool by sliding unpinned handle blocks toward the pool start.
+      *
+      * Each movable block that follows a free block is moved down over it and the hole is
+      * re-inserted (and coalesced) behind it, so free space migrates toward the pool end.
+      * Blocks allocated through malloc() and pinned handles act as fixed barriers.
+      *
+      * @return The number of blocks moved.
+      */
+     size_t compact();
+ 
+     /**
+      * @brief Selects how malloc() spreads allocations over equally ranked pools.
+      * @param strategy Placement strategy (PRIORITY by default).
+      */
+     void setPlacementStrategy(PlacementStrategy strategy) { placement_ = strategy; }
+
+     /// @brief Returns the current placement strategy.
+     PlacementStrategy getPlacementStrategy() const { return placement_; }
+
      /**
       * @brief Enables or disables automatic defragmentation when fragmentation exceeds a threshold.
       * @param enable Whether to enable auto-defragmentation.
@@ -497,15 +985,27 @@
  
      /**
       * @brief Enable or disable per-pool locking to customize locking granularity.
-      *        When enabled, operations on specific pools will use the corresponding pool lock if
-      * set, reducing contention compared to using a global lock for all operations.
-      * @param enable True to use per-pool locks when available, false to use global lock.
+      *        When enabled, malloc, calloc, memalign, realloc and free lock each pool only while
+      *        working on it, so threads served by different pools do not contend; malloc passes
+      *        over a pool another thread holds if a later pool has room. Every pool
+      *        needs its own lock (setLockForPool()), distinct from the global lock, which still
+      *        guards the handle table. Whole-heap operations such as report(), check(),
+      *        defragment() and compact() take the global lock and then every pool lock.
+      *        Auto-defragmentation is skipped in this mode, and an attached HeapProfiler sees
+      *        events from several threads at once, so profile with the global lock.
+      *        free() resolves a pointer's pool before it takes any lock, so the pool set is fixed
+      *        in this mode: add_pool(), remove_pool() and resize_pool() fail. Add the pools, then
+      *        enable per-pool locking, and switch it only while no other thread uses the
+      *        allocator.
+      * @param enable True to use per-pool locks, false to use the global lock.
       */
      void setPerPoolLocking(bool enable);
  
      /**
       * @brief Set a lock for a specific memory pool.
-      * @param poolIndex Index of the pool (0 to MAX_POOL-1).
+      * @param poolIndex Index of the pool; the lock moves with the pool if indices are
+      *        reshuffled by remove_pool(). Indices not in use yet may be prepared up to
+      *        the current registry capacity (at least MAX_POOL).
       * @param lock Pointer to the lock object for this pool.
       */
      void setLockForPool(size_t poolIndex, elock::ILockable* lock);
@@ -513,9 +1013,30 @@
      /**
       * @brief Get the index of a pool from its memory address.
       * @param pool Pointer to the pool memory.
-      * @return Index of the pool, or MAX_POOL if not found.
+      * @return Index of the pool, or INVALID_POOL_INDEX if not found.
       */
      size_t get_pool_index(void* pool) const;
+
+     /// @brief Value returned by get_pool_index() for an unknown pool.
+     static constexpr size_t INVALID_POOL_INDEX = static_cast<size_t>(-1);
+
+     /// @brief Number of pools currently registered.
+     size_t get_pool_count() const { return pool_count; }
+
+     /// @brief Bytes a pool aligned to alignof(std::max_align_t) gives up at its head to host its
+     ///        TLSF control; a less aligned pool loses up to alignof(std::max_align_t) more.
+     static constexpr size_t pool_control_bytes() { return sizeof(Control); }
+
+     /**
+      * @brief Smallest memory block add_pool() accepts at any alignment: the pool's control plus
+      *        the pool overhead and one minimum block. Builds with EALLOC_INLINE_CONTROLS also
+      *        accept smaller pools while inline slots remain.
+      */
+     static constexpr size_t min_pool_size()
+     {
+         return pool_control_bytes() + alignof(Control) + tlsf::pool_overhead()
+                + tlsf::min_block_size();
+     }
  
  #if defined(EALLOC_ENABLE_OWNERSHIP_TAG) && EALLOC_ENABLE_OWNERSHIP_TAG
      /**
@@ -529,6 +1050,125 @@
       * @return 32-bit tag representing the owner.
       */
      uint32_t getOwnershipTag() const { return ownership_tag_; }
+ 
+     /**
+      * @brief Live usage charged to one owner tag, maintained in O(1) per malloc/free.
+      *
+      * Blocks are charged to the tag current when they were allocated (or last reallocated)
+      * and uncharged when freed, whichever tag is current then. Usable bytes are counted.
+      */
+     struct OwnerStats
+     {
+         uint32_t tag = 0;         ///< Owner tag (meaningless for the overflow entry).
+         bool overflow = false;    ///< Sum of all tags that did not fit in MAX_OWNER_TAGS slots.
+         size_t live_bytes = 0;    ///< Usable bytes currently allocated.
+         size_t live_blocks = 0;   ///< Blocks currently allocated.
+         size_t peak_bytes = 0;    ///< Highest live_bytes seen (see reset_owner_peaks()).
+         size_t allocations = 0;   ///< Blocks allocated so far.
+     };
+ 
+     /// @brief Counters of @p tag; all zero if the tag was never seen (or overflowed).
+     OwnerStats owner_stats(uint32_t tag) const;
+ 
+     /**
+      * @brief Copies the counters of every tracked tag, then the overflow entry if it was used.
+      * @return Number of entries available, which may exceed @p capacity.
+      */
+     size_t owner_report(OwnerStats* out, size_t capacity) const;
+ 
+     /// @brief Restarts peak tracking from the current live bytes of every tag.
+     void reset_owner_peaks();
+ 
+     /// @brief Receives one outstanding block from leak_report().
+     using LeakVisitor = void (*)(void* ptr, size_t size, uint32_t tag, void* user);
+ 
+     /**
+      * @brief Visits every block still allocated, pool by pool under the pool's lock.
+      *
+      * Unlike the per-tag counters this walks the heap; meant for shutdown or on-demand
+      * diagnostics. The allocator's own registry storage is not reported.
+      * @return Number of outstanding blocks.
+      */
+     size_t leak_report(LeakVisitor visitor, void* user);
+ 
+     /**
+      * @brief Logs the per-tag counters and up to @p max_blocks outstanding blocks.
+      * @return Number of outstanding blocks.
+      */
+     size_t logLeakReport(size_t max_blocks = 16);
+ #endif
+ 
+ #if EALLOC_ENABLE_TRACE
+     /**
+      * @brief Attaches a recorder that receives every malloc/calloc/memalign/realloc/free.
+      *
+      * The log is a valid serialisation of the heap only while per-pool locking is off. Blocks
+      * managed through handles are not traced. Pass nullptr to stop tracing. See eTrace.hpp for
+      * the log format.
+      * @param recorder Recorder to feed; must outlive the allocator or be detached first.
+      */
+     void setTraceRecorder(TraceRecorder* recorder) { trace_ = recorder; }
+ 
+     /// @brief Currently attached trace recorder, or nullptr.
+     TraceRecorder* getTraceRecorder() const { return trace_; }
+ #endif
+ 
+ #if EALLOC_ENABLE_PROFILER
+     /**
+      * @brief Attaches a sampling heap profiler (see eProfiler.hpp); nullptr detaches it.
+      *
+      * Attach before the blocks of interest are allocated: blocks allocated earlier are never
+      * sampled. The profiler must outlive the allocator or be detached first.
+      */
+     void setHeapProfiler(HeapProfiler* profiler) { profiler_ = profiler; }
+ 
+     /// @brief Currently attached heap profiler, or nullptr.
+     HeapProfiler* getHeapProfiler() const { return profiler_; }
+ #endif
+ 
+ #if EALLOC_ENABLE_CLASS_STATS
+     /**
+      * @brief Counters of one TLSF size class, summed over all pools.
+      *
+      * A block is charged to the class its usable size is filed under. Requested vs granted
+      * bytes measure the internal waste of alignment, minimum-size and unsplittable-tail
+      * rounding; an in-place realloc counts as a release plus a new allocation.
+      */
+     struct SizeClassStats
+     {
+         size_t fl = 0;              ///< First-level index.
+         size_t sl = 0;              ///< Second-level index.
+         size_t min_size = 0;        ///< Smallest block size filed in this class.
+         size_t allocations = 0;     ///< Blocks handed out in this class.
+         size_t live = 0;            ///< Blocks of this class currently in use.
+         size_t requested_bytes = 0; ///< Bytes asked for by those allocations.
+         size_t granted_bytes = 0;   ///< Usable bytes granted to them (>= requested_bytes).
+         size_t splits = 0;          ///< Blocks of this class split to serve a smaller request.
+         size_t merges = 0;          ///< Coalesces (free, realloc, defragment) yielding this class.
+     };
+ 
+     /// @brief Number of (fl, sl) classes: valid indices are fl < size_class_count() / shelves.
+     static constexpr size_t size_class_count() { return tlsf::total_shelves(); }
+ 
+     /**
+      * @brief Counters of the class (fl, sl); zeroed stats for indices out of range.
+      */
+     SizeClassStats size_class_stats(size_t fl, size_t sl) const;
+ 
+     /// @brief Counters of the class a block with @p size usable bytes is filed under.
+     SizeClassStats size_class_stats_for(size_t size) const;
+ 
+     /**
+      * @brief Copies the counters of every class that has seen any activity, smallest first.
+      * @param out Destination array.
+      * @param capacity Entries available at @p out.
+      * @return Number of active classes, which may exceed @p capacity (only the first
+      *         @p capacity are written).
+      */
+     size_t size_class_report(SizeClassStats* out, size_t capacity) const;
+ 
+     /// @brief Zeroes every counter except the live block counts.
+     void reset_size_class_stats();
  #endif
  
    
@@ -553,7 +1193,46 @@
      #define EALLOC_NO_OWNERSHIP_CHECKING 0
  #endif
  
+ /**
+  * @def EALLOC_ENABLE_OWNERSHIP_TAG
+  * @brief Compile-time option storing a 32-bit owner tag in every block header (one extra
+  *        header word per block) and keeping O(1) live-usage counters per tag for up to
+  *        MAX_OWNER_TAGS tags (eAlloc::owner_stats(), eAlloc::logLeakReport()).
+  */
  #ifndef EALLOC_ENABLE_OWNERSHIP_TAG
      #define EALLOC_ENABLE_OWNERSHIP_TAG 0
  #endif
+ 
+ /**
+  * @def EALLOC_ENABLE_TRACE
+  * @brief Compile-time option adding eAlloc::setTraceRecorder() for recording allocation traces
+  *        (see eTrace.hpp). Off by default; when off the allocator carries no tracing code.
+  */
+ 
+ /**
+  * @def EALLOC_ENABLE_PROFILER
+  * @brief Compile-time option adding eAlloc::setHeapProfiler() for sampling heap profiles
+  *        (see eProfiler.hpp). Off by default.
+  */
+ 
+ /**
+  * @def EALLOC_ENABLE_CLASS_STATS
+  * @brief Compile-time option adding per-size-class counters (eAlloc::size_class_stats()).
+  *        Costs a few relaxed atomic increments per operation and six counters per class
+  *        (tlsf::total_shelves() classes) in the allocator object. Off by default.
+  */
+ 
+ /**
+  * @def EALLOC_OBSERVER
+  * @brief Observer policy whose static hooks see every malloc, free, realloc, pool addition and
+  *        allocation failure (see eObserver.hpp). Defaults to dsa::NullObserver, which compiles
+  *        away; define EALLOC_OBSERVER_HEADER to a quoted header declaring your own policy.
+  */
+ 
+ /**
+  * @def EALLOC_LOG_LEVEL
+  * @brief Most verbose diagnostics compiled in: EALLOC_LOG_LEVEL_NONE, _ERROR, _WARNING, _INFO
+  *        (default) or _DEBUG (see eLog.hpp). Hot-path diagnostics such as double frees are
+  *        buffered in dsa::event_log() and only formatted by EventLog::dump().
+  */
  
\ No newline at end of file
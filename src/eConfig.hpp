@@ -1,14 +1,56 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 
 namespace dsa {
 
-static constexpr size_t MAX_POOL = 5; ///< Maximum number of memory pools allowed.
-static constexpr size_t MAX_SLI=5;
-static constexpr size_t DEFAULT_ALIGN_EXP=2;
+static constexpr size_t MAX_POOL = 5; ///< Inline pool registry slots; more pools may be added.
+#ifndef EALLOC_INLINE_CONTROLS
+    #define EALLOC_INLINE_CONTROLS 0
+#endif
+/// TLSF control slots kept inside eAlloc for pools too small to host their own. 0 (the default)
+/// makes every pool carry its control at its head, so eAlloc holds no Control at all.
+static constexpr size_t INLINE_CONTROLS = EALLOC_INLINE_CONTROLS;
+static constexpr size_t EMBED_CONTROL_FACTOR = 4; ///< Pools this many controls large skip inline slots.
+#ifndef EALLOC_MAX_SLI
+    #define EALLOC_MAX_SLI 5
+#endif
+#ifndef EALLOC_ALIGN_EXP
+    #define EALLOC_ALIGN_EXP 2
+#endif
+static constexpr size_t MAX_SLI=EALLOC_MAX_SLI; ///< log2 of the second-level lists per class.
+static constexpr size_t DEFAULT_ALIGN_EXP=EALLOC_ALIGN_EXP; ///< log2 of the block alignment.
+static_assert(MAX_SLI >= 2 && MAX_SLI <= 5, "EALLOC_MAX_SLI must be 2..5");
+static_assert(DEFAULT_ALIGN_EXP >= 2 && (size_t(1) << DEFAULT_ALIGN_EXP) <= sizeof(void*),
+              "EALLOC_ALIGN_EXP must be 2..log2(sizeof(void*)): block headers are pointer-sized");
+static constexpr size_t MAX_HANDLES = 32; ///< Capacity of the relocatable handle table.
+static constexpr size_t STREAM_COPY_THRESHOLD = 256 * 1024; ///< realloc moves at least this large bypass the cache.
+static constexpr size_t PROFILE_SAMPLE_INTERVAL = 512 * 1024; ///< Default mean bytes between heap profiler samples.
+static constexpr size_t PROFILE_MAX_SITES = 128; ///< Call sites tracked by the heap profiler.
+static constexpr size_t PROFILE_MAX_SAMPLES = 1024; ///< Sampled blocks the heap profiler can keep live at once.
+static constexpr size_t PROFILE_MAX_DEPTH = 16; ///< Frames kept per profiled call site.
+static constexpr size_t MAX_OWNER_TAGS = 16; ///< Owner tags with their own live-usage counters.
+static constexpr size_t EVENT_LOG_CAPACITY = 32; ///< Deferred diagnostic events buffered (power of two).
+static constexpr size_t STATS_EXPORT_MAX_POOLS = 16; ///< Pools published by StatsExporter; further pools are counted only.
 
 
 static constexpr double  DEFRAGMENTATION_THRESH = 0.75f;
+
+/**
+ * @brief Order in which freed blocks are filed into a TLSF shelf.
+ *
+ * - LIFO: push at the head; the most recently freed (cache-hot) block is reused first.
+ * - FIFO: append at the tail; blocks age before reuse, spreading wear across the pool.
+ * - ADDRESS_ORDERED: keep each shelf sorted by address; packs live data toward low addresses.
+ *   Every free walks the shelf to find its slot, so insertion is O(n) in the shelf length
+ *   rather than O(1), and a shelf holding many blocks makes free() slow.
+ */
+enum class FreeListOrder { LIFO, FIFO, ADDRESS_ORDERED };
+
+#ifndef EALLOC_FREE_LIST_ORDER
+    #define EALLOC_FREE_LIST_ORDER LIFO
+#endif
+static constexpr FreeListOrder DEFAULT_FREE_LIST_ORDER = FreeListOrder::EALLOC_FREE_LIST_ORDER;
 }
\ No newline at end of file
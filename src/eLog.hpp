@@ -0,0 +1,259 @@
+/**
+ * @file eLog.hpp
+ * @brief Compile-time log-level elision and a deferred binary event log for hot-path diagnostics.
+ *
+ * EALLOC_LOG_LEVEL picks the most verbose messages kept: EALLOC_LOG_ERROR/WARNING/INFO/DEBUG
+ * above it compile to nothing, format strings and arguments included. With
+ * -DEALLOC_LOG_LEVEL=EALLOC_LOG_LEVEL_NONE the allocator carries no diagnostics at all.
+ *
+ * Diagnostics on the allocation and locking paths never format text there. log_event<Id>()
+ * stores the event id and up to three integer arguments in a fixed, allocation-free ring that
+ * any thread can write without locking; EventLog::drain() or dump() turns them into text later,
+ * on the consumer's time. A full ring drops new events and counts them instead of blocking.
+ */
+#pragma once
+
+#include "Logger.hpp"
+#include "eConfig.hpp"
+#include <atomic>
+#include <stdio.h>
+#include <type_traits>
+
+#define EALLOC_LOG_LEVEL_NONE 0
+#define EALLOC_LOG_LEVEL_ERROR 1
+#define EALLOC_LOG_LEVEL_WARNING 2
+#define EALLOC_LOG_LEVEL_INFO 3
+#define EALLOC_LOG_LEVEL_DEBUG 4
+
+#ifndef EALLOC_LOG_LEVEL
+    #define EALLOC_LOG_LEVEL EALLOC_LOG_LEVEL_INFO
+#endif
+
+// `if constexpr` keeps the arguments type-checked (no unused-variable fallout) while emitting
+// no code or strings for disabled levels, even in unoptimised builds.
+#define EALLOC_LOG_AT(level, fn, ...)                              \
+    do                                                             \
+    {                                                              \
+        if constexpr(EALLOC_LOG_LEVEL >= (level)) fn(__VA_ARGS__); \
+    } while(0)
+
+#define EALLOC_LOG_ERROR(...) EALLOC_LOG_AT(EALLOC_LOG_LEVEL_ERROR, LOG::ERROR, __VA_ARGS__)
+#define EALLOC_LOG_WARNING(...) EALLOC_LOG_AT(EALLOC_LOG_LEVEL_WARNING, LOG::WARNING, __VA_ARGS__)
+#define EALLOC_LOG_INFO(...) EALLOC_LOG_AT(EALLOC_LOG_LEVEL_INFO, LOG::INFO, __VA_ARGS__)
+#define EALLOC_LOG_SUCCESS(...) EALLOC_LOG_AT(EALLOC_LOG_LEVEL_INFO, LOG::SUCCESS, __VA_ARGS__)
+#define EALLOC_LOG_DEBUG(...) EALLOC_LOG_AT(EALLOC_LOG_LEVEL_DEBUG, LOG::DEBUG, __VA_ARGS__)
+
+namespace dsa
+{
+
+/// Hot-path diagnostics. Argument 0 is printed as a pointer, arguments 1 and 2 as unsigned.
+enum class EventId : uint8_t
+{
+    ALLOC_TAGGED,       ///< Block, owner tag.
+    OWNER_TAG_MISMATCH, ///< Block, its tag, the freeing allocator's tag.
+    DOUBLE_FREE,        ///< Block.
+    LOCK_TAKEN,         ///< Mutex, timeout in ms.
+    COUNT
+};
+
+/// Log level an event is reported at; events above EALLOC_LOG_LEVEL are never recorded.
+constexpr int event_level(EventId id)
+{
+    switch(id)
+    {
+        case EventId::ALLOC_TAGGED: return EALLOC_LOG_LEVEL_INFO;
+        case EventId::OWNER_TAG_MISMATCH: return EALLOC_LOG_LEVEL_WARNING;
+        case EventId::DOUBLE_FREE: return EALLOC_LOG_LEVEL_ERROR;
+        case EventId::LOCK_TAKEN: return EALLOC_LOG_LEVEL_DEBUG;
+        default: return EALLOC_LOG_LEVEL_NONE;
+    }
+}
+
+/// printf format of an event's message.
+constexpr const char* event_format(EventId id)
+{
+    switch(id)
+    {
+        case EventId::ALLOC_TAGGED: return "Allocated block %p with owner tag %u.";
+        case EventId::OWNER_TAG_MISMATCH:
+            return "Freeing block %p with mismatched owner tag %u (expected %u).";
+        case EventId::DOUBLE_FREE: return "Double free detected for block %p! Ignoring.";
+        case EventId::LOCK_TAKEN: return "Locking mutex %p (timeout %u ms).";
+        default: return "Unknown event %p %u %u.";
+    }
+}
+
+/// One buffered event.
+struct EventRecord
+{
+    uintptr_t args[3];
+    EventId id;
+};
+
+/**
+ * @brief Bounded lock-free ring of EventRecords (EVENT_LOG_CAPACITY entries).
+ *
+ * record() may be called concurrently from any number of threads, including from inside the
+ * allocator lock; drain() and dump() must only be called from one thread at a time.
+ */
+class EventLog
+{
+   public:
+    using Visitor = void (*)(const EventRecord& event, void* user);
+
+    static_assert((EVENT_LOG_CAPACITY & (EVENT_LOG_CAPACITY - 1)) == 0,
+                  "EVENT_LOG_CAPACITY must be a power of two");
+
+    EventLog()
+    {
+        for(size_t i = 0; i < EVENT_LOG_CAPACITY; ++i)
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    /// Events lost because the ring was full.
+    size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Buffers one event; never blocks or allocates.
+     * @return false if the ring was full and the event was dropped.
+     */
+    bool record(EventId id, uintptr_t a0, uintptr_t a1, uintptr_t a2)
+    {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for(;;)
+        {
+            slot = &slots_[pos & (EVENT_LOG_CAPACITY - 1)];
+            const size_t seq = slot->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if(diff == 0)
+            {
+                if(tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if(diff < 0)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->event.args[0] = a0;
+        slot->event.args[1] = a1;
+        slot->event.args[2] = a2;
+        slot->event.id = id;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Hands every buffered event, oldest first, to @p visit and frees its slot.
+     * @return Number of events drained.
+     */
+    size_t drain(Visitor visit, void* user)
+    {
+        size_t count = 0;
+        for(;;)
+        {
+            Slot& slot = slots_[head_ & (EVENT_LOG_CAPACITY - 1)];
+            if(slot.sequence.load(std::memory_order_acquire) != head_ + 1) break;
+            const EventRecord event = slot.event;
+            slot.sequence.store(head_ + EVENT_LOG_CAPACITY, std::memory_order_release);
+            head_++;
+            count++;
+            if(visit) visit(event, user);
+        }
+        return count;
+    }
+
+    /// Writes the message of @p event into @p out (always terminated); returns its length.
+    static size_t format(const EventRecord& event, char* out, size_t capacity)
+    {
+        const int n = snprintf(out, capacity, event_format(event.id),
+                               reinterpret_cast<void*>(event.args[0]),
+                               static_cast<unsigned>(event.args[1]),
+                               static_cast<unsigned>(event.args[2]));
+        if(n < 0) return 0;
+        return static_cast<size_t>(n) < capacity ? static_cast<size_t>(n) : capacity ? capacity - 1 : 0;
+    }
+
+    /// Drains the ring into the Logger at each event's level; returns the events written.
+    size_t dump()
+    {
+        const size_t lost = dropped_.exchange(0, std::memory_order_relaxed);
+        if(lost) EALLOC_LOG_WARNING("E_ALLOC", "%zu diagnostic events were dropped.", lost);
+        (void)lost;
+        return drain(log_one, nullptr);
+    }
+
+   private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence{0};
+        EventRecord event{};
+    };
+
+    static void log_one(const EventRecord& event, void*)
+    {
+        char line[96];
+        format(event, line, sizeof(line));
+        (void)line;
+        switch(event_level(event.id))
+        {
+            case EALLOC_LOG_LEVEL_ERROR: EALLOC_LOG_ERROR("E_ALLOC", "%s", line); break;
+            case EALLOC_LOG_LEVEL_WARNING: EALLOC_LOG_WARNING("E_ALLOC", "%s", line); break;
+            case EALLOC_LOG_LEVEL_INFO: EALLOC_LOG_INFO("E_ALLOC", "%s", line); break;
+            default: EALLOC_LOG_DEBUG("E_ALLOC", "%s", line); break;
+        }
+    }
+
+    Slot slots_[EVENT_LOG_CAPACITY];
+    std::atomic<size_t> tail_{0};
+    std::atomic<size_t> dropped_{0};
+    size_t head_ = 0;
+};
+
+/// The process-wide event log every allocator and lock adapter records into.
+inline EventLog& event_log()
+{
+    static EventLog log;
+    return log;
+}
+
+namespace detail
+{
+template <typename T>
+inline uintptr_t event_arg(T value)
+{
+    if constexpr(std::is_pointer<T>::value)
+        return reinterpret_cast<uintptr_t>(value);
+    else
+        return static_cast<uintptr_t>(value);
+}
+} // namespace detail
+
+/**
+ * @brief Records event @p Id into event_log() if its level is enabled; compiles to nothing
+ *        otherwise.
+ */
+template <EventId Id, typename... Args>
+inline void log_event(Args... args)
+{
+    static_assert(sizeof...(Args) <= 3, "events carry at most three arguments");
+    if constexpr(event_level(Id) <= EALLOC_LOG_LEVEL)
+    {
+        const uintptr_t values[3] = {detail::event_arg(args)...};
+        event_log().record(Id, values[0], values[1], values[2]);
+    }
+    else
+    {
+        ((void)args, ...);
+    }
+}
+
+} // namespace dsa
@@ -0,0 +1,88 @@
+/**
+ * @file eObserver.hpp
+ * @brief Observer policies: compile-time hooks on every allocator event.
+ *
+ * eAlloc calls the static hooks of the type named by EALLOC_OBSERVER (NullObserver by default):
+ *   on_malloc    a block was handed out by malloc, calloc or memalign (size as requested)
+ *   on_free      a block owned by the allocator is about to be released
+ *   on_realloc   realloc succeeded; old_ptr may equal new_ptr or be nullptr, new_ptr is
+ *                nullptr for size 0
+ *   on_pool_add  a pool was added, including the one passed to the constructor
+ *   on_failure   an allocation of @p size bytes failed, before the failure handler runs
+ * All hooks except on_failure run under the allocator's global lock (under per-pool locking,
+ * the allocation hooks run unlocked and free's under the pool lock), so they must not call back
+ * into the same allocator and must tolerate concurrent calls when per-pool locking is on. Hooks
+ * are static so a policy carries no per-allocator state; the allocator reference tells
+ * instances apart.
+ *
+ * To use a policy, define it in a header and build with
+ *   -DEALLOC_OBSERVER_HEADER='"my_observer.hpp"' -DEALLOC_OBSERVER=my::Observer
+ * NullObserver's hooks are empty inline functions, so the default build carries no trace of
+ * them.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+
+namespace dsa
+{
+
+class eAlloc;
+
+/// Default policy: every hook is empty and compiles away.
+struct NullObserver
+{
+    static void on_malloc(const eAlloc&, void*, size_t) {}
+    static void on_free(const eAlloc&, void*) {}
+    static void on_realloc(const eAlloc&, void*, void*, size_t) {}
+    static void on_pool_add(const eAlloc&, void*, size_t) {}
+    static void on_failure(const eAlloc&, size_t) {}
+};
+
+/**
+ * @brief Example policy counting events across all allocators with relaxed atomics.
+ *
+ * Select it with -DEALLOC_OBSERVER=dsa::CountingObserver; reset() zeroes the counters.
+ */
+struct CountingObserver
+{
+    static inline std::atomic<size_t> mallocs{0};
+    static inline std::atomic<size_t> frees{0};
+    static inline std::atomic<size_t> reallocs{0};
+    static inline std::atomic<size_t> pools_added{0};
+    static inline std::atomic<size_t> failures{0};
+    static inline std::atomic<size_t> requested_bytes{0};
+
+    static void on_malloc(const eAlloc&, void*, size_t size)
+    {
+        mallocs.fetch_add(1, std::memory_order_relaxed);
+        requested_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    static void on_free(const eAlloc&, void*) { frees.fetch_add(1, std::memory_order_relaxed); }
+    static void on_realloc(const eAlloc&, void*, void*, size_t size)
+    {
+        reallocs.fetch_add(1, std::memory_order_relaxed);
+        requested_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    static void on_pool_add(const eAlloc&, void*, size_t)
+    {
+        pools_added.fetch_add(1, std::memory_order_relaxed);
+    }
+    static void on_failure(const eAlloc&, size_t)
+    {
+        failures.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void reset()
+    {
+        mallocs.store(0, std::memory_order_relaxed);
+        frees.store(0, std::memory_order_relaxed);
+        reallocs.store(0, std::memory_order_relaxed);
+        pools_added.store(0, std::memory_order_relaxed);
+        failures.store(0, std::memory_order_relaxed);
+        requested_bytes.store(0, std::memory_order_relaxed);
+    }
+};
+
+} // namespace dsa
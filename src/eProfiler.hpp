@@ -0,0 +1,409 @@
+/**
+ * @file eProfiler.hpp
+ * @brief Sampling heap profiler for eAlloc: which call sites own the heap, at production cost.
+ *
+ * A HeapProfiler is attached with eAlloc::setHeapProfiler() (requires EALLOC_ENABLE_PROFILER).
+ * Allocations are sampled as a Poisson process over allocated bytes: on average one sample per
+ * `sample_interval` bytes, so large blocks are almost always caught and small ones rarely.
+ * A sampled allocation captures a backtrace, is charged to its call site and remembered in a
+ * side table keyed by address (block headers stay untouched); freeing it uncharges the site.
+ * Unsampled allocations cost one counter update; frees cost one load while no sample is live.
+ *
+ * Profiles are produced on demand:
+ *   - write_text(): call sites sorted by estimated live bytes, unbiased by the sampling rate,
+ *   - write_pprof(): the legacy gperftools heap format ("heap_v2"), which `pprof` reads and
+ *     rescales itself, e.g. `pprof --text ./app heap.prof`.
+ *
+ * Tables are fixed-size (see eConfig.hpp); samples that find them full are counted in dropped().
+ * Backtraces come from execinfo's backtrace() on hosts that have it; elsewhere pass an
+ * Unwinder (without one every sample lands in a single, frameless call site).
+ */
+#pragma once
+
+#include "eConfig.hpp"
+#include <atomic>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(EALLOC_PC_HOST) && defined(__has_include)
+    #if __has_include(<execinfo.h>)
+        #include <execinfo.h>
+        #define EALLOC_PROFILER_BACKTRACE 1
+    #endif
+#endif
+#ifndef EALLOC_PROFILER_BACKTRACE
+    #define EALLOC_PROFILER_BACKTRACE 0
+#endif
+
+namespace dsa
+{
+
+/**
+ * @brief Poisson-sampling heap profiler with per-call-site live and cumulative totals.
+ *
+ * on_alloc()/on_free() are safe to call from several threads; the tables are guarded by an
+ * internal spinlock that is only taken for sampled blocks (and for frees while samples are live).
+ */
+class HeapProfiler
+{
+   public:
+    /// Fills @p frames with up to @p max return addresses, innermost first; returns the count.
+    using Unwinder = size_t (*)(void** frames, size_t max);
+    /// Receives profile text from write_text()/write_pprof().
+    using Writer = void (*)(const char* text, size_t bytes, void* user);
+
+    /// @brief Totals charged to one call site.
+    struct Site
+    {
+        void* frames[PROFILE_MAX_DEPTH];
+        size_t depth;
+        uint64_t live_samples;   ///< Sampled blocks still allocated.
+        uint64_t live_bytes;     ///< Requested bytes of those blocks.
+        uint64_t alloc_samples;  ///< Sampled blocks since the profiler was attached.
+        uint64_t alloc_bytes;    ///< Requested bytes of those blocks.
+        double live_estimate;    ///< Estimated live bytes of all (sampled or not) blocks.
+        double alloc_estimate;   ///< Estimated bytes allocated from this site in total.
+    };
+
+    /**
+     * @param sample_interval Mean bytes between samples; 1 samples every allocation.
+     * @param unwinder Backtrace source; defaults to execinfo on hosts that provide it.
+     * @param seed Seed of the sampling sequence, for reproducible runs.
+     */
+    explicit HeapProfiler(size_t sample_interval = PROFILE_SAMPLE_INTERVAL,
+                          Unwinder unwinder = default_unwinder, uint64_t seed = 0x2545F4914F6CDD1Dull) :
+        interval_(sample_interval ? sample_interval : 1), unwinder_(unwinder), rng_(seed ? seed : 1)
+    {
+        countdown_.store(static_cast<int64_t>(next_interval()), std::memory_order_relaxed);
+    }
+
+    HeapProfiler(const HeapProfiler&) = delete;
+    HeapProfiler& operator=(const HeapProfiler&) = delete;
+
+    /// Accounts an allocation of @p size requested bytes that returned @p ptr.
+    void on_alloc(const void* ptr, size_t size)
+    {
+        if(!ptr || !size) return;
+        const int64_t before = countdown_.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+        if(before > static_cast<int64_t>(size)) return;
+        sample(ptr, size);
+    }
+
+    /// Uncharges @p ptr if it was sampled.
+    void on_free(const void* ptr)
+    {
+        if(!ptr || live_.load(std::memory_order_relaxed) == 0) return;
+        Guard guard(lock_);
+        const size_t slot = find(ptr);
+        if(slot == NOT_FOUND) return;
+        Sample& s = samples_[slot];
+        Site& site = sites_[s.site];
+        site.live_samples--;
+        site.live_bytes -= s.size;
+        site.live_estimate -= s.size * s.weight;
+        erase(slot);
+        live_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// Mean sampling interval in bytes.
+    size_t sample_interval() const { return interval_; }
+
+    /// Samples lost to a full site table, or not followed to their free for a full sample table.
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /// Number of call sites seen so far.
+    size_t site_count() const { return site_count_; }
+
+    /// Call site @p index (< site_count()); read it while the allocator is quiescent.
+    const Site& site(size_t index) const { return sites_[index]; }
+
+    /// Writes a human-readable profile, heaviest live call sites first.
+    void write_text(Writer writer, void* user) const
+    {
+        Guard guard(lock_);
+        size_t order[PROFILE_MAX_SITES];
+        const size_t count = sorted_sites(order);
+        double live = 0, allocated = 0;
+        for(size_t i = 0; i < count; ++i)
+        {
+            live += sites_[order[i]].live_estimate;
+            allocated += sites_[order[i]].alloc_estimate;
+        }
+        char line[256];
+        emit(writer, user, line,
+             snprintf(line, sizeof(line),
+                      "heap profile: one sample per %zu bytes on average, %llu dropped\n"
+                      "estimated live %.0f bytes, allocated %.0f bytes since attach\n"
+                      "%14s %12s %16s %12s  call site (innermost first)\n",
+                      interval_, static_cast<unsigned long long>(dropped()), live, allocated,
+                      "live_bytes", "live_blocks", "allocated_bytes", "samples"));
+        for(size_t i = 0; i < count; ++i)
+        {
+            const Site& site = sites_[order[i]];
+            const double avg = site.alloc_samples ? double(site.alloc_bytes) / site.alloc_samples : 0;
+            const double blocks = avg > 0 ? site.live_estimate / avg : 0;
+            emit(writer, user, line,
+                 snprintf(line, sizeof(line), "%14.0f %12.0f %16.0f %12llu ", site.live_estimate,
+                          blocks, site.alloc_estimate,
+                          static_cast<unsigned long long>(site.alloc_samples)));
+            write_frames(writer, user, site);
+        }
+    }
+
+    /**
+     * @brief Writes the profile in the legacy gperftools heap format understood by pprof.
+     *
+     * Counts are raw samples; the "heap_v2/<interval>" header tells pprof how to scale them.
+     * On Linux the process mappings are appended so pprof can symbolize without help.
+     */
+    void write_pprof(Writer writer, void* user) const
+    {
+        Guard guard(lock_);
+        uint64_t totals[4] = {0, 0, 0, 0};
+        for(size_t i = 0; i < site_count_; ++i)
+        {
+            totals[0] += sites_[i].live_samples;
+            totals[1] += sites_[i].live_bytes;
+            totals[2] += sites_[i].alloc_samples;
+            totals[3] += sites_[i].alloc_bytes;
+        }
+        char line[256];
+        emit(writer, user, line,
+             snprintf(line, sizeof(line), "heap profile: %llu: %llu [%llu: %llu] @ heap_v2/%zu\n",
+                      static_cast<unsigned long long>(totals[0]),
+                      static_cast<unsigned long long>(totals[1]),
+                      static_cast<unsigned long long>(totals[2]),
+                      static_cast<unsigned long long>(totals[3]), interval_));
+        for(size_t i = 0; i < site_count_; ++i)
+        {
+            const Site& site = sites_[i];
+            emit(writer, user, line,
+                 snprintf(line, sizeof(line), "%llu: %llu [%llu: %llu] @",
+                          static_cast<unsigned long long>(site.live_samples),
+                          static_cast<unsigned long long>(site.live_bytes),
+                          static_cast<unsigned long long>(site.alloc_samples),
+                          static_cast<unsigned long long>(site.alloc_bytes)));
+            for(size_t f = 0; f < site.depth; ++f)
+                emit(writer, user, line, snprintf(line, sizeof(line), " %p", site.frames[f]));
+            writer("\n", 1, user);
+        }
+#if defined(__linux__) && defined(EALLOC_PC_HOST)
+        if(FILE* maps = fopen("/proc/self/maps", "r"))
+        {
+            writer("\nMAPPED_LIBRARIES:\n", 19, user);
+            char chunk[512];
+            size_t n;
+            while((n = fread(chunk, 1, sizeof(chunk), maps)) > 0) writer(chunk, n, user);
+            fclose(maps);
+        }
+#endif
+    }
+
+    /// Backtrace of the caller via execinfo, or nothing where that is unavailable.
+    __attribute__((noinline)) static size_t default_unwinder(void** frames, size_t max)
+    {
+#if EALLOC_PROFILER_BACKTRACE
+        const int n = backtrace(frames, static_cast<int>(max));
+        return n > 0 ? static_cast<size_t>(n) : 0;
+#else
+        (void)frames;
+        (void)max;
+        return 0;
+#endif
+    }
+
+   private:
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+    static constexpr size_t SAMPLE_SLOTS = PROFILE_MAX_SAMPLES * 2; // load factor <= 1/2
+
+    struct Sample
+    {
+        const void* ptr;
+        size_t size;
+        double weight;
+        uint32_t site;
+    };
+
+    /// Minimal spinlock; held only around table updates.
+    class Guard
+    {
+       public:
+        explicit Guard(std::atomic_flag& flag) : flag_(flag)
+        {
+            while(flag_.test_and_set(std::memory_order_acquire))
+            {
+            }
+        }
+        ~Guard() { flag_.clear(std::memory_order_release); }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+       private:
+        std::atomic_flag& flag_;
+    };
+
+    /// Draws the distance to the next sample from an exponential distribution.
+    size_t next_interval()
+    {
+        rng_ ^= rng_ >> 12;
+        rng_ ^= rng_ << 25;
+        rng_ ^= rng_ >> 27;
+        const uint64_t bits = (rng_ * 0x2545F4914F6CDD1Dull) >> 11;
+        const double u = (static_cast<double>(bits) + 1.0) / 9007199254740993.0; // (0, 1]
+        const double next = -log(u) * static_cast<double>(interval_);
+        return next < 1.0 ? 1 : static_cast<size_t>(next);
+    }
+
+    __attribute__((noinline)) void sample(const void* ptr, size_t size)
+    {
+        // The default unwinder reports itself and this function first; drop both. The
+        // allocator's own frames stay (pprof --focus/--ignore can hide them).
+        constexpr size_t OWN_FRAMES = 2;
+        void* frames[PROFILE_MAX_DEPTH + OWN_FRAMES];
+        size_t depth = unwinder_ ? unwinder_(frames, PROFILE_MAX_DEPTH + OWN_FRAMES) : 0;
+        void** stack = frames;
+        if(unwinder_ == default_unwinder)
+        {
+            const size_t skip = depth < OWN_FRAMES ? depth : OWN_FRAMES;
+            stack += skip;
+            depth -= skip;
+        }
+        if(depth > PROFILE_MAX_DEPTH) depth = PROFILE_MAX_DEPTH;
+
+        Guard guard(lock_);
+        countdown_.store(static_cast<int64_t>(next_interval()), std::memory_order_relaxed);
+        const size_t site_index = find_site(stack, depth);
+        if(site_index == NOT_FOUND)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // A block of size s is sampled with probability 1 - exp(-s / interval)
+        const double p = 1.0 - exp(-static_cast<double>(size) / static_cast<double>(interval_));
+        const double weight = p > 0 ? 1.0 / p : 1.0;
+        Site& site = sites_[site_index];
+        site.alloc_samples++;
+        site.alloc_bytes += size;
+        site.alloc_estimate += size * weight;
+        if(live_.load(std::memory_order_relaxed) >= PROFILE_MAX_SAMPLES)
+        {
+            // Still counted as allocated, but its lifetime cannot be followed
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        site.live_samples++;
+        site.live_bytes += size;
+        site.live_estimate += size * weight;
+
+        size_t slot = hash(ptr) & (SAMPLE_SLOTS - 1);
+        while(samples_[slot].ptr) slot = (slot + 1) & (SAMPLE_SLOTS - 1);
+        samples_[slot] = Sample{ptr, size, weight, static_cast<uint32_t>(site_index)};
+        live_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static size_t hash(const void* ptr)
+    {
+        const uint64_t key = reinterpret_cast<uintptr_t>(ptr) >> 3;
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 17);
+    }
+
+    size_t find(const void* ptr) const
+    {
+        for(size_t slot = hash(ptr) & (SAMPLE_SLOTS - 1);; slot = (slot + 1) & (SAMPLE_SLOTS - 1))
+        {
+            if(samples_[slot].ptr == ptr) return slot;
+            if(!samples_[slot].ptr) return NOT_FOUND;
+        }
+    }
+
+    /// Backward-shift deletion keeps linear probing free of tombstones.
+    void erase(size_t slot)
+    {
+        size_t next = (slot + 1) & (SAMPLE_SLOTS - 1);
+        while(samples_[next].ptr)
+        {
+            const size_t home = hash(samples_[next].ptr) & (SAMPLE_SLOTS - 1);
+            // Move the entry back if its home does not lie cyclically in (slot, next]
+            if(((next - home) & (SAMPLE_SLOTS - 1)) >= ((next - slot) & (SAMPLE_SLOTS - 1)))
+            {
+                samples_[slot] = samples_[next];
+                slot = next;
+            }
+            next = (next + 1) & (SAMPLE_SLOTS - 1);
+        }
+        samples_[slot].ptr = nullptr;
+    }
+
+    size_t find_site(void* const* frames, size_t depth)
+    {
+        for(size_t i = 0; i < site_count_; ++i)
+        {
+            if(sites_[i].depth == depth && memcmp(sites_[i].frames, frames, depth * sizeof(void*)) == 0)
+                return i;
+        }
+        if(site_count_ == PROFILE_MAX_SITES) return NOT_FOUND;
+        Site& site = sites_[site_count_];
+        site = Site();
+        memcpy(site.frames, frames, depth * sizeof(void*));
+        site.depth = depth;
+        return site_count_++;
+    }
+
+    size_t sorted_sites(size_t* order) const
+    {
+        for(size_t i = 0; i < site_count_; ++i)
+        {
+            size_t j = i;
+            for(; j > 0 && sites_[order[j - 1]].live_estimate < sites_[i].live_estimate; --j)
+                order[j] = order[j - 1];
+            order[j] = i;
+        }
+        return site_count_;
+    }
+
+    static void emit(Writer writer, void* user, const char* line, int length)
+    {
+        if(length > 0) writer(line, static_cast<size_t>(length), user);
+    }
+
+    static void write_frames(Writer writer, void* user, const Site& site)
+    {
+        char line[64];
+        if(!site.depth)
+        {
+            writer("<no backtrace>\n", 15, user);
+            return;
+        }
+#if EALLOC_PROFILER_BACKTRACE
+        // Symbolized where the binary exports symbols; raw addresses otherwise
+        if(char** names = backtrace_symbols(site.frames, static_cast<int>(site.depth)))
+        {
+            for(size_t f = 0; f < site.depth; ++f)
+            {
+                if(f) writer(" <- ", 4, user);
+                writer(names[f], strlen(names[f]), user);
+            }
+            writer("\n", 1, user);
+            free(names);
+            return;
+        }
+#endif
+        for(size_t f = 0; f < site.depth; ++f)
+            emit(writer, user, line, snprintf(line, sizeof(line), f ? " <- %p" : "%p", site.frames[f]));
+        writer("\n", 1, user);
+    }
+
+    const size_t interval_;
+    const Unwinder unwinder_;
+    uint64_t rng_;
+    std::atomic<int64_t> countdown_{0};
+    std::atomic<size_t> live_{0};
+    std::atomic<uint64_t> dropped_{0};
+    mutable std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+    Site sites_[PROFILE_MAX_SITES] = {};
+    size_t site_count_ = 0;
+    Sample samples_[SAMPLE_SLOTS] = {};
+};
+
+} // namespace dsa
@@ -0,0 +1,235 @@
+/**
+ * @file eSnapshot.hpp
+ * @brief Binary heap snapshots: the block map of every pool in a few bytes per block.
+ *
+ * eAlloc::snapshot() encodes each pool with a SnapshotWriter and hands the bytes to a sink; the
+ * ealloc_snapshot tool (or any code using SnapshotReader) decodes them offline to draw
+ * fragmentation maps and compare two snapshots.
+ *
+ * Format (all integers LEB128 varints unless noted):
+ *   header: "EASN" (4 bytes), version (1 byte), granule, block overhead, first payload offset,
+ *           flags (bit 0: used blocks carry an owner tag)
+ *   pool:   pool index + 1, heap address, heap size, then its blocks in address order
+ *   block:  (size / granule) << 1 | used, then the owner tag if flagged and used
+ *   0 ends the blocks of a pool; the log ends after the last pool.
+ * Offsets are implicit: a block's payload starts at the previous payload plus its size and the
+ * per-block overhead, and the first payload sits at the header's first offset.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace dsa
+{
+
+/// One pool of a snapshot.
+struct SnapshotPool
+{
+    uint64_t index;   ///< Pool index in the allocator at snapshot time.
+    uint64_t address; ///< Start of the pool's heap area.
+    uint64_t size;    ///< Bytes managed by the pool, block headers included.
+};
+
+/// One block of a snapshot.
+struct SnapshotBlock
+{
+    uint64_t offset;    ///< Payload offset from the pool's heap address.
+    uint64_t size;      ///< Usable bytes.
+    uint32_t owner_tag; ///< Owner of a used block, 0 if tags were not recorded.
+    bool used;
+};
+
+/**
+ * @brief Encodes a snapshot into fixed-size chunks handed to a sink.
+ *
+ * Calls must follow the format: begin(), then for each pool pool() followed by block() calls and
+ * end_pool(), then finish().
+ */
+class SnapshotWriter
+{
+   public:
+    /// Receives encoded snapshot bytes.
+    using Sink = void (*)(const void* data, size_t bytes, void* user);
+
+    static constexpr uint8_t VERSION = 1;
+    static constexpr uint64_t FLAG_OWNER_TAGS = 1;
+
+    SnapshotWriter(Sink sink, void* user) : sink_(sink), user_(user) {}
+
+    void begin(size_t granule, size_t overhead, size_t first_offset, uint64_t flags)
+    {
+        reserve(5 + 4 * 10);
+        memcpy(chunk_ + used_, "EASN", 4);
+        chunk_[used_ + 4] = VERSION;
+        used_ += 5;
+        granule_ = granule;
+        flags_ = flags;
+        put(granule);
+        put(overhead);
+        put(first_offset);
+        put(flags);
+    }
+
+    void pool(size_t index, const void* heap, size_t size)
+    {
+        reserve(3 * 10);
+        put(index + 1);
+        put(reinterpret_cast<uintptr_t>(heap));
+        put(size);
+    }
+
+    void block(size_t size, bool used, uint32_t owner_tag)
+    {
+        reserve(2 * 10);
+        put((static_cast<uint64_t>(size / granule_) << 1) | (used ? 1 : 0));
+        if(used && (flags_ & FLAG_OWNER_TAGS)) put(owner_tag);
+    }
+
+    void end_pool()
+    {
+        reserve(1);
+        put(0);
+    }
+
+    /// Flushes the last chunk; returns the total number of bytes produced.
+    size_t finish()
+    {
+        flush();
+        return written_;
+    }
+
+   private:
+    void reserve(size_t bytes)
+    {
+        if(used_ + bytes > sizeof(chunk_)) flush();
+    }
+
+    void flush()
+    {
+        if(used_ && sink_) sink_(chunk_, used_, user_);
+        written_ += used_;
+        used_ = 0;
+    }
+
+    void put(uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            chunk_[used_++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        chunk_[used_++] = static_cast<uint8_t>(value);
+    }
+
+    Sink sink_;
+    void* user_;
+    uint8_t chunk_[256];
+    size_t used_ = 0;
+    size_t written_ = 0;
+    size_t granule_ = 1;
+    uint64_t flags_ = 0;
+};
+
+/**
+ * @brief Decodes a snapshot produced by eAlloc::snapshot().
+ *
+ * Usage:
+ *   dsa::SnapshotReader reader(bytes, length);
+ *   for(dsa::SnapshotPool pool; reader.next_pool(pool);)
+ *       for(dsa::SnapshotBlock block; reader.next_block(block);) { ... }
+ *   if(!reader.ok()) { ... truncated or not a snapshot ... }
+ */
+class SnapshotReader
+{
+   public:
+    SnapshotReader(const void* data, size_t bytes) :
+        data_(static_cast<const uint8_t*>(data)), end_(data_ + bytes)
+    {
+        ok_ = bytes >= 5 && memcmp(data_, "EASN", 4) == 0 && data_[4] == SnapshotWriter::VERSION;
+        if(!ok_) return;
+        data_ += 5;
+        ok_ = get(granule_) && get(overhead_) && get(first_offset_) && get(flags_) && granule_;
+    }
+
+    /// False if the header was not recognised or the data was cut short.
+    bool ok() const { return ok_; }
+
+    /// Allocation granule of the snapshotted allocator.
+    uint64_t granule() const { return granule_; }
+
+    /// True if used blocks carry owner tags.
+    bool has_owner_tags() const { return (flags_ & SnapshotWriter::FLAG_OWNER_TAGS) != 0; }
+
+    /// Moves to the next pool, skipping any unread blocks of the current one.
+    bool next_pool(SnapshotPool& pool)
+    {
+        SnapshotBlock skipped;
+        while(in_pool_ && next_block(skipped)) {}
+        if(!ok_ || data_ == end_) return false;
+        uint64_t index = 0;
+        if(!get(index) || !index || !get(pool.address) || !get(pool.size)) return fail();
+        pool.index = index - 1;
+        offset_ = first_offset_;
+        in_pool_ = true;
+        return true;
+    }
+
+    /// Decodes the next block of the current pool; returns false at the end of the pool.
+    bool next_block(SnapshotBlock& block)
+    {
+        if(!ok_ || !in_pool_) return false;
+        uint64_t value = 0;
+        if(!get(value)) return fail();
+        if(!value)
+        {
+            in_pool_ = false;
+            return false;
+        }
+        block.offset = offset_;
+        block.size = (value >> 1) * granule_;
+        block.used = (value & 1) != 0;
+        block.owner_tag = 0;
+        if(block.used && has_owner_tags())
+        {
+            uint64_t tag = 0;
+            if(!get(tag)) return fail();
+            block.owner_tag = static_cast<uint32_t>(tag);
+        }
+        offset_ += block.size + overhead_;
+        return true;
+    }
+
+   private:
+    bool fail()
+    {
+        ok_ = false;
+        in_pool_ = false;
+        return false;
+    }
+
+    bool get(uint64_t& value)
+    {
+        value = 0;
+        for(unsigned shift = 0; data_ != end_ && shift < 64; shift += 7)
+        {
+            const uint8_t byte = *data_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if(!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    const uint8_t* data_;
+    const uint8_t* end_;
+    bool ok_;
+    bool in_pool_ = false;
+    uint64_t granule_ = 0;
+    uint64_t overhead_ = 0;
+    uint64_t first_offset_ = 0;
+    uint64_t flags_ = 0;
+    uint64_t offset_ = 0;
+};
+
+} // namespace dsa
@@ -0,0 +1,376 @@
+/**
+ * @file eStatsExport.hpp
+ * @brief Live allocator statistics in a shared-memory segment, for ealloc_top and other viewers.
+ *
+ * A StatsExporter owns a POSIX shared-memory segment (shm_open(), or an anonymous memfd on
+ * Linux) holding one StatsSegment. publish() copies the per-pool counters of eAlloc::pool_report()
+ * and, with EALLOC_ENABLE_CLASS_STATS, the size-class counters into it as plain integers; start()
+ * does so periodically from a background thread. Nothing is formatted in the allocating process,
+ * and the only allocator locks taken are the pool locks pool_report() holds for a few loads; an
+ * allocator used by other threads while start() runs needs a lock (eAlloc::setLock()).
+ *
+ * Readers never block the exporter: every field is a lock-free atomic and updates are bracketed
+ * by a sequence counter (a seqlock) that is odd while a publish is in progress. StatsReader maps
+ * the segment read-only and retries a copy until it sees the same even sequence before and after.
+ * Attach by name (StatsReader::attach_shm("/ealloc.1234")) or by path; a memfd segment is
+ * reachable as /proc/<pid>/fd/<fd()>.
+ *
+ * The layout depends on STATS_EXPORT_MAX_POOLS and the TLSF class count of the build, so
+ * exporter and viewer must be built with the same configuration; attaching to a segment with
+ * another layout fails. POSIX hosts only.
+ */
+#pragma once
+
+#include "eAlloc.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fcntl.h>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace dsa
+{
+
+/// Counters of one pool as published; addresses are those of the exporting process.
+struct StatsPoolSample
+{
+    uint64_t memory;
+    uint64_t bytes;
+    uint64_t size;
+    uint64_t in_use;
+    uint64_t peak_in_use;
+    uint64_t allocations;
+    uint64_t failures;
+};
+
+/// Counters of one TLSF size class as published (see eAlloc::SizeClassStats).
+struct StatsClassSample
+{
+    uint64_t min_size;
+    uint64_t allocations;
+    uint64_t live;
+    uint64_t requested_bytes;
+    uint64_t granted_bytes;
+};
+
+/// Shared-memory layout. Field-wise atomics keep concurrent reads well-defined across processes.
+struct StatsSegment
+{
+    static constexpr uint32_t MAGIC = 0x53414145; // "EAAS"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t POOLS = STATS_EXPORT_MAX_POOLS;
+    static constexpr size_t CLASSES = TLSF<>::total_shelves();
+    static constexpr size_t POOL_FIELDS = sizeof(StatsPoolSample) / sizeof(uint64_t);
+    static constexpr size_t CLASS_FIELDS = sizeof(StatsClassSample) / sizeof(uint64_t);
+    static constexpr uint32_t FLAG_CLASS_STATS = 1; ///< Size-class counters are published.
+
+    std::atomic<uint32_t> magic;   ///< Stored last when the segment is set up.
+    uint32_t version;
+    uint32_t segment_bytes;        ///< sizeof(StatsSegment) of the exporter's build.
+    uint32_t pid;                  ///< Exporting process.
+    uint32_t pool_capacity;        ///< POOLS of the exporter's build.
+    uint32_t class_count;          ///< CLASSES of the exporter's build.
+    uint32_t flags;
+    uint32_t reserved;
+    std::atomic<uint64_t> sequence;     ///< Odd while a publish is in progress.
+    std::atomic<uint64_t> timestamp_ns; ///< Steady clock at the last publish.
+    std::atomic<uint64_t> publishes;    ///< Publishes so far.
+    std::atomic<uint64_t> pool_count;   ///< Pools of the allocator (may exceed POOLS).
+    std::atomic<uint64_t> pools[POOLS][POOL_FIELDS];
+    std::atomic<uint64_t> classes[CLASSES][CLASS_FIELDS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory statistics need address-free (lock-free) atomics");
+
+/// One consistent copy of a StatsSegment.
+struct StatsSample
+{
+    uint32_t pid = 0;
+    bool class_stats = false;
+    uint64_t timestamp_ns = 0;
+    uint64_t publishes = 0;
+    uint64_t pool_count = 0;
+    StatsPoolSample pools[StatsSegment::POOLS] = {};
+    StatsClassSample classes[StatsSegment::CLASSES] = {};
+
+    /// Pools present in pools[].
+    size_t published_pools() const
+    {
+        return pool_count < StatsSegment::POOLS ? static_cast<size_t>(pool_count) : StatsSegment::POOLS;
+    }
+};
+
+/**
+ * @brief Publishes one allocator's counters into a shared-memory segment it owns.
+ *
+ * publish() must not run concurrently with itself; start() owns that duty until stop().
+ */
+class StatsExporter
+{
+   public:
+    explicit StatsExporter(const eAlloc& heap) : heap_(heap) {}
+    ~StatsExporter()
+    {
+        stop();
+        close();
+    }
+
+    StatsExporter(const StatsExporter&) = delete;
+    StatsExporter& operator=(const StatsExporter&) = delete;
+
+    /**
+     * @brief Creates (or takes over) the named POSIX shared-memory object, e.g. "/ealloc.1234".
+     *        The name is unlinked again by close().
+     */
+    bool create(const char* name)
+    {
+        close();
+        const int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+        if(fd < 0) return false;
+        strncpy(name_, name, sizeof(name_) - 1);
+        name_[sizeof(name_) - 1] = '\0';
+        return map(fd);
+    }
+
+#if defined(__linux__)
+    /// @brief Creates an anonymous memfd segment; viewers attach to /proc/<pid>/fd/<fd()>.
+    bool create_anonymous(const char* label = "ealloc-stats")
+    {
+        close();
+        const int fd = memfd_create(label, MFD_CLOEXEC);
+        return fd >= 0 && map(fd);
+    }
+#endif
+
+    /// @brief Unmaps the segment and unlinks a named one; viewers keep their mapping.
+    void close()
+    {
+        if(segment_) munmap(segment_, sizeof(StatsSegment));
+        if(fd_ >= 0) ::close(fd_);
+        if(name_[0]) shm_unlink(name_);
+        segment_ = nullptr;
+        fd_ = -1;
+        name_[0] = '\0';
+    }
+
+    /// Descriptor of the segment, or -1.
+    int fd() const { return fd_; }
+
+    /// @brief Copies the allocator's current counters into the segment.
+    void publish()
+    {
+        if(!segment_) return;
+        eAlloc::PoolStats pools[StatsSegment::POOLS];
+        const size_t pool_count = heap_.pool_report(pools, StatsSegment::POOLS);
+        const size_t shown = pool_count < StatsSegment::POOLS ? pool_count : StatsSegment::POOLS;
+
+        // Seqlock write side: odd sequence, fence, data, even sequence with release
+        const uint64_t seq = segment_->sequence.load(std::memory_order_relaxed);
+        segment_->sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for(size_t i = 0; i < shown; ++i)
+        {
+            const StatsPoolSample sample = {reinterpret_cast<uintptr_t>(pools[i].memory),
+                                            pools[i].bytes,
+                                            pools[i].size,
+                                            pools[i].in_use,
+                                            pools[i].peak_in_use,
+                                            pools[i].allocations,
+                                            pools[i].failures};
+            store(segment_->pools[i], sample);
+        }
+#if EALLOC_ENABLE_CLASS_STATS
+        for(size_t fl = 0; fl < TLSF<>::cabinets(); ++fl)
+        {
+            for(size_t sl = 0; sl < TLSF<>::shelves(); ++sl)
+            {
+                const eAlloc::SizeClassStats stats = heap_.size_class_stats(fl, sl);
+                const StatsClassSample sample = {stats.min_size, stats.allocations, stats.live,
+                                                 stats.requested_bytes, stats.granted_bytes};
+                store(segment_->classes[fl * TLSF<>::shelves() + sl], sample);
+            }
+        }
+#endif
+        segment_->pool_count.store(pool_count, std::memory_order_relaxed);
+        segment_->publishes.store(segment_->publishes.load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_relaxed);
+        segment_->timestamp_ns.store(now_ns(), std::memory_order_relaxed);
+        segment_->sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /// @brief Publishes every @p period_ms from a background thread until stop().
+    bool start(uint32_t period_ms)
+    {
+        if(!segment_ || worker_.joinable()) return false;
+        running_ = true;
+        worker_ = std::thread([this, period_ms] {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            while(running_)
+            {
+                publish();
+                wake_.wait_for(lock, std::chrono::milliseconds(period_ms), [this] { return !running_; });
+            }
+        });
+        return true;
+    }
+
+    /// @brief Stops the thread started by start(), after one last publish.
+    void stop()
+    {
+        if(!worker_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            running_ = false;
+        }
+        wake_.notify_all();
+        worker_.join();
+        publish();
+    }
+
+    /// Steady clock in nanoseconds; CLOCK_MONOTONIC on Linux, so comparable across processes.
+    static uint64_t now_ns()
+    {
+        using namespace std::chrono;
+        return static_cast<uint64_t>(
+            duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+
+   private:
+    template <size_t N, typename Sample>
+    static void store(std::atomic<uint64_t> (&fields)[N], const Sample& sample)
+    {
+        static_assert(sizeof(Sample) == N * sizeof(uint64_t), "sample does not match its slot");
+        uint64_t values[N];
+        memcpy(values, &sample, sizeof(values));
+        for(size_t i = 0; i < N; ++i) fields[i].store(values[i], std::memory_order_relaxed);
+    }
+
+    bool map(int fd)
+    {
+        void* mem = MAP_FAILED;
+        // Truncating to zero first discards whatever an earlier exporter left behind
+        if(ftruncate(fd, 0) == 0 && ftruncate(fd, sizeof(StatsSegment)) == 0)
+            mem = mmap(nullptr, sizeof(StatsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        fd_ = fd;
+        if(mem == MAP_FAILED)
+        {
+            close();
+            return false;
+        }
+        // The object is zero-filled, so every counter starts at 0
+        segment_ = static_cast<StatsSegment*>(mem);
+        segment_->version = StatsSegment::VERSION;
+        segment_->segment_bytes = sizeof(StatsSegment);
+        segment_->pid = static_cast<uint32_t>(getpid());
+        segment_->pool_capacity = StatsSegment::POOLS;
+        segment_->class_count = StatsSegment::CLASSES;
+        segment_->flags = EALLOC_ENABLE_CLASS_STATS ? StatsSegment::FLAG_CLASS_STATS : 0;
+        segment_->magic.store(StatsSegment::MAGIC, std::memory_order_release);
+        return true;
+    }
+
+    const eAlloc& heap_;
+    StatsSegment* segment_ = nullptr;
+    int fd_ = -1;
+    char name_[64] = {};
+    std::thread worker_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+};
+
+/// @brief Maps a StatsSegment read-only and takes consistent copies of it.
+class StatsReader
+{
+   public:
+    StatsReader() = default;
+    ~StatsReader() { detach(); }
+
+    StatsReader(const StatsReader&) = delete;
+    StatsReader& operator=(const StatsReader&) = delete;
+
+    /// @brief Attaches to a segment created by StatsExporter::create(@p name).
+    bool attach_shm(const char* name) { return attach_fd(shm_open(name, O_RDONLY, 0)); }
+
+    /// @brief Attaches through a file path, e.g. /proc/<pid>/fd/<n> for a memfd segment.
+    bool attach_path(const char* path) { return attach_fd(open(path, O_RDONLY)); }
+
+    void detach()
+    {
+        if(segment_) munmap(const_cast<StatsSegment*>(segment_), sizeof(StatsSegment));
+        segment_ = nullptr;
+    }
+
+    bool attached() const { return segment_ != nullptr; }
+
+    /**
+     * @brief Copies the segment once no publish is in progress.
+     * @return false if not attached or the exporter kept writing for @p max_attempts tries.
+     */
+    bool read(StatsSample& out, size_t max_attempts = 1000) const
+    {
+        if(!segment_) return false;
+        for(size_t attempt = 0; attempt < max_attempts; ++attempt)
+        {
+            const uint64_t before = segment_->sequence.load(std::memory_order_acquire);
+            if(before & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            out.pid = segment_->pid;
+            out.class_stats = (segment_->flags & StatsSegment::FLAG_CLASS_STATS) != 0;
+            out.timestamp_ns = segment_->timestamp_ns.load(std::memory_order_relaxed);
+            out.publishes = segment_->publishes.load(std::memory_order_relaxed);
+            out.pool_count = segment_->pool_count.load(std::memory_order_relaxed);
+            for(size_t i = 0; i < StatsSegment::POOLS; ++i) load(segment_->pools[i], out.pools[i]);
+            for(size_t i = 0; i < StatsSegment::CLASSES; ++i) load(segment_->classes[i], out.classes[i]);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(segment_->sequence.load(std::memory_order_relaxed) == before) return true;
+        }
+        return false;
+    }
+
+   private:
+    template <size_t N, typename Sample>
+    static void load(const std::atomic<uint64_t> (&fields)[N], Sample& sample)
+    {
+        uint64_t values[N];
+        for(size_t i = 0; i < N; ++i) values[i] = fields[i].load(std::memory_order_relaxed);
+        memcpy(&sample, values, sizeof(values));
+    }
+
+    bool attach_fd(int fd)
+    {
+        detach();
+        if(fd < 0) return false;
+        struct stat st;
+        void* mem = MAP_FAILED;
+        if(fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == sizeof(StatsSegment))
+            mem = mmap(nullptr, sizeof(StatsSegment), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(mem == MAP_FAILED) return false;
+        segment_ = static_cast<const StatsSegment*>(mem);
+        if(segment_->magic.load(std::memory_order_acquire) != StatsSegment::MAGIC
+           || segment_->version != StatsSegment::VERSION || segment_->segment_bytes != sizeof(StatsSegment)
+           || segment_->pool_capacity != StatsSegment::POOLS
+           || segment_->class_count != StatsSegment::CLASSES)
+        {
+            detach();
+            return false;
+        }
+        return true;
+    }
+
+    const StatsSegment* segment_ = nullptr;
+};
+
+} // namespace dsa
@@ -0,0 +1,355 @@
+/**
+ * @file eTrace.hpp
+ * @brief Allocation trace recording for eAlloc: a lock-free event buffer and a compact binary log.
+ *
+ * A TraceRecorder is attached with eAlloc::setTraceRecorder() (requires EALLOC_ENABLE_TRACE).
+ * The allocator pushes one TraceEvent per malloc/calloc/memalign/realloc/free into a bounded
+ * multi-producer ring that lives in caller-provided storage; a single consumer periodically
+ * calls drain(), which encodes the events into the binary log and hands the bytes to a sink
+ * (file, UART, socket...). A full ring drops events and counts them rather than blocking the
+ * allocator.
+ *
+ * Log format (little endian, all integers LEB128 varints unless noted):
+ *   header:  "EATR" (4 bytes), version (1 byte)
+ *   record:  op (1 byte), zigzag(timestamp delta), thread, zigzag(ptr delta),
+ *            then per op: MALLOC/CALLOC size | MEMALIGN align, size |
+ *            REALLOC zigzag(old ptr delta), size | FREE nothing.
+ * Deltas are taken against the previous record, so a log of nearby addresses and close
+ * timestamps costs a few bytes per event. A failed allocation is logged with ptr 0.
+ *
+ * Pointers act as ids: the replayer maps each recorded address to its own live block. Behind the
+ * global lock, events are pushed while the operation still holds it, so the log order is a valid
+ * serialisation of the heap even with several threads. That holds in global-lock mode only: with
+ * eAlloc::setPerPoolLocking() on, allocations are recorded after their pool lock is released, and
+ * a block freed by one thread and reused by another may be logged out of order.
+ */
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#if defined(EALLOC_PC_HOST)
+    #include <chrono>
+#endif
+
+namespace dsa
+{
+
+/// Traced operation.
+enum class TraceOp : uint8_t
+{
+    MALLOC = 1,
+    CALLOC,
+    MEMALIGN,
+    REALLOC,
+    FREE
+};
+
+/// One decoded or recorded allocator event.
+struct TraceEvent
+{
+    uint64_t timestamp; ///< Clock value when the event was recorded.
+    uint64_t ptr;       ///< Returned block (0 on failure); the freed block for FREE.
+    uint64_t old_ptr;   ///< Block passed to REALLOC.
+    uint64_t size;      ///< Requested bytes (num * size for CALLOC).
+    uint64_t align;     ///< Requested alignment for MEMALIGN.
+    uint32_t thread;    ///< Id of the calling thread.
+    TraceOp op;
+};
+
+/**
+ * @brief Bounded lock-free event buffer with a compact binary encoder.
+ *
+ * record() may be called concurrently from any number of threads; drain() must only be called
+ * from one thread at a time.
+ */
+class TraceRecorder
+{
+   public:
+    using Clock = uint64_t (*)();
+    using ThreadId = uint32_t (*)();
+    /// Receives encoded log bytes from drain().
+    using Sink = void (*)(const void* data, size_t bytes, void* user);
+
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t MAX_RECORD_BYTES = 1 + 6 * 10;
+
+    /**
+     * @brief Builds a recorder over @p storage.
+     * @param storage Buffer for the ring, aligned to alignof(std::max_align_t).
+     * @param bytes Size of @p storage; the ring holds the largest power of two of
+     *        slot_size() slots that fits.
+     * @param clock Timestamp source; defaults to nanoseconds since an arbitrary epoch on host
+     *        builds and to 0 elsewhere.
+     * @param thread Thread id source; defaults to a small per-thread counter on host builds and
+     *        to 0 elsewhere.
+     */
+    TraceRecorder(void* storage, size_t bytes, Clock clock = default_clock,
+                  ThreadId thread = default_thread) :
+        slots_(static_cast<Slot*>(storage)), mask_(0), clock_(clock), thread_(thread)
+    {
+        size_t capacity = 1;
+        while(capacity * 2 * sizeof(Slot) <= bytes) capacity *= 2;
+        if(!storage || bytes < sizeof(Slot))
+        {
+            slots_ = nullptr;
+            return;
+        }
+        mask_ = capacity - 1;
+        for(size_t i = 0; i < capacity; ++i) new(&slots_[i]) Slot(i);
+    }
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    /// Storage bytes taken by one buffered event.
+    static constexpr size_t slot_size() { return sizeof(Slot); }
+
+    /// Number of events the ring can buffer.
+    size_t capacity() const { return slots_ ? mask_ + 1 : 0; }
+
+    /// Events lost because the ring was full.
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Buffers one event; never blocks.
+     * @return false if the ring was full and the event was dropped.
+     */
+    bool record(TraceOp op, const void* ptr, const void* old_ptr, size_t size, size_t align)
+    {
+        if(!slots_) return false;
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for(;;)
+        {
+            slot = &slots_[pos & mask_];
+            const size_t seq = slot->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if(diff == 0)
+            {
+                if(tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if(diff < 0)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        TraceEvent& event = slot->event;
+        event.timestamp = clock_ ? clock_() : 0;
+        event.ptr = reinterpret_cast<uintptr_t>(ptr);
+        event.old_ptr = reinterpret_cast<uintptr_t>(old_ptr);
+        event.size = size;
+        event.align = align;
+        event.thread = thread_ ? thread_() : 0;
+        event.op = op;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Encodes every buffered event and passes the bytes to @p sink.
+     *
+     * The first drain also emits the log header, so concatenating every chunk handed to the sink
+     * yields one complete log.
+     * @return Number of events drained.
+     */
+    size_t drain(Sink sink, void* user)
+    {
+        uint8_t chunk[512];
+        size_t used = 0;
+        if(!header_written_)
+        {
+            memcpy(chunk, "EATR", 4);
+            chunk[4] = VERSION;
+            used = 5;
+            header_written_ = true;
+        }
+        size_t count = 0;
+        while(slots_)
+        {
+            Slot& slot = slots_[head_ & mask_];
+            if(slot.sequence.load(std::memory_order_acquire) != head_ + 1) break;
+            if(used + MAX_RECORD_BYTES > sizeof(chunk))
+            {
+                sink(chunk, used, user);
+                used = 0;
+            }
+            used += encode(slot.event, chunk + used);
+            slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+            head_++;
+            count++;
+        }
+        if(used) sink(chunk, used, user);
+        return count;
+    }
+
+    /// Nanoseconds from the host steady clock (0 on targets without one).
+    static uint64_t default_clock()
+    {
+#if defined(EALLOC_PC_HOST)
+        using namespace std::chrono;
+        return static_cast<uint64_t>(
+            duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+#else
+        return 0;
+#endif
+    }
+
+    /// Small dense id per thread, in order of first use (0 on targets without threads).
+    static uint32_t default_thread()
+    {
+#if defined(EALLOC_PC_HOST)
+        static std::atomic<uint32_t> next{0};
+        thread_local uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+        return id;
+#else
+        return 0;
+#endif
+    }
+
+   private:
+    struct Slot
+    {
+        explicit Slot(size_t seq) : sequence(seq), event() {}
+        std::atomic<size_t> sequence;
+        TraceEvent event;
+    };
+
+    static size_t put_varint(uint8_t* out, uint64_t value)
+    {
+        size_t n = 0;
+        while(value >= 0x80)
+        {
+            out[n++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        out[n++] = static_cast<uint8_t>(value);
+        return n;
+    }
+
+    static uint64_t zigzag(uint64_t now, uint64_t before)
+    {
+        const int64_t delta = static_cast<int64_t>(now - before);
+        return (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+    }
+
+    size_t encode(const TraceEvent& e, uint8_t* out)
+    {
+        size_t n = 0;
+        out[n++] = static_cast<uint8_t>(e.op);
+        n += put_varint(out + n, zigzag(e.timestamp, last_timestamp_));
+        n += put_varint(out + n, e.thread);
+        n += put_varint(out + n, zigzag(e.ptr, last_ptr_));
+        switch(e.op)
+        {
+            case TraceOp::MEMALIGN: n += put_varint(out + n, e.align); break;
+            case TraceOp::REALLOC: n += put_varint(out + n, zigzag(e.old_ptr, last_ptr_)); break;
+            default: break;
+        }
+        if(e.op != TraceOp::FREE) n += put_varint(out + n, e.size);
+        last_timestamp_ = e.timestamp;
+        last_ptr_ = e.ptr;
+        return n;
+    }
+
+    Slot* slots_;
+    size_t mask_;
+    Clock clock_;
+    ThreadId thread_;
+    std::atomic<size_t> tail_{0};
+    std::atomic<uint64_t> dropped_{0};
+    // Consumer side, touched by drain() only
+    size_t head_ = 0;
+    uint64_t last_timestamp_ = 0;
+    uint64_t last_ptr_ = 0;
+    bool header_written_ = false;
+};
+
+/**
+ * @brief Decodes a log produced by TraceRecorder::drain().
+ *
+ * Usage:
+ *   dsa::TraceReader reader(bytes, length);
+ *   for(dsa::TraceEvent e; reader.next(e);) { ... }
+ *   if(!reader.ok()) { ... truncated or not a trace ... }
+ */
+class TraceReader
+{
+   public:
+    TraceReader(const void* data, size_t bytes) :
+        data_(static_cast<const uint8_t*>(data)), end_(data_ + bytes)
+    {
+        ok_ = bytes >= 5 && memcmp(data_, "EATR", 4) == 0 && data_[4] == TraceRecorder::VERSION;
+        data_ += ok_ ? 5 : 0;
+    }
+
+    /// False if the header was not recognised or a record was cut short.
+    bool ok() const { return ok_; }
+
+    /// Decodes the next event; returns false at the end of the log or on a malformed record.
+    bool next(TraceEvent& e)
+    {
+        if(!ok_ || data_ == end_) return false;
+        const uint8_t op = *data_++;
+        if(op < static_cast<uint8_t>(TraceOp::MALLOC) || op > static_cast<uint8_t>(TraceOp::FREE))
+            return fail();
+        e = TraceEvent();
+        e.op = static_cast<TraceOp>(op);
+        uint64_t value = 0;
+        if(!get_varint(value)) return fail();
+        e.timestamp = last_timestamp_ + unzigzag(value);
+        if(!get_varint(value)) return fail();
+        e.thread = static_cast<uint32_t>(value);
+        if(!get_varint(value)) return fail();
+        e.ptr = last_ptr_ + unzigzag(value);
+        if(e.op == TraceOp::MEMALIGN && !get_varint(e.align)) return fail();
+        if(e.op == TraceOp::REALLOC)
+        {
+            if(!get_varint(value)) return fail();
+            e.old_ptr = last_ptr_ + unzigzag(value);
+        }
+        if(e.op != TraceOp::FREE && !get_varint(e.size)) return fail();
+        last_timestamp_ = e.timestamp;
+        last_ptr_ = e.ptr;
+        return true;
+    }
+
+   private:
+    bool fail()
+    {
+        ok_ = false;
+        return false;
+    }
+
+    bool get_varint(uint64_t& value)
+    {
+        value = 0;
+        for(unsigned shift = 0; data_ != end_ && shift < 64; shift += 7)
+        {
+            const uint8_t byte = *data_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if(!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    static uint64_t unzigzag(uint64_t value)
+    {
+        return (value >> 1) ^ (~(value & 1) + 1);
+    }
+
+    const uint8_t* data_;
+    const uint8_t* end_;
+    bool ok_;
+    uint64_t last_timestamp_ = 0;
+    uint64_t last_ptr_ = 0;
+};
+
+} // namespace dsa
@@ -33,6 +33,7 @@ class eAlloc;
 #endif
 
 #include <stdint.h>
+#include "eLog.hpp"
 
 #if defined(EALLOC_PC_HOST)
     #include <mutex>
@@ -115,6 +116,31 @@ class LockGuard
     bool acquired_;
 };
 
+/**
+ * @brief LockGuard for an optional lock: holds @p lock for the guard's scope if it is non-null.
+ *
+ * Lets callers guard a whole function body with a lock that may not be configured, instead of
+ * branching on the pointer (a guard declared inside such a branch is released at its end).
+ */
+class OptionalLockGuard
+{
+   public:
+    explicit OptionalLockGuard(ILockable* lock, uint32_t timeout_ms = 0xFFFFFFFF) :
+        lock_((lock && lock->lock(timeout_ms)) ? lock : nullptr)
+    {
+    }
+    ~OptionalLockGuard()
+    {
+        if(lock_) lock_->unlock();
+    }
+    bool acquired() const { return lock_ != nullptr; }
+    OptionalLockGuard(const OptionalLockGuard&) = delete;
+    OptionalLockGuard& operator=(const OptionalLockGuard&) = delete;
+
+   private:
+    ILockable* lock_;
+};
+
 // --- Platform Adapters ---
 
 #if defined(FREERTOS) || defined(ESP_PLATFORM) || defined(ARDUINO)
@@ -133,8 +159,7 @@ class FreeRTOSMutex : public ILockable
     FreeRTOSMutex(SemaphoreHandle_t sem) : sem_(sem) {}
     bool lock(uint32_t timeout_ms) override
     {
-        static int lock_counter = 0;
-        LOG::INFO("E_ALLOC", "Locking FreeRTOS mutex %p. Attempt #%d\n", sem_, ++lock_counter);
+        dsa::log_event<dsa::EventId::LOCK_TAKEN>(sem_, timeout_ms);
         return xSemaphoreTake(sem_, timeout_ms / portTICK_PERIOD_MS) == pdTRUE;
     }
     void unlock() override { xSemaphoreGive(sem_); }
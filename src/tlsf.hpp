@@ -2,6 +2,9 @@
 
 #include "builtins.h"
 #include <assert.h>
+#if defined(EALLOC_ENABLE_CLASS_STATS) && EALLOC_ENABLE_CLASS_STATS
+    #include <atomic>
+#endif
 #include <climits>
 #include <cstdint>
 #include <cstdlib>
@@ -34,7 +37,8 @@ dsa_static_assert(sizeof(size_t) * CHAR_BIT <= 64);
 namespace dsa
 {
 
-template <size_t SLI = MAX_SLI,size_t ALIGN_EXP=DEFAULT_ALIGN_EXP> // NO LINT
+template <size_t SLI = MAX_SLI, size_t ALIGN_EXP = DEFAULT_ALIGN_EXP,
+          FreeListOrder ORDER = DEFAULT_FREE_LIST_ORDER> // NO LINT
 class TLSF
 {
    public:
@@ -81,28 +85,52 @@ class TLSF
     static constexpr size_t prev_free_bit = 1 << 1;
     static constexpr size_t flag_mask = prev_free_bit | free_bit;
 
-    static constexpr size_t block_header_overhead = sizeof(size_t);
-    static constexpr size_t block_start_offset =
-        offsetof(BlockHeader, size_and_flags) + block_header_overhead;
-    static constexpr size_t block_size_min = sizeof(BlockHeader) - sizeof(BlockHeader*);
+    /*
+     ** A used block's payload starts right after its size field (and owner tag, if any); its
+     ** prev_phys_block overlaps the last word of the preceding block's payload.
+     */
+    static constexpr size_t block_link_offset = offsetof(BlockHeader, size_and_flags);
+    static constexpr size_t block_start_offset = offsetof(BlockHeader, next_free);
+    static constexpr size_t block_header_overhead = block_start_offset - block_link_offset;
+    /* A free block must hold its free-list links plus the successor's prev_phys_block. */
+    static constexpr size_t block_size_min =
+        sizeof(BlockHeader) - block_start_offset + block_link_offset;
     static constexpr size_t block_size_max = static_cast<size_t>(1 << FL_INDEX_MAX);
 
     dsa_static_assert(sizeof(unsigned int) * CHAR_BIT >= SLI_COUNT);
     dsa_static_assert(BLOCK_ALIGNMENT == SMALL_BLOCK_SIZE / SLI_COUNT);
 
    public:
+#if defined(EALLOC_ENABLE_CLASS_STATS) && EALLOC_ENABLE_CLASS_STATS
+    /**
+     * @brief Event counters of one (fl, sl) size class, indexed fl * shelves() + sl.
+     *
+     * Relaxed atomics: pools under different per-pool locks may update the same class.
+     */
+    struct ClassCounters
+    {
+        std::atomic<size_t> allocations{0};     ///< Blocks handed out in this class.
+        std::atomic<size_t> live{0};            ///< Blocks of this class currently in use.
+        std::atomic<size_t> requested_bytes{0}; ///< Sum of the sizes asked for.
+        std::atomic<size_t> granted_bytes{0};   ///< Sum of the usable sizes handed out.
+        std::atomic<size_t> splits{0};          ///< Blocks of this class split in two.
+        std::atomic<size_t> merges{0};          ///< Coalesces that produced a block of this class.
+    };
+#endif
+
     /**
      * @brief Second-level structure for the TLSF allocator.
      *
      * This structure represents the second-level index in the Two-Level Segregated Fit allocator.
      * It maintains a bitmap (sl_bitmap) that indicates which shelves (free lists) have available
      * blocks, and an array of pointers (shelves) to the free block lists for blocks of specific
-     * size ranges.
+     * size ranges. With FreeListOrder::FIFO it also tracks the tail of every shelf.
      */
     struct SecondLevel
     {
         uint32_t sl_bitmap = 0;
         BlockHeader* shelves[SLI_COUNT] = {nullptr};
+        BlockHeader* tails[ORDER == FreeListOrder::FIFO ? SLI_COUNT : 1] = {nullptr};
     };
 
     /**
@@ -113,6 +141,11 @@ class TLSF
      * - A bitmap (fl_bitmap) representing the first-level free block availability.
      * - An array (cabinets) of second-level indices that manage the free lists for specific size
      * ranges.
+     * - Running totals of free bytes and free blocks, maintained by the free-list primitives so
+     * that storage statistics never require a heap walk.
+     * - The wilderness: the free block that ends at the pool sentinel. It is kept out of the
+     * shelves and carved directly whenever no filed block fits, so fresh pools are handed out
+     * contiguously from low to high addresses.
      */
     struct Control
     {
@@ -120,6 +153,15 @@ class TLSF
         BlockHeader block_null;
         uint32_t fl_bitmap = 0;
         SecondLevel cabinets[FL_INDEX_COUNT];
+        /* Bytes and number of blocks currently free, wilderness included. */
+        size_t free_bytes = 0;
+        size_t free_blocks = 0;
+        /* Trailing free block of the pool, or null if the last block is in use. */
+        BlockHeader* wilderness = nullptr;
+#if defined(EALLOC_ENABLE_CLASS_STATS) && EALLOC_ENABLE_CLASS_STATS
+        /* total_shelves() counters shared by the pools of one allocator, or null. */
+        ClassCounters* class_counters = nullptr;
+#endif
     };
 
     /* A type used for casting when doing pointer arithmetic. */
@@ -259,7 +301,7 @@ class TLSF
     static inline BlockHeader* next(BlockHeader* block)
     {
         BlockHeader* n =
-            offset_to_block_nc(to_ptr_nc(block), get_size(block) - block_header_overhead);
+            offset_to_block_nc(to_ptr_nc(block), get_size(block) - block_link_offset);
         dsa_assert(!is_last(block));
         return n;
     }
@@ -267,7 +309,7 @@ class TLSF
     static inline const BlockHeader* next_const(const BlockHeader* block)
     {
         const BlockHeader* n =
-            offset_to_block(to_ptr(block), get_size(block) - block_header_overhead);
+            offset_to_block(to_ptr(block), get_size(block) - block_link_offset);
         dsa_assert(!is_last(block));
         return n;
     }
@@ -383,6 +425,75 @@ class TLSF
         mapping_insert(size, fli, sli);
     }
 
+    /**
+     * @brief Rounds a request up to the lower bound of the size class mapping_search() selects.
+     *
+     * Every block in that class is at least this large, so asking for the rounded size costs no
+     * extra memory and exposes the slack the class rounding already implies.
+     *
+     * @param size The (already adjusted) requested allocation size.
+     * @return The rounded size.
+     */
+    static inline size_t round_request_size(size_t size)
+    {
+        if(size >= SMALL_BLOCK_SIZE)
+        {
+            const size_t round = (1 << (fls(size) - SL_INDEX_LOG2)) - 1;
+            size = (size + round) & ~round;
+        }
+        return size;
+    }
+
+    /**
+     * @brief Returns the smallest block size mapping_insert() files under (fl, sl).
+     *
+     * @param fl First-level index.
+     * @param sl Second-level index.
+     * @return Lower bound of the size class in bytes.
+     */
+    static inline size_t class_floor(int fl, int sl)
+    {
+        if(fl == 0) return static_cast<size_t>(sl) * (SMALL_BLOCK_SIZE / SLI_COUNT);
+        const size_t base = static_cast<size_t>(1) << (fl + FL_INDEX_SHIFT - 1);
+        return base + static_cast<size_t>(sl) * (base >> SL_INDEX_LOG2);
+    }
+
+    /**
+     * @brief Counts a split of a block of @p size bytes in its size class.
+     *
+     * No-op unless EALLOC_ENABLE_CLASS_STATS is set and the control has counters attached.
+     */
+    static inline void count_split(Control* control, size_t size)
+    {
+#if defined(EALLOC_ENABLE_CLASS_STATS) && EALLOC_ENABLE_CLASS_STATS
+        if(!control->class_counters) return;
+        int fl, sl;
+        mapping_insert(size, &fl, &sl);
+        control->class_counters[fl * SLI_COUNT + sl].splits.fetch_add(1, std::memory_order_relaxed);
+#else
+        (void)control;
+        (void)size;
+#endif
+    }
+
+    /**
+     * @brief Counts a coalesce that produced @p block in the block's size class.
+     *
+     * No-op unless EALLOC_ENABLE_CLASS_STATS is set and the control has counters attached.
+     */
+    static inline void count_merge(Control* control, const BlockHeader* block)
+    {
+#if defined(EALLOC_ENABLE_CLASS_STATS) && EALLOC_ENABLE_CLASS_STATS
+        if(!control->class_counters) return;
+        int fl, sl;
+        mapping_insert(get_size(block), &fl, &sl);
+        control->class_counters[fl * SLI_COUNT + sl].merges.fetch_add(1, std::memory_order_relaxed);
+#else
+        (void)control;
+        (void)block;
+#endif
+    }
+
     /**
      * @brief Searches for a suitable free block in the TLSF allocator.
      *
@@ -423,6 +534,7 @@ class TLSF
      *
      * Detaches the specified block from its free list by updating its previous and next pointers
      * and adjusts the free list bitmaps corresponding to the first-level and second-level indices.
+     * Removing the wilderness block simply clears Control::wilderness.
      *
      * @param control Pointer to the TLSF control structure.
      * @param block Pointer to the block to be removed.
@@ -431,10 +543,23 @@ class TLSF
      */
     static inline void remove_free_block(Control* control, BlockHeader* block, int fl, int sl)
     {
+        if(block == control->wilderness)
+        {
+            control->wilderness = nullptr;
+            control->free_bytes -= get_size(block);
+            control->free_blocks--;
+            return;
+        }
         BlockHeader* prev = block->prev_free;
         BlockHeader* next = block->next_free;
         if(next) next->prev_free = prev;
         if(prev) prev->next_free = next;
+        control->free_bytes -= get_size(block);
+        control->free_blocks--;
+        if(ORDER == FreeListOrder::FIFO && control->cabinets[fl].tails[sl] == block)
+        {
+            control->cabinets[fl].tails[sl] = prev;
+        }
         if(control->cabinets[fl].shelves[sl] == block)
         {
             control->cabinets[fl].shelves[sl] = next;
@@ -453,7 +578,9 @@ class TLSF
      * @brief Inserts a block into the free list.
      *
      * Adds the specified block into the free list at the given first-level and second-level
-     * indices, updating the free list pointers and associated bitmaps accordingly.
+     * indices, updating the free list pointers and associated bitmaps accordingly. The position
+     * within the shelf follows the ORDER policy: head (LIFO), tail (FIFO) or ascending address
+     * (ADDRESS_ORDERED).
      *
      * @param control Pointer to the TLSF control structure.
      * @param block Pointer to the block to be inserted.
@@ -465,15 +592,45 @@ class TLSF
         BlockHeader* current = control->cabinets[fl].shelves[sl];
         dsa_assert(current && "free list cannot have a null entry");
         dsa_assert(block && "cannot insert a null entry into the free list");
-        block->next_free = current;
-        block->prev_free = &control->block_null;
-        if(current) current->prev_free = block;
-
         dsa_assert(to_ptr(block) == align_ptr(to_ptr(block), ALIGN_SIZE)
                    && "block not aligned properly");
-        control->cabinets[fl].shelves[sl] = block;
+        BlockHeader* null_block = &control->block_null;
+        BlockHeader* after = nullptr; /* Block the new entry is linked behind; none for the head. */
+        if(ORDER == FreeListOrder::FIFO && current != null_block)
+        {
+            after = control->cabinets[fl].tails[sl];
+        }
+        else if(ORDER == FreeListOrder::ADDRESS_ORDERED)
+        {
+            while(current != null_block && current < block)
+            {
+                after = current;
+                current = current->next_free;
+            }
+        }
+
+        if(after)
+        {
+            block->next_free = after->next_free;
+            block->prev_free = after;
+            after->next_free->prev_free = block;
+            after->next_free = block;
+        }
+        else
+        {
+            block->next_free = current;
+            block->prev_free = null_block;
+            if(current) current->prev_free = block;
+            control->cabinets[fl].shelves[sl] = block;
+        }
+        if(ORDER == FreeListOrder::FIFO && block->next_free == null_block)
+        {
+            control->cabinets[fl].tails[sl] = block;
+        }
         control->fl_bitmap |= (1U << fl);
         control->cabinets[fl].sl_bitmap |= (1U << sl);
+        control->free_bytes += get_size(block);
+        control->free_blocks++;
     }
 
     /* Remove a given block from the free list. */
@@ -484,9 +641,17 @@ class TLSF
         remove_free_block(control, block, fl, sl);
     }
 
-    /* Insert a given block into the free list. */
+    /* Insert a given block into the free list, or adopt it as the wilderness if it ends the pool. */
     static inline void insert(Control* control, BlockHeader* block)
     {
+        if(is_last(next(block)))
+        {
+            dsa_assert(!control->wilderness && "pool can only have one trailing block");
+            control->wilderness = block;
+            control->free_bytes += get_size(block);
+            control->free_blocks++;
+            return;
+        }
         int fl, sl;
         mapping_insert(get_size(block), &fl, &sl);
         insert_free_block(control, block, fl, sl);
@@ -520,7 +685,7 @@ class TLSF
      */
     static inline BlockHeader* split(BlockHeader* block, size_t size)
     {
-        BlockHeader* remaining = offset_to_block_nc(to_ptr_nc(block), size - block_header_overhead);
+        BlockHeader* remaining = offset_to_block_nc(to_ptr_nc(block), size - block_link_offset);
         const size_t remain_size = get_size(block) - (size + block_header_overhead);
         dsa_assert(to_ptr(remaining) == align_ptr(to_ptr(remaining), BLOCK_ALIGNMENT)
                    && "remaining block not aligned properly");
@@ -568,6 +733,7 @@ class TLSF
             dsa_assert(is_free(p) && "prev block is not free though marked as such");
             remove(control, p);
             block = absorb(p, block);
+            count_merge(control, block);
         }
         return block;
     }
@@ -591,6 +757,7 @@ class TLSF
             dsa_assert(!is_last(block) && "previous block can't be last");
             remove(control, n);
             block = absorb(block, n);
+            count_merge(control, block);
         }
         return block;
     }
@@ -611,6 +778,7 @@ class TLSF
         dsa_assert(is_free(block) && "block must be free");
         if(can_split(block, size))
         {
+            count_split(control, get_size(block));
             BlockHeader* remaining_block = split(block, size);
             link_next(block);
             set_prev_free(remaining_block);
@@ -633,6 +801,7 @@ class TLSF
         dsa_assert(!is_free(block) && "block must be free");
         if(can_split(block, size))
         {
+            count_split(control, get_size(block));
             BlockHeader* remaining_block = split(block, size);
             set_prev_used(remaining_block);
             remaining_block = merge_next(control, remaining_block);
@@ -656,6 +825,7 @@ class TLSF
         BlockHeader* remaining_block = block;
         if(can_split(block, size))
         {
+            count_split(control, get_size(block));
             remaining_block = split(block, size - block_header_overhead);
             set_prev_free(remaining_block);
             link_next(block);
@@ -668,7 +838,9 @@ class TLSF
      * @brief Locates a free block of sufficient size from the free list.
      *
      * Searches for a free block that meets or exceeds the requested size and removes it from the
-     * free list.
+     * free list. Filed blocks are reused first (exact class, then the next larger one); the
+     * wilderness is carved (bump allocation from the pool tail) only when no filed block fits,
+     * which keeps the touched footprint of large pools small.
      *
      * @param control Pointer to the TLSF control structure.
      * @param size The minimum required block size.
@@ -682,6 +854,11 @@ class TLSF
         {
             mapping_search(size, &fl, &sl);
             if(fl < FL_INDEX_COUNT) block = search_suitable_block(control, &fl, &sl);
+            BlockHeader* wild = control->wilderness;
+            if(wild && !block && get_size(wild) >= size)
+            {
+                block = wild;
+            }
         }
         if(block)
         {
@@ -715,6 +892,51 @@ class TLSF
         return p;
     }
 
+    /**
+     * @brief Returns the size of a block from the largest non-empty size class.
+     *
+     * Uses fl_bitmap/sl_bitmap to find the highest populated shelf and reports the size of its
+     * head block, or the wilderness if that is larger. Every block on that shelf lies in the same
+     * second-level class, so the result is exact when the shelf holds a single block and
+     * otherwise within one class width (1/SLI_COUNT) of the true maximum. Runs in constant time.
+     *
+     * @param control Pointer to the TLSF control structure.
+     * @return Size of the selected block in bytes, or 0 if no free block exists.
+     */
+    static inline size_t largest_free_size(const Control* control)
+    {
+        const BlockHeader* wild = control->wilderness;
+        size_t largest = wild ? get_size(wild) : 0;
+        if(control->fl_bitmap)
+        {
+            const int fl = fls(control->fl_bitmap);
+            const int sl = fls(control->cabinets[fl].sl_bitmap);
+            largest = dsa_max(largest, get_size(control->cabinets[fl].shelves[sl]));
+        }
+        return largest;
+    }
+
+    /**
+     * @brief Returns the size of a block from the smallest non-empty size class.
+     *
+     * Counterpart of largest_free_size() using the lowest populated shelf. Runs in constant time.
+     *
+     * @param control Pointer to the TLSF control structure.
+     * @return Size of the selected block in bytes, or 0 if no free block exists.
+     */
+    static inline size_t smallest_free_size(const Control* control)
+    {
+        size_t smallest = control->wilderness ? get_size(control->wilderness) : 0;
+        if(control->fl_bitmap)
+        {
+            const int fl = ffs(control->fl_bitmap);
+            const int sl = ffs(control->cabinets[fl].sl_bitmap);
+            const size_t shelf = get_size(control->cabinets[fl].shelves[sl]);
+            smallest = smallest ? dsa_min(smallest, shelf) : shelf;
+        }
+        return smallest;
+    }
+
     /**
      * @brief Initializes the TLSF allocator control structure.
      *
@@ -730,6 +952,9 @@ class TLSF
         control->block_null.prev_free = &control->block_null;
 
         control->fl_bitmap = 0;
+        control->free_bytes = 0;
+        control->free_blocks = 0;
+        control->wilderness = nullptr;
         for(i = 0; i < FL_INDEX_COUNT; ++i)
         {
             control->cabinets[i].sl_bitmap = 0;
@@ -737,6 +962,10 @@ class TLSF
             {
                 control->cabinets[i].shelves[j] = &control->block_null;
             }
+            for(j = 0; j < static_cast<int>(sizeof(control->cabinets[i].tails) / sizeof(BlockHeader*)); ++j)
+            {
+                control->cabinets[i].tails[j] = &control->block_null;
+            }
         }
     }
 
@@ -773,6 +1002,13 @@ class TLSF
 
         int status = 0;
 
+        /* The wilderness must be a free block ending at the pool sentinel. */
+        if(control->wilderness)
+        {
+            dsa_insist(is_free(control->wilderness) && "wilderness should be free");
+            dsa_insist(is_last(next_const(control->wilderness)) && "wilderness should end the pool");
+        }
+
         /* Check that the free lists and bitmaps are accurate. */
         for(i = 0; i < cabinets(); ++i)
         {
@@ -846,6 +1082,20 @@ class TLSF
     /// Returns the overhead (in bytes) incurred during each allocation.
     static constexpr inline size_t alloc_overhead() { return block_header_overhead; }
 
+    /// Returns the offset of a pool's first payload from the start of its heap area.
+    static constexpr inline size_t first_payload_offset() { return block_header_overhead; }
+
+    /**
+     * @brief Returns the header of the first block of a pool whose heap area starts at @p heap.
+     *
+     * The header is placed so that its prev_phys_block, never used for the first block, falls
+     * before the pool.
+     */
+    static inline BlockHeader* first_block(void* heap)
+    {
+        return offset_to_block_nc(heap, -static_cast<tlsfptr_t>(block_link_offset));
+    }
+
     /// Returns the block size in bytes.
     static inline size_t block_size(void* ptr)
     {
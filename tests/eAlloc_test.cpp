@@ -1,6 +1,9 @@
 #include "gtest/gtest.h"
 #include "eAlloc.hpp"
 #include "logSetup.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
 
 
 
@@ -15,6 +18,9 @@ struct LoggerEnvironment : ::testing::Environment
 // For ESP32/FreeRTOS: let the build system define ESP_PLATFORM/ESP32.
 // For host/PC tests: use StdMutex as default lock.
 
+// Every pool hosts its TLSF control at its head; test pools add it on top of the bytes they use
+static constexpr size_t POOL_HEAD = dsa::eAlloc::pool_control_bytes();
+
 // Minimal test object for allocation tests
 struct TestObject
 {
@@ -41,8 +47,8 @@ static elock::StdMutex test_mutex(test_raw_mutex);
 class eAllocTest : public ::testing::Test
 {
    protected:
-    static constexpr size_t MEMORY_SIZE = 4096;
-    uint8_t memory_buffer[MEMORY_SIZE];
+    static constexpr size_t MEMORY_SIZE = POOL_HEAD + 4096;
+    alignas(std::max_align_t) uint8_t memory_buffer[MEMORY_SIZE];
     dsa::eAlloc ealloc;
 
     eAllocTest() : ealloc(memory_buffer, MEMORY_SIZE) {}
@@ -72,7 +78,7 @@ TEST_F(eAllocTest, AllocateDeallocateTestObject)
 
 TEST_F(eAllocTest, AddSecondPool)
 {
-    uint8_t second_pool[2048];
+    alignas(std::max_align_t) uint8_t second_pool[POOL_HEAD + 2048];
     void* pool = ealloc.add_pool(second_pool, sizeof(second_pool));
     ASSERT_NE(pool, nullptr);
 }
@@ -98,7 +104,7 @@ TEST_F(eAllocTest, CheckPoolIntegrity)
 {
     int integrity_status = ealloc.check_pool(memory_buffer);
     EXPECT_EQ(integrity_status, 0);
-    uint8_t second_pool[2048];
+    alignas(std::max_align_t) uint8_t second_pool[POOL_HEAD + 2048];
     void* pool = ealloc.add_pool(second_pool, sizeof(second_pool));
     ASSERT_NE(pool, nullptr);
     integrity_status = ealloc.check_pool(pool);
@@ -148,9 +154,93 @@ TEST_F(eAllocTest, OutOfMemory)
     for(int i = 0; i < count; ++i) ealloc.free(ptrs[i]);
 }
 
+TEST_F(eAllocTest, WildernessServesContiguousAllocations)
+{
+    // A fresh pool is carved from its tail block in address order
+    uint8_t* prev = static_cast<uint8_t*>(ealloc.malloc(64));
+    ASSERT_NE(prev, nullptr);
+    std::vector<void*> ptrs{prev};
+    for(int i = 0; i < 8; ++i)
+    {
+        uint8_t* p = static_cast<uint8_t*>(ealloc.malloc(64));
+        ASSERT_NE(p, nullptr);
+        EXPECT_EQ(p, prev + 64 + dsa::TLSF<>::alloc_overhead());
+        ptrs.push_back(p);
+        prev = p;
+    }
+    EXPECT_EQ(ealloc.report().freeBlockCount, 1u);
+
+    // An exact-class hole is reused before the tail is carved further
+    ealloc.free(ptrs[3]);
+    EXPECT_EQ(ealloc.malloc(64), ptrs[3]);
+
+    // A smaller request splits a larger filed hole instead of touching the tail
+    ealloc.free(ptrs[5]);
+    ealloc.free(ptrs[6]);
+    void* small = ealloc.malloc(32);
+    EXPECT_EQ(small, ptrs[5]);
+    EXPECT_EQ(ealloc.report().freeBlockCount, 2u);
+    ptrs[5] = small;
+    ptrs.erase(ptrs.begin() + 6);
+
+    // A larger request that no shelf can satisfy falls back to the tail
+    void* big = ealloc.malloc(512);
+    ASSERT_NE(big, nullptr);
+    EXPECT_GT(big, ptrs.back());
+    EXPECT_EQ(ealloc.check(), 0);
+
+    // Freeing the last block merges back into the tail
+    ealloc.free(big);
+    for(void* p : ptrs) ealloc.free(p);
+    auto sr = ealloc.report();
+    EXPECT_EQ(sr.freeBlockCount, 1u);
+    EXPECT_EQ(sr.fragmentationFactor, 0.0);
+}
+
+TEST_F(eAllocTest, CallocReturnsZeroedMemoryFromZeroedPool)
+{
+    constexpr size_t POOL_SIZE = POOL_HEAD + 4096;
+    alignas(std::max_align_t) static uint8_t zero_pool[POOL_SIZE]; // .bss: zero-filled
+    dsa::eAlloc::PoolConfig config(5);
+    config.zeroed = true;
+    ASSERT_NE(ealloc.add_pool(zero_pool, POOL_SIZE, config), nullptr);
+
+    auto all_zero = [](const void* p, size_t n) {
+        const uint8_t* b = static_cast<const uint8_t*>(p);
+        for(size_t i = 0; i < n; ++i)
+            if(b[i]) return false;
+        return true;
+    };
+
+    for(int round = 0; round < 4; ++round)
+    {
+        void* a = ealloc.calloc(10, 24);
+        void* b = ealloc.memalign(64, 200);
+        void* c = ealloc.calloc(1, 333);
+        ASSERT_NE(a, nullptr);
+        ASSERT_NE(b, nullptr);
+        ASSERT_NE(c, nullptr);
+        EXPECT_EQ(ealloc.get_pool(a), zero_pool);
+        EXPECT_TRUE(all_zero(a, 240));
+        EXPECT_TRUE(all_zero(c, 333));
+        // Dirty everything so later rounds must clear recycled memory
+        memset(a, 0xA5, 240);
+        memset(b, 0x5A, 200);
+        memset(c, 0xFF, 333);
+        void* grown = ealloc.realloc(c, 500);
+        ASSERT_NE(grown, nullptr);
+        memset(grown, 0xEE, 500);
+        ealloc.free(b);
+        ealloc.free(a);
+        ealloc.free(grown);
+    }
+    EXPECT_EQ(ealloc.check(), 0);
+    ealloc.remove_pool(zero_pool);
+}
+
 TEST_F(eAllocTest, RemovePoolWithAllocationsFails)
 {
-    uint8_t second_pool[1024];
+    alignas(std::max_align_t) uint8_t second_pool[POOL_HEAD + 1024];
     void* pool = ealloc.add_pool(second_pool, sizeof(second_pool));
     ASSERT_NE(pool, nullptr);
     void* obj = ealloc.malloc(16);
@@ -192,9 +282,93 @@ TEST_F(eAllocTest, ReallocBehavior)
     EXPECT_EQ(ptr6, nullptr);
 }
 
+TEST_F(eAllocTest, ReallocAbsorbingWholeNeighbourKeepsSuccessorFlags)
+{
+    void* p = ealloc.malloc(64);
+    void* hole = ealloc.malloc(32);
+    void* successor = ealloc.malloc(64);
+    ASSERT_NE(p, nullptr);
+    ASSERT_NE(hole, nullptr);
+    ASSERT_NE(successor, nullptr);
+    const size_t exact =
+        ealloc.usable_size(p) + ealloc.usable_size(hole) + dsa::TLSF<>::alloc_overhead();
+    ealloc.free(hole);
+
+    // Growth takes the whole free neighbour, so nothing is split off behind it
+    ASSERT_EQ(ealloc.realloc(p, exact), p);
+    EXPECT_EQ(ealloc.check_pool(memory_buffer), 0);
+    ealloc.free(successor);
+    ealloc.free(p);
+    EXPECT_EQ(ealloc.check_pool(memory_buffer), 0);
+}
+
+TEST_F(eAllocTest, ReallocSizedPreservesLiveBytes)
+{
+    uint8_t* p = static_cast<uint8_t*>(ealloc.malloc(256));
+    ASSERT_NE(p, nullptr);
+    void* barrier = ealloc.malloc(16); // forces the growth below to move
+    ASSERT_NE(barrier, nullptr);
+    for(int i = 0; i < 100; ++i) p[i] = static_cast<uint8_t>(i);
+
+    uint8_t* q = static_cast<uint8_t*>(ealloc.realloc_sized(p, 100, 1024));
+    ASSERT_NE(q, nullptr);
+    EXPECT_NE(q, p);
+    for(int i = 0; i < 100; ++i) ASSERT_EQ(q[i], static_cast<uint8_t>(i));
+    ealloc.free(q);
+    ealloc.free(barrier);
+}
+
+TEST_F(eAllocTest, LargeReallocMoveUsesStreamingCopy)
+{
+    const size_t POOL_SIZE = 4 * dsa::STREAM_COPY_THRESHOLD;
+    void* pool_mem = malloc(POOL_SIZE);
+    ASSERT_NE(pool_mem, nullptr);
+    dsa::eAlloc big(pool_mem, POOL_SIZE);
+
+    const size_t live = dsa::STREAM_COPY_THRESHOLD + 13; // odd length exercises the tail copy
+    uint8_t* p = static_cast<uint8_t*>(big.malloc(live));
+    ASSERT_NE(p, nullptr);
+    void* barrier = big.malloc(16);
+    ASSERT_NE(barrier, nullptr);
+    for(size_t i = 0; i < live; ++i) p[i] = static_cast<uint8_t>(i * 7);
+
+    uint8_t* q = static_cast<uint8_t*>(big.realloc(p, 2 * dsa::STREAM_COPY_THRESHOLD));
+    ASSERT_NE(q, nullptr);
+    EXPECT_NE(q, p);
+    for(size_t i = 0; i < live; ++i) ASSERT_EQ(q[i], static_cast<uint8_t>(i * 7));
+    big.free(q);
+    big.free(barrier);
+    free(pool_mem);
+}
+
+TEST_F(eAllocTest, UsableSizeAndAllocateAtLeast)
+{
+    EXPECT_EQ(ealloc.usable_size(nullptr), 0u);
+    void* p = ealloc.malloc(100);
+    ASSERT_NE(p, nullptr);
+    EXPECT_GE(ealloc.usable_size(p), 100u);
+
+    // 300 bytes sits inside a size class wider than the alignment, so capacity grows
+    dsa::eAlloc::AllocationResult r = ealloc.allocate_at_least(300);
+    ASSERT_NE(r.ptr, nullptr);
+    EXPECT_GE(r.count, 300u);
+    EXPECT_EQ(r.count, ealloc.usable_size(r.ptr));
+    memset(r.ptr, 0x42, r.count); // the whole capacity is usable
+    EXPECT_EQ(ealloc.check(), 0);
+
+    ealloc.free_sized(r.ptr, r.count);
+    ealloc.free_sized(p, 100);
+    auto sr = ealloc.report();
+    EXPECT_EQ(sr.freeBlockCount, 1u);
+
+    dsa::eAlloc::AllocationResult none = ealloc.allocate_at_least(1u << 20);
+    EXPECT_EQ(none.ptr, nullptr);
+    EXPECT_EQ(none.count, 0u);
+}
+
 TEST_F(eAllocTest, PoolConfigManagement)
 {
-    uint8_t second_pool[1024];
+    alignas(std::max_align_t) uint8_t second_pool[POOL_HEAD + 1024];
     dsa::eAlloc::PoolConfig config;
     config.min_block_size = 32;
     config.preferred_alignment = 8;
@@ -269,21 +443,118 @@ TEST_F(eAllocTest, AllocationFailureHandler)
     ealloc.setAllocationFailureHandler(nullptr);
 }
 
-TEST_F(eAllocTest, PoolOverflow)
+TEST_F(eAllocTest, PointerToPoolLookupAcrossPools)
+{
+    // One buffer split into pools added out of address order
+    constexpr size_t SLICE = (POOL_HEAD + 1024 + 15) & ~size_t(15);
+    alignas(16) static uint8_t arena[4 * SLICE];
+    uint8_t* pools[3] = {arena + 2 * SLICE, arena, arena + SLICE};
+    for(int i = 0; i < 3; ++i)
+    {
+        dsa::eAlloc::PoolConfig config(10 + i);
+        ASSERT_NE(ealloc.add_pool(pools[i], SLICE, config), nullptr);
+    }
+    for(int i = 0; i < 3; ++i)
+    {
+        // Highest priority pool is used first; fill it so the next one takes over
+        void* p = ealloc.malloc(900);
+        ASSERT_NE(p, nullptr);
+        EXPECT_EQ(ealloc.get_pool(p), pools[2 - i]);
+        EXPECT_EQ(ealloc.get_pool_from_block(static_cast<uint8_t*>(p) + 899), pools[2 - i]);
+        ealloc.free(p);
+        EXPECT_EQ(ealloc.get_pool(p), pools[2 - i]);
+        ealloc.remove_pool(pools[2 - i]);
+    }
+    EXPECT_EQ(ealloc.get_pool(arena + 3 * SLICE), nullptr);
+    uint8_t outside[16];
+    EXPECT_EQ(ealloc.get_pool(outside), nullptr);
+    EXPECT_EQ(ealloc.get_pool(memory_buffer + 64), memory_buffer);
+}
+
+TEST_F(eAllocTest, WalkPoolStartsAtTheHeapOfPoolsHostingTheirControl)
+{
+    // Large enough to embed its TLSF control, so the first block sits past the pool start
+    alignas(16) static uint8_t big_pool[64 * 1024];
+    ASSERT_EQ(ealloc.add_pool(big_pool, sizeof(big_pool)), big_pool);
+    void* p = ealloc.malloc(20000);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(ealloc.get_pool(p), big_pool);
+    EXPECT_EQ(ealloc.check_pool(big_pool), 0);
+
+    struct Tally
+    {
+        size_t used = 0;
+        size_t bytes = 0;
+    } tally;
+    ealloc.walk_pool(
+        big_pool,
+        [](void*, size_t size, int used, void* user) {
+            Tally* t = static_cast<Tally*>(user);
+            t->used += used ? 1 : 0;
+            t->bytes += size;
+        },
+        &tally);
+    EXPECT_EQ(tally.used, 1u);
+    EXPECT_GE(tally.bytes, 20000u);
+    EXPECT_LT(tally.bytes, sizeof(big_pool));
+    ealloc.free(p);
+    ealloc.remove_pool(big_pool);
+}
+
+TEST_F(eAllocTest, PoolsBeyondInlineRegistry)
 {
-    uint8_t pool1[512], pool2[512], pool3[512], pool4[512], pool5[512];
-    void* p1 = ealloc.add_pool(pool1, sizeof(pool1));
-    void* p2 = ealloc.add_pool(pool2, sizeof(pool2));
-    void* p3 = ealloc.add_pool(pool3, sizeof(pool3));
-    void* p4 = ealloc.add_pool(pool4, sizeof(pool4));
-    // Only 4 more pools can be added after the initial pool
-    ASSERT_NE(p1, nullptr);
-    ASSERT_NE(p2, nullptr);
-    ASSERT_NE(p3, nullptr);
-    ASSERT_NE(p4, nullptr);
-    // Exceed MAX_POOL (should fail)
-    void* p5 = ealloc.add_pool(pool5, sizeof(pool5));
-    EXPECT_EQ(p5, nullptr);
+    // Every pool hosts its own control, so more than MAX_POOL of them can be added
+    constexpr size_t POOLS = 2 * dsa::MAX_POOL;
+    constexpr size_t POOL_SIZE = 64 * 1024;
+    alignas(16) static uint8_t arena[POOLS][POOL_SIZE];
+    // Keep the initial pool busy so the grown registry lands inside one of the new pools
+    void* filler = ealloc.malloc(3500);
+    ASSERT_NE(filler, nullptr);
+    for(size_t i = 0; i < POOLS; ++i)
+    {
+        ASSERT_EQ(ealloc.add_pool(arena[i], POOL_SIZE), arena[i]);
+    }
+    EXPECT_EQ(ealloc.get_pool_count(), POOLS + 1);
+    EXPECT_EQ(ealloc.check(), 0);
+    for(size_t i = 0; i < POOLS; ++i)
+    {
+        EXPECT_EQ(ealloc.get_pool_index(arena[i]), i + 1);
+        EXPECT_EQ(ealloc.get_pool_from_block(arena[i] + POOL_SIZE / 2), arena[i]);
+    }
+    void* big = ealloc.malloc(POOL_SIZE / 2);
+    ASSERT_NE(big, nullptr);
+    EXPECT_NE(ealloc.get_pool_index(ealloc.get_pool(big)), dsa::eAlloc::INVALID_POOL_INDEX);
+    ealloc.free(big);
+
+    // Removing every added pool relocates the registry out of its host as needed
+    for(size_t i = 0; i < POOLS; ++i)
+    {
+        ealloc.remove_pool(arena[i]);
+        EXPECT_EQ(ealloc.get_pool_index(arena[i]), dsa::eAlloc::INVALID_POOL_INDEX);
+    }
+    EXPECT_EQ(ealloc.get_pool_count(), 1u);
+    EXPECT_EQ(ealloc.check(), 0);
+    ealloc.free(filler);
+    void* p = ealloc.malloc(64);
+    EXPECT_EQ(ealloc.get_pool(p), memory_buffer);
+    ealloc.free(p);
+}
+
+TEST_F(eAllocTest, PoolTooSmallForItsControlIsRejected)
+{
+    alignas(std::max_align_t) static uint8_t pools[2][dsa::eAlloc::min_pool_size()];
+    // The control alone leaves no room for a block
+    EXPECT_EQ(ealloc.add_pool(pools[0], POOL_HEAD), nullptr);
+    EXPECT_EQ(ealloc.get_pool_count(), 1u);
+    // Any number of pools is fine once each can hold its own control
+    EXPECT_EQ(ealloc.add_pool(pools[0], sizeof(pools[0])), pools[0]);
+    EXPECT_EQ(ealloc.add_pool(pools[1], sizeof(pools[1])), pools[1]);
+    void* p = ealloc.malloc(16);
+    ASSERT_NE(p, nullptr);
+    ealloc.free(p);
+    ealloc.remove_pool(pools[0]);
+    ealloc.remove_pool(pools[1]);
+    EXPECT_EQ(ealloc.check(), 0);
 }
 
 TEST_F(eAllocTest, FragmentationAndCoalescing)
@@ -307,8 +578,8 @@ TEST_F(eAllocTest, FragmentationAndCoalescing)
 TEST_F(eAllocTest, Defragmentation)
 {
     // Create a fragmented memory state
-    void* pool_mem = malloc(4096);
-    ASSERT_TRUE(ealloc.add_pool(pool_mem, 4096));
+    void* pool_mem = malloc(POOL_HEAD + 4096);
+    ASSERT_TRUE(ealloc.add_pool(pool_mem, POOL_HEAD + 4096));
 
     // Allocate and free blocks to create fragmentation
     void* ptr1 = ealloc.malloc(512);
@@ -340,7 +611,7 @@ TEST_F(eAllocTest, Defragmentation)
 
 TEST_F(eAllocTest, FragmentationFactorMultiPoolAccurate)
 {
-    uint8_t poolA[1024], poolB[1024];
+    alignas(std::max_align_t) uint8_t poolA[POOL_HEAD + 1024], poolB[POOL_HEAD + 1024];
     void* pA = ealloc.add_pool(poolA, sizeof(poolA));
     void* pB = ealloc.add_pool(poolB, sizeof(poolB));
     ASSERT_NE(pA, nullptr);
@@ -368,14 +639,46 @@ TEST_F(eAllocTest, FragmentationFactorMultiPoolAccurate)
     EXPECT_EQ(report.fragmentationFactor, 0.0);
 }
 
+TEST_F(eAllocTest, FastReportMatchesExactWalk)
+{
+    alignas(std::max_align_t) uint8_t poolA[POOL_HEAD + 1024];
+    ASSERT_NE(ealloc.add_pool(poolA, sizeof(poolA)), nullptr);
+
+    std::vector<void*> ptrs;
+    for(int i = 0; i < 12; ++i)
+    {
+        void* p = ealloc.malloc(48 + 16 * i);
+        if(p) ptrs.push_back(p);
+    }
+    for(size_t i = 0; i < ptrs.size(); i += 3) ealloc.free(ptrs[i]);
+
+    auto fast = ealloc.report();
+    auto exact = ealloc.report(dsa::eAlloc::ReportMode::EXACT);
+    EXPECT_EQ(fast.totalFreeSpace, exact.totalFreeSpace);
+    EXPECT_EQ(fast.freeBlockCount, exact.freeBlockCount);
+    EXPECT_EQ(fast.averageFreeBlockSize, exact.averageFreeBlockSize);
+    // Extremes come from the populated size classes and never overshoot the real values
+    EXPECT_LE(fast.largestFreeRegion, exact.largestFreeRegion);
+    EXPECT_GE(fast.largestFreeRegion, exact.largestFreeRegion - exact.largestFreeRegion / 16);
+    EXPECT_GE(fast.smallestFreeRegion, exact.smallestFreeRegion);
+
+    for(size_t i = 0; i < ptrs.size(); ++i)
+        if(i % 3) ealloc.free(ptrs[i]);
+    fast = ealloc.report();
+    exact = ealloc.report(dsa::eAlloc::ReportMode::EXACT);
+    EXPECT_EQ(fast.totalFreeSpace, exact.totalFreeSpace);
+    EXPECT_EQ(fast.largestFreeRegion, exact.largestFreeRegion);
+    EXPECT_EQ(fast.fragmentationFactor, exact.fragmentationFactor);
+}
+
 TEST_F(eAllocTest, AutoDefragmentation)
 {   
 
      // Enable auto-defragmentation with very low threshold to ensure it triggers
      ealloc.setAutoDefragment(true, 0.1);
     // Create a fragmented memory state
-    void* pool_mem = malloc(4096);
-    ASSERT_TRUE(ealloc.add_pool(pool_mem, 4096));
+    void* pool_mem = malloc(POOL_HEAD + 4096);
+    ASSERT_TRUE(ealloc.add_pool(pool_mem, POOL_HEAD + 4096));
 
     // Allocate and free blocks to create fragmentation
     void* ptr1 = ealloc.malloc(512);
@@ -410,9 +713,9 @@ TEST_F(eAllocTest, AutoDefragmentation)
 TEST_F(eAllocTest, PoolSpecificAllocation)
 {
     // Create multiple pools with different policies and priorities
-    char pool1[1024];
-    char pool2[1024];
-    char pool3[1024];
+    alignas(std::max_align_t) char pool1[POOL_HEAD + 1024];
+    alignas(std::max_align_t) char pool2[POOL_HEAD + 1024];
+    alignas(std::max_align_t) char pool3[POOL_HEAD + 1024];
 
     dsa::eAlloc::PoolConfig config1(0, 16, 16, dsa::eAlloc::Policy::FAST_ACCESS);
     dsa::eAlloc::PoolConfig config2(1, 16, 16, dsa::eAlloc::Policy::CRITICAL_ONLY);
@@ -449,6 +752,119 @@ TEST_F(eAllocTest, PoolSpecificAllocation)
     ealloc.free(ptr3);
 }
 
+TEST_F(eAllocTest, PolicyRouteFallsBackByPriority)
+{
+    using Policy = dsa::eAlloc::Policy;
+    alignas(std::max_align_t) static uint8_t fast_low[POOL_HEAD + 1024], fast_high[POOL_HEAD + 1024],
+        critical[POOL_HEAD + 1024];
+    ealloc.add_pool(fast_low, sizeof(fast_low), dsa::eAlloc::PoolConfig(1, 16, 16, Policy::FAST_ACCESS));
+    ealloc.add_pool(critical, sizeof(critical), dsa::eAlloc::PoolConfig(9, 16, 16, Policy::CRITICAL_ONLY));
+    ealloc.add_pool(fast_high, sizeof(fast_high), dsa::eAlloc::PoolConfig(5, 16, 16, Policy::FAST_ACCESS));
+
+    // Matching pools by descending priority, then the remaining pools by descending priority
+    void* expected[] = {fast_high, fast_low, critical, memory_buffer};
+    void* ptrs[4];
+    for(int i = 0; i < 4; ++i)
+    {
+        ptrs[i] = ealloc.malloc(800, 3, Policy::FAST_ACCESS);
+        ASSERT_NE(ptrs[i], nullptr);
+        EXPECT_EQ(ealloc.get_pool(ptrs[i]), expected[i]);
+    }
+    for(int i = 0; i < 4; ++i) ealloc.free(ptrs[i]);
+
+    // Routes follow pool removal
+    ealloc.remove_pool(fast_high);
+    void* p = ealloc.malloc(800, -1, Policy::FAST_ACCESS);
+    EXPECT_EQ(ealloc.get_pool(p), fast_low);
+    ealloc.free(p);
+    p = ealloc.malloc(800);
+    EXPECT_EQ(ealloc.get_pool(p), critical);
+    ealloc.free(p);
+}
+
+TEST_F(eAllocTest, PlacementStrategiesUseOccupancy)
+{
+    using Strategy = dsa::eAlloc::PlacementStrategy;
+    alignas(std::max_align_t) static uint8_t small_pool[POOL_HEAD + 1024],
+        large_pool[POOL_HEAD + 2048];
+    ASSERT_NE(ealloc.add_pool(small_pool, sizeof(small_pool)), nullptr);
+    ASSERT_NE(ealloc.add_pool(large_pool, sizeof(large_pool)), nullptr);
+
+    // Fullest first: the pool with the fewest free bytes
+    ealloc.setPlacementStrategy(Strategy::FULLEST_FIRST);
+    void* a = ealloc.malloc(64);
+    EXPECT_EQ(ealloc.get_pool(a), small_pool);
+
+    // Least loaded: fewest bytes in use, ties in pool order
+    ealloc.setPlacementStrategy(Strategy::LEAST_LOADED);
+    void* b = ealloc.malloc(64);
+    void* c = ealloc.malloc(64);
+    EXPECT_EQ(ealloc.get_pool(b), memory_buffer);
+    EXPECT_EQ(ealloc.get_pool(c), large_pool);
+
+    // Round robin: consecutive allocations visit every pool
+    ealloc.setPlacementStrategy(Strategy::ROUND_ROBIN);
+    void* d[3];
+    for(void*& p : d) p = ealloc.malloc(64);
+    EXPECT_NE(ealloc.get_pool(d[0]), ealloc.get_pool(d[1]));
+    EXPECT_NE(ealloc.get_pool(d[1]), ealloc.get_pool(d[2]));
+    EXPECT_NE(ealloc.get_pool(d[0]), ealloc.get_pool(d[2]));
+
+    // A preferred pool without room falls back along the route
+    ealloc.setPlacementStrategy(Strategy::FULLEST_FIRST);
+    void* big = ealloc.malloc(1500);
+    EXPECT_EQ(ealloc.get_pool(big), large_pool);
+
+    for(void* p : {a, b, c, d[0], d[1], d[2], big}) ealloc.free(p);
+    ealloc.setPlacementStrategy(Strategy::PRIORITY);
+}
+
+TEST_F(eAllocTest, HandleCompactionSlidesUnpinnedBlocks)
+{
+    dsa::eAlloc::Handle a = ealloc.allocate_handle(256);
+    dsa::eAlloc::Handle b = ealloc.allocate_handle(256);
+    dsa::eAlloc::Handle c = ealloc.allocate_handle(256);
+    dsa::eAlloc::Handle d = ealloc.allocate_handle(256);
+    ASSERT_NE(a, dsa::eAlloc::INVALID_HANDLE);
+    ASSERT_NE(b, dsa::eAlloc::INVALID_HANDLE);
+    ASSERT_NE(c, dsa::eAlloc::INVALID_HANDLE);
+    ASSERT_NE(d, dsa::eAlloc::INVALID_HANDLE);
+
+    void* b_addr = ealloc.pin(b);
+    memset(ealloc.pin(c), 0xC3, 256);
+    ealloc.unpin(c);
+    memset(ealloc.pin(d), 0xD4, 256);
+    ealloc.unpin(d);
+    ealloc.unpin(b);
+    ealloc.free_handle(b);
+    EXPECT_GT(ealloc.report().freeBlockCount, 1u);
+
+    // Pin d: c may move into b's hole, d must stay put
+    void* d_addr = ealloc.pin(d);
+    EXPECT_GE(ealloc.compact(), 1u);
+    EXPECT_EQ(ealloc.check(), 0);
+
+    uint8_t* c_ptr = static_cast<uint8_t*>(ealloc.pin(c));
+    EXPECT_EQ(c_ptr, b_addr);
+    for(int i = 0; i < 256; ++i) ASSERT_EQ(c_ptr[i], 0xC3);
+    ealloc.unpin(c);
+    EXPECT_EQ(ealloc.pin(d), d_addr);
+    ealloc.unpin(d);
+    ealloc.unpin(d);
+
+    // Unpinned d now slides too, leaving a single free region
+    EXPECT_GE(ealloc.compact(), 1u);
+    EXPECT_EQ(ealloc.report().freeBlockCount, 1u);
+    uint8_t* d_ptr = static_cast<uint8_t*>(ealloc.pin(d));
+    for(int i = 0; i < 256; ++i) ASSERT_EQ(d_ptr[i], 0xD4);
+    ealloc.unpin(d);
+
+    ealloc.free_handle(a);
+    ealloc.free_handle(c);
+    ealloc.free_handle(d);
+    EXPECT_EQ(ealloc.pin(d), nullptr);
+}
+
 TEST_F(eAllocTest, StatsConsistencyAfterFragmentation)
 {
     std::vector<void*> ptrs;
@@ -476,6 +892,46 @@ TEST_F(eAllocTest, StatsConsistencyAfterFragmentation)
     EXPECT_EQ(final.freeBlockCount, 1);
 }
 
+TEST_F(eAllocTest, PoolReportTracksUsagePeakAndFailures)
+{
+    alignas(std::max_align_t) static uint8_t second[POOL_HEAD + 2048];
+    ASSERT_NE(ealloc.add_pool(second, sizeof(second)), nullptr);
+
+    dsa::eAlloc::PoolStats stats[4];
+    ASSERT_EQ(ealloc.pool_report(nullptr, 0), 2u);
+    ASSERT_EQ(ealloc.pool_report(stats, 4), 2u);
+    EXPECT_EQ(stats[0].memory, static_cast<void*>(memory_buffer));
+    EXPECT_EQ(stats[1].memory, static_cast<void*>(second));
+    EXPECT_EQ(stats[1].bytes, sizeof(second));
+    const size_t idle[2] = {stats[0].in_use, stats[1].in_use};
+    auto index_of = [&](void* ptr) { return ealloc.get_pool(ptr) == memory_buffer ? 0 : 1; };
+
+    void* a = ealloc.malloc(1000);
+    void* b = ealloc.malloc(200);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    ealloc.pool_report(stats, 4);
+    EXPECT_EQ(stats[0].allocations + stats[1].allocations, 2u);
+    EXPECT_GE(stats[0].in_use + stats[1].in_use - idle[0] - idle[1], 1200u);
+    for(const auto& s : stats) EXPECT_GE(s.peak_in_use, s.in_use);
+
+    // Freeing lowers usage but not the peak, until the peaks are reset
+    const int pool_a = index_of(a);
+    const size_t peak = stats[pool_a].peak_in_use;
+    ealloc.free(a);
+    dsa::eAlloc::PoolStats after = ealloc.pool_stats(pool_a);
+    EXPECT_LE(after.in_use + 1000, stats[pool_a].in_use);
+    EXPECT_EQ(after.peak_in_use, peak);
+    ealloc.reset_pool_peaks();
+    EXPECT_EQ(ealloc.pool_stats(pool_a).peak_in_use, after.in_use);
+
+    // A request no pool can serve is a failure in every pool it was tried in
+    EXPECT_EQ(ealloc.malloc(MEMORY_SIZE + sizeof(second)), nullptr);
+    for(size_t i = 0; i < 2; ++i) EXPECT_GT(ealloc.pool_stats(i).failures, stats[i].failures);
+    EXPECT_EQ(ealloc.pool_stats(5).memory, nullptr);
+    ealloc.free(b);
+}
+
 TEST_F(eAllocTest, AllocationFailureHandlerIsCalled)
 {
     bool handler_called = false;
@@ -499,7 +955,7 @@ TEST_F(eAllocTest, AllocationFailureHandlerIsCalled)
 TEST_F(eAllocTest, PoolAddRemoveStress)
 {
     for(int cycle = 0; cycle < 5; ++cycle) {
-        uint8_t buf[512];
+        alignas(std::max_align_t) uint8_t buf[POOL_HEAD + 512];
         void* pool = ealloc.add_pool(buf, sizeof(buf));
         ASSERT_NE(pool, nullptr);
         std::vector<void*> ptrs;
@@ -514,33 +970,74 @@ TEST_F(eAllocTest, PoolAddRemoveStress)
     EXPECT_EQ(ealloc.check(), 0);
 }
 
+TEST_F(eAllocTest, CallocClearsAZeroedPoolAfterResize)
+{
+    alignas(std::max_align_t) static uint8_t zero_pool[POOL_HEAD + 2048]; // .bss: zero-filled
+    alignas(std::max_align_t) static uint8_t grown[POOL_HEAD + 4096 + 16];
+    dsa::eAlloc::PoolConfig config(5);
+    config.zeroed = true;
+    ASSERT_NE(ealloc.add_pool(zero_pool, sizeof(zero_pool), config), nullptr);
+
+    // Calls calloc and counts the bytes of the result that are not zero
+    auto dirty_bytes = [this](size_t n, const void* pool) {
+        const uint8_t* p = static_cast<const uint8_t*>(ealloc.calloc(1, n));
+        EXPECT_NE(p, nullptr);
+        if(!p) return n;
+        EXPECT_EQ(ealloc.get_pool(const_cast<uint8_t*>(p)), pool);
+        size_t dirty = 0;
+        for(size_t i = 0; i < n; ++i) dirty += p[i] != 0;
+        ealloc.free(const_cast<uint8_t*>(p));
+        return dirty;
+    };
+
+    void* used = ealloc.malloc(1900);
+    ASSERT_EQ(ealloc.get_pool(used), zero_pool);
+    memset(used, 0xA5, 1900);
+    ealloc.free(used);
+
+    // A misaligned block from the handler fails the expand, and the used pool is rebuilt
+    auto handler = [](void*, size_t, size_t, void* user) -> void* { return user; };
+    ealloc.setResizeAllocationHandler(handler, grown + 1);
+    EXPECT_FALSE(ealloc.resize_pool(zero_pool, POOL_HEAD + 4096));
+    EXPECT_EQ(dirty_bytes(1900, zero_pool), 0u);
+
+    // The handler's memory was never cleared
+    memset(grown, 0xCC, sizeof(grown));
+    ealloc.setResizeAllocationHandler(handler, grown);
+    ASSERT_TRUE(ealloc.resize_pool(zero_pool, POOL_HEAD + 4096));
+    EXPECT_EQ(dirty_bytes(3000, grown), 0u);
+    EXPECT_EQ(ealloc.check(), 0);
+    ealloc.remove_pool(grown);
+}
+
 TEST_F(eAllocTest, DynamicPoolResizing)
 {
     const size_t INITIAL_SIZE = 1024;
     const size_t SHRINK_SIZE = 512;
     const size_t EXPAND_SIZE = 2048;
-    char memory[INITIAL_SIZE];
-    char expanded_memory[EXPAND_SIZE];
-    dsa::eAlloc allocator(memory, INITIAL_SIZE);
+    // Sizes are what the pool can hand out; its memory also holds the control
+    alignas(std::max_align_t) char memory[POOL_HEAD + INITIAL_SIZE];
+    alignas(std::max_align_t) char expanded_memory[POOL_HEAD + EXPAND_SIZE];
+    dsa::eAlloc allocator(memory, sizeof(memory));
 
     // Verify initial pool size (accounting for possible overhead)
     dsa::eAlloc::StorageReport report = allocator.report();
     size_t initial_free_space = report.totalFreeSpace;
-    EXPECT_GE(initial_free_space, INITIAL_SIZE - 16); // Allow for small overhead
+    EXPECT_GE(initial_free_space, INITIAL_SIZE - dsa::TLSF<>::pool_overhead());
     EXPECT_LE(initial_free_space, INITIAL_SIZE);
 
     // Shrink the pool
-    bool shrink_result = allocator.resize_pool(memory, SHRINK_SIZE);
+    bool shrink_result = allocator.resize_pool(memory, POOL_HEAD + SHRINK_SIZE);
     EXPECT_TRUE(shrink_result);
 
     // Verify shrunk size (accounting for possible overhead)
     report = allocator.report();
     size_t shrunk_free_space = report.totalFreeSpace;
-    EXPECT_GE(shrunk_free_space, SHRINK_SIZE - 16); // Allow for small overhead
+    EXPECT_GE(shrunk_free_space, SHRINK_SIZE - dsa::TLSF<>::pool_overhead());
     EXPECT_LE(shrunk_free_space, SHRINK_SIZE);
 
     // Attempt to expand without handler (should fail)
-    bool expand_result = allocator.resize_pool(memory, EXPAND_SIZE);
+    bool expand_result = allocator.resize_pool(memory, POOL_HEAD + EXPAND_SIZE);
     EXPECT_FALSE(expand_result);
 
     // Verify size remains unchanged after failed expansion
@@ -557,13 +1054,13 @@ TEST_F(eAllocTest, DynamicPoolResizing)
     allocator.setResizeAllocationHandler(resize_handler, expanded_memory);
 
     // Attempt to expand with handler (should succeed)
-    expand_result = allocator.resize_pool(memory, EXPAND_SIZE);
+    expand_result = allocator.resize_pool(memory, POOL_HEAD + EXPAND_SIZE);
     EXPECT_TRUE(expand_result);
 
     // Verify expanded size
     report = allocator.report();
     size_t expanded_free_space = report.totalFreeSpace;
-    EXPECT_GE(expanded_free_space, EXPAND_SIZE - 16); // Allow for small overhead
+    EXPECT_GE(expanded_free_space, EXPAND_SIZE - dsa::TLSF<>::pool_overhead());
     EXPECT_LE(expanded_free_space, EXPAND_SIZE);
 
     // Allocate memory to ensure pool can't be resized when in use
@@ -571,7 +1068,7 @@ TEST_F(eAllocTest, DynamicPoolResizing)
     EXPECT_NE(ptr, nullptr);
 
     // Attempt to shrink while memory is allocated (should fail)
-    bool shrink_allocated_result = allocator.resize_pool(expanded_memory, SHRINK_SIZE - 100);
+    bool shrink_allocated_result = allocator.resize_pool(expanded_memory, POOL_HEAD + SHRINK_SIZE - 100);
     EXPECT_FALSE(shrink_allocated_result);
 
     // Free the allocated memory
@@ -583,8 +1080,8 @@ TEST_F(eAllocTest, DynamicPoolResizing)
 TEST_F(eAllocTest, OwnershipTagAllocationAndFree)
 {
     const size_t POOL_SIZE = 1024;
-    char memory[POOL_SIZE];
-    dsa::eAlloc allocator(memory, POOL_SIZE);
+    alignas(std::max_align_t) char memory[POOL_HEAD + POOL_SIZE];
+    dsa::eAlloc allocator(memory, sizeof(memory));
 
     // Set ownership tag for this 'thread' or 'task'
     uint32_t tag1 = 1001;
@@ -615,8 +1112,8 @@ TEST_F(eAllocTest, OwnershipTagAllocationAndFree)
 TEST_F(eAllocTest, OwnershipTagWithMultipleThreadsSimulation)
 {
     const size_t POOL_SIZE = 2048;
-    char memory[POOL_SIZE];
-    dsa::eAlloc allocator(memory, POOL_SIZE);
+    alignas(std::max_align_t) char memory[POOL_HEAD + POOL_SIZE];
+    dsa::eAlloc allocator(memory, sizeof(memory));
 
     // Simulate thread 1
     allocator.setOwnershipTag(2001);
@@ -639,4 +1136,407 @@ TEST_F(eAllocTest, OwnershipTagWithMultipleThreadsSimulation)
     allocator.setOwnershipTag(2003);
     allocator.free(ptr_t2_1); // Should log mismatch if checking enabled
 }
-#endif
\ No newline at end of file
+
+TEST_F(eAllocTest, OwnerTagCountersTrackLiveBytesAndPeak)
+{
+    ealloc.setOwnershipTag(7);
+    void* a = ealloc.malloc(100);
+    void* b = ealloc.malloc(200);
+    ealloc.setOwnershipTag(9);
+    void* c = ealloc.memalign(64, 50);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    ASSERT_NE(c, nullptr);
+    // The tag lives in the header, out of reach of the payload
+    memset(a, 0xFF, 100);
+    memset(c, 0xFF, 50);
+
+    dsa::eAlloc::OwnerStats seven = ealloc.owner_stats(7);
+    EXPECT_EQ(seven.live_blocks, 2u);
+    EXPECT_EQ(seven.live_bytes, ealloc.usable_size(a) + ealloc.usable_size(b));
+    EXPECT_EQ(ealloc.owner_stats(9).live_bytes, ealloc.usable_size(c));
+
+    const size_t a_bytes = ealloc.usable_size(a);
+    ealloc.free(a); // freed by another task: still uncharged from tag 7
+    seven = ealloc.owner_stats(7);
+    EXPECT_EQ(seven.live_blocks, 1u);
+    EXPECT_EQ(seven.live_bytes, ealloc.usable_size(b));
+    EXPECT_EQ(seven.peak_bytes, ealloc.usable_size(b) + a_bytes);
+    EXPECT_EQ(seven.allocations, 2u);
+    ealloc.reset_owner_peaks();
+    EXPECT_EQ(ealloc.owner_stats(7).peak_bytes, ealloc.usable_size(b));
+
+    // A reallocated block moves to the tag doing the realloc
+    void* grown = ealloc.realloc(b, 300);
+    ASSERT_NE(grown, nullptr);
+    EXPECT_EQ(ealloc.owner_stats(7).live_blocks, 0u);
+    EXPECT_EQ(ealloc.owner_stats(9).live_blocks, 2u);
+
+    struct Seen
+    {
+        size_t blocks = 0;
+        size_t tag9 = 0;
+    } seen;
+    const size_t outstanding = ealloc.leak_report(
+        [](void*, size_t, uint32_t tag, void* user) {
+            Seen* s = static_cast<Seen*>(user);
+            s->blocks++;
+            if(tag == 9) s->tag9++;
+        },
+        &seen);
+    EXPECT_EQ(outstanding, 2u);
+    EXPECT_EQ(seen.tag9, 2u);
+    EXPECT_EQ(ealloc.logLeakReport(1), 2u);
+
+    ealloc.free(grown);
+    ealloc.free(c);
+    EXPECT_EQ(ealloc.owner_stats(9).live_bytes, 0u);
+    EXPECT_EQ(ealloc.leak_report(nullptr, nullptr), 0u);
+    ealloc.setOwnershipTag(0);
+}
+
+TEST_F(eAllocTest, OwnerTagFollowsABlockMovedByCompact)
+{
+    ealloc.setOwnershipTag(7);
+    void* hole = ealloc.malloc(64);
+    ASSERT_NE(hole, nullptr);
+    ealloc.setOwnershipTag(9);
+    dsa::eAlloc::Handle handle = ealloc.allocate_handle(128);
+    ASSERT_NE(handle, dsa::eAlloc::INVALID_HANDLE);
+    ealloc.free(hole); // the hole's header keeps tag 7
+
+    EXPECT_GE(ealloc.compact(), 1u);
+    void* moved = ealloc.pin(handle);
+    EXPECT_EQ(moved, hole);
+    ealloc.unpin(handle);
+    uint32_t moved_tag = 0;
+    ealloc.leak_report(
+        [](void*, size_t, uint32_t tag, void* user) { *static_cast<uint32_t*>(user) = tag; },
+        &moved_tag);
+    EXPECT_EQ(moved_tag, 9u);
+
+    ealloc.free_handle(handle);
+    EXPECT_EQ(ealloc.owner_stats(9).live_blocks, 0u);
+    EXPECT_EQ(ealloc.owner_stats(9).live_bytes, 0u);
+    EXPECT_EQ(ealloc.owner_stats(7).live_blocks, 0u);
+    EXPECT_EQ(ealloc.owner_stats(7).live_bytes, 0u);
+    ealloc.setOwnershipTag(0);
+}
+
+TEST_F(eAllocTest, OwnerTagTableOverflowsIntoOneEntry)
+{
+    std::vector<void*> blocks;
+    for(uint32_t tag = 1; tag <= dsa::MAX_OWNER_TAGS + 3; ++tag)
+    {
+        ealloc.setOwnershipTag(tag);
+        blocks.push_back(ealloc.malloc(16));
+        ASSERT_NE(blocks.back(), nullptr);
+    }
+    std::vector<dsa::eAlloc::OwnerStats> report(dsa::MAX_OWNER_TAGS + 1);
+    ASSERT_EQ(ealloc.owner_report(report.data(), report.size()), dsa::MAX_OWNER_TAGS + 1);
+    EXPECT_TRUE(report.back().overflow);
+    EXPECT_EQ(report.back().live_blocks, 3u);
+    for(size_t i = 0; i < dsa::MAX_OWNER_TAGS; ++i) EXPECT_EQ(report[i].live_blocks, 1u);
+
+    for(void* p : blocks) ealloc.free(p);
+    ealloc.owner_report(report.data(), report.size());
+    for(const dsa::eAlloc::OwnerStats& owner : report) EXPECT_EQ(owner.live_bytes, 0u);
+    ealloc.setOwnershipTag(0);
+}
+#endif
+
+#if EALLOC_ENABLE_CLASS_STATS
+TEST_F(eAllocTest, SizeClassStatsTrackWasteSplitsAndMerges)
+{
+    ealloc.reset_size_class_stats();
+    // 13 bytes round up to the alignment; the class keeps both figures
+    void* a = ealloc.malloc(13);
+    void* b = ealloc.malloc(13);
+    void* barrier = ealloc.malloc(64);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    const dsa::eAlloc::SizeClassStats small = ealloc.size_class_stats_for(ealloc.usable_size(a));
+    EXPECT_EQ(small.allocations, 2u);
+    EXPECT_EQ(small.live, 2u);
+    EXPECT_EQ(small.requested_bytes, 26u);
+    EXPECT_EQ(small.granted_bytes, 2 * ealloc.usable_size(a));
+    EXPECT_LE(small.min_size, ealloc.usable_size(a));
+
+    // Each allocation carved the wilderness: one split per malloc in the wilderness' classes
+    dsa::eAlloc::SizeClassStats classes[64];
+    const size_t active = ealloc.size_class_report(classes, 64);
+    ASSERT_LE(active, 64u);
+    size_t splits = 0, allocations = 0;
+    for(size_t i = 0; i < active; ++i)
+    {
+        splits += classes[i].splits;
+        allocations += classes[i].allocations;
+        if(i)
+        {
+            EXPECT_GT(classes[i].min_size, classes[i - 1].min_size);
+        }
+    }
+    EXPECT_EQ(splits, 3u);
+    EXPECT_EQ(allocations, 3u);
+
+    // Freeing b next to a free a merges them into one larger class
+    ealloc.free(a);
+    ealloc.free(b);
+    EXPECT_EQ(ealloc.size_class_stats_for(ealloc.usable_size(barrier)).live, 1u);
+    EXPECT_EQ(ealloc.size_class_stats(small.fl, small.sl).live, 0u);
+    size_t merges = 0;
+    for(size_t i = 0, n = ealloc.size_class_report(classes, 64); i < n; ++i) merges += classes[i].merges;
+    EXPECT_EQ(merges, 1u);
+
+    // Growing in place releases the old class and charges the new one
+    void* grown = ealloc.realloc(barrier, 300);
+    ASSERT_EQ(grown, barrier);
+    EXPECT_EQ(ealloc.size_class_stats_for(ealloc.usable_size(grown)).live, 1u);
+    ealloc.free(grown);
+    for(size_t i = 0, n = ealloc.size_class_report(classes, 64); i < n; ++i) EXPECT_EQ(classes[i].live, 0u);
+
+    ealloc.reset_size_class_stats();
+    EXPECT_EQ(ealloc.size_class_report(nullptr, 0), 0u);
+    EXPECT_EQ(ealloc.size_class_stats(dsa::eAlloc::size_class_count(), 0).allocations, 0u);
+}
+#endif
+
+#if defined(EALLOC_PC_HOST)
+TEST_F(eAllocTest, ConcurrentMallocFreeUnderGlobalLock)
+{
+    constexpr int THREADS = 4;
+    constexpr int ITERATIONS = 5000;
+    std::atomic<int> corrupted{0};
+    auto worker = [&](int id) {
+        for(int i = 0; i < ITERATIONS; ++i)
+        {
+            const size_t size = 16 + static_cast<size_t>((i * 7 + id * 13) % 112);
+            uint8_t* p = static_cast<uint8_t*>(ealloc.malloc(size));
+            if(!p) continue;
+            memset(p, id, size);
+            for(size_t b = 0; b < size; ++b)
+                if(p[b] != id) corrupted++;
+            p = static_cast<uint8_t*>(ealloc.realloc(p, size * 2));
+            if(p && p[0] != id) corrupted++;
+            ealloc.free(p);
+        }
+    };
+    std::vector<std::thread> threads;
+    for(int t = 0; t < THREADS; ++t) threads.emplace_back(worker, t + 1);
+    for(std::thread& t : threads) t.join();
+
+    EXPECT_EQ(corrupted.load(), 0);
+    EXPECT_EQ(ealloc.check(), 0);
+    // Everything was returned, so the pool is one free block again
+    EXPECT_EQ(ealloc.report(dsa::eAlloc::ReportMode::EXACT).freeBlockCount, 1u);
+}
+TEST(eAllocGlobalLockTest, FreeRacesAddAndRemovePool)
+{
+    // Enough pools, each hosting its own control, to move the registry out of the inline slots
+    constexpr size_t EXTRA = 6;
+    alignas(16) static uint8_t base[16384];
+    alignas(16) static uint8_t extra[EXTRA][32768];
+    static std::timed_mutex raw;
+    static elock::StdMutex lock(raw);
+    dsa::eAlloc heap(base, sizeof(base));
+    heap.setLock(&lock);
+
+    std::atomic<bool> done{false};
+    std::atomic<int> corrupted{0};
+    auto churn = [&](int id) {
+        void* held[8] = {};
+        for(int i = 0; !done.load(); ++i)
+        {
+            void*& slot = held[i % 8];
+            heap.free(slot);
+            const size_t size = 16 + static_cast<size_t>((i * 13 + id * 7) % 300);
+            uint8_t* p = static_cast<uint8_t*>(heap.malloc(size));
+            slot = p;
+            if(!p) continue;
+            memset(p, id, size);
+            for(size_t b = 0; b < size; ++b)
+                if(p[b] != id) corrupted++;
+        }
+        for(void* p : held) heap.free(p);
+    };
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 2; ++t) threads.emplace_back(churn, t + 1);
+
+    // Removing the first pools moves the last records into their slots, renumbering live pools
+    for(int round = 0; round < 300; ++round)
+    {
+        // A pool still holding blocks survives remove_pool() and must not be added twice
+        for(size_t i = 0; i < EXTRA; ++i)
+            if(!heap.get_pool(extra[i]))
+                heap.add_pool(extra[i], sizeof(extra[i]), dsa::eAlloc::PoolConfig(5));
+        for(size_t i = 0; i < EXTRA; ++i) heap.remove_pool(extra[i]);
+    }
+    done = true;
+    for(std::thread& t : threads) t.join();
+    for(size_t i = 0; i < EXTRA; ++i) heap.remove_pool(extra[i]);
+
+    EXPECT_EQ(corrupted.load(), 0);
+    EXPECT_EQ(heap.check(), 0);
+    EXPECT_EQ(heap.get_pool_count(), 1u);
+}
+
+TEST(eAllocPerPoolLockTest, ConcurrentMallocReallocFreeAcrossPools)
+{
+    alignas(16) static uint8_t first[POOL_HEAD + 4096];
+    alignas(16) static uint8_t second[POOL_HEAD + 4096];
+    static std::timed_mutex first_raw, second_raw;
+    static elock::StdMutex first_lock(first_raw), second_lock(second_raw);
+    dsa::eAlloc heap(first, sizeof(first));
+    heap.setLockForPool(0, &first_lock);
+    heap.setLockForPool(1, &second_lock);
+    ASSERT_NE(heap.add_pool(second, sizeof(second)), nullptr);
+    heap.setPerPoolLocking(true);
+
+    constexpr int THREADS = 4;
+    constexpr int ITERATIONS = 5000;
+    std::atomic<int> corrupted{0};
+    auto worker = [&](int id) {
+        void* held[4] = {};
+        for(int i = 0; i < ITERATIONS; ++i)
+        {
+            // Keep a few blocks live so the first pool fills up and the second is used too
+            const size_t size = 16 + static_cast<size_t>((i * 7 + id * 13) % 240);
+            void*& slot = held[i % 4];
+            heap.free(slot);
+            uint8_t* p = static_cast<uint8_t*>(heap.malloc(size));
+            slot = p;
+            if(!p) continue;
+            memset(p, id, size);
+            p = static_cast<uint8_t*>(heap.realloc(p, size + 64));
+            if(!p) continue;
+            slot = p;
+            for(size_t b = 0; b < size; ++b)
+                if(p[b] != id) corrupted++;
+        }
+        for(void* p : held) heap.free(p);
+    };
+    std::vector<std::thread> threads;
+    for(int t = 0; t < THREADS; ++t) threads.emplace_back(worker, t + 1);
+    for(std::thread& t : threads) t.join();
+
+    EXPECT_EQ(corrupted.load(), 0);
+    EXPECT_EQ(heap.check(), 0);
+    EXPECT_EQ(heap.report(dsa::eAlloc::ReportMode::EXACT).freeBlockCount, 2u);
+}
+
+TEST(eAllocPerPoolLockTest, RoundRobinPlacementAcrossThreads)
+{
+    alignas(16) static uint8_t first[POOL_HEAD + 8192];
+    alignas(16) static uint8_t second[POOL_HEAD + 8192];
+    static std::timed_mutex first_raw, second_raw;
+    static elock::StdMutex first_lock(first_raw), second_lock(second_raw);
+    dsa::eAlloc heap(first, sizeof(first));
+    ASSERT_NE(heap.add_pool(second, sizeof(second)), nullptr);
+    heap.setLockForPool(0, &first_lock);
+    heap.setLockForPool(1, &second_lock);
+    heap.setPlacementStrategy(dsa::eAlloc::PlacementStrategy::ROUND_ROBIN);
+    heap.setPerPoolLocking(true);
+
+    std::atomic<int> in_second{0};
+    auto worker = [&]() {
+        for(int i = 0; i < 2000; ++i)
+        {
+            void* p = heap.malloc(32 + static_cast<size_t>(i % 64));
+            if(!p) continue;
+            if(heap.get_pool(p) == second) in_second++;
+            heap.free(p);
+        }
+    };
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 3; ++t) threads.emplace_back(worker);
+    for(std::thread& t : threads) t.join();
+
+    EXPECT_GT(in_second.load(), 0);
+    EXPECT_EQ(heap.check(), 0);
+    EXPECT_EQ(heap.report(dsa::eAlloc::ReportMode::EXACT).freeBlockCount, 2u);
+}
+
+TEST(eAllocPerPoolLockTest, PoolSetIsFixedWhilePerPoolLockingIsOn)
+{
+    alignas(16) static uint8_t first[POOL_HEAD + 4096];
+    alignas(16) static uint8_t second[POOL_HEAD + 4096];
+    dsa::eAlloc heap(first, sizeof(first));
+    heap.setPerPoolLocking(true);
+    EXPECT_EQ(heap.add_pool(second, sizeof(second)), nullptr);
+    EXPECT_FALSE(heap.resize_pool(first, 2048));
+    heap.remove_pool(first);
+    EXPECT_EQ(heap.get_pool_count(), 1u);
+
+    heap.setPerPoolLocking(false);
+    EXPECT_EQ(heap.add_pool(second, sizeof(second)), second);
+    heap.remove_pool(second);
+    EXPECT_EQ(heap.get_pool_count(), 1u);
+}
+
+TEST(eAllocPerPoolLockTest, CompactRunsAgainstPerPoolMallocFree)
+{
+    alignas(16) static uint8_t first[POOL_HEAD + 16384];
+    alignas(16) static uint8_t second[POOL_HEAD + 16384];
+    static std::timed_mutex global_raw, first_raw, second_raw;
+    static elock::StdMutex global_lock(global_raw), first_lock(first_raw), second_lock(second_raw);
+    dsa::eAlloc heap(first, sizeof(first));
+    ASSERT_NE(heap.add_pool(second, sizeof(second)), nullptr);
+    heap.setLock(&global_lock);
+    heap.setLockForPool(0, &first_lock);
+    heap.setLockForPool(1, &second_lock);
+    heap.setPerPoolLocking(true);
+
+    constexpr int ITERATIONS = 2000;
+    std::atomic<bool> done{false};
+    std::atomic<int> corrupted{0};
+    auto churn = [&](int id) {
+        void* held[8] = {};
+        for(int i = 0; !done.load(); ++i)
+        {
+            void*& slot = held[i % 8];
+            heap.free(slot);
+            const size_t size = 16 + static_cast<size_t>((i * 11 + id * 5) % 200);
+            uint8_t* p = static_cast<uint8_t*>(heap.malloc(size));
+            slot = p;
+            if(!p) continue;
+            memset(p, id, size);
+            for(size_t b = 0; b < size; ++b)
+                if(p[b] != id) corrupted++;
+        }
+        for(void* p : held) heap.free(p);
+    };
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 2; ++t) threads.emplace_back(churn, t + 1);
+
+    // Handles are freed out of order so compact() always finds holes to close
+    dsa::eAlloc::Handle handles[4];
+    for(int i = 0; i < ITERATIONS; ++i)
+    {
+        for(int h = 0; h < 4; ++h)
+        {
+            handles[h] = heap.allocate_handle(48);
+            if(handles[h] == dsa::eAlloc::INVALID_HANDLE) continue;
+            memset(heap.pin(handles[h]), 0x40 + h, 48);
+            heap.unpin(handles[h]);
+        }
+        for(int h = 0; h < 4; h += 2)
+            if(handles[h] != dsa::eAlloc::INVALID_HANDLE) heap.free_handle(handles[h]);
+        heap.compact();
+        for(int h = 1; h < 4; h += 2)
+        {
+            if(handles[h] == dsa::eAlloc::INVALID_HANDLE) continue;
+            const uint8_t* p = static_cast<const uint8_t*>(heap.pin(handles[h]));
+            for(size_t b = 0; b < 48; ++b)
+                if(p[b] != 0x40 + h) corrupted++;
+            heap.unpin(handles[h]);
+            heap.free_handle(handles[h]);
+        }
+    }
+    done = true;
+    for(std::thread& t : threads) t.join();
+
+    EXPECT_EQ(corrupted.load(), 0);
+    EXPECT_EQ(heap.check(), 0);
+    EXPECT_EQ(heap.report(dsa::eAlloc::ReportMode::EXACT).freeBlockCount, 2u);
+}
+#endif
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+#include "eAlloc.hpp"
+#include "eLog.hpp"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+void collect(const dsa::EventRecord& event, void* user)
+{
+    static_cast<std::vector<dsa::EventRecord>*>(user)->push_back(event);
+}
+
+} // namespace
+
+TEST(EventLogTest, DrainsEventsInOrder)
+{
+    auto log = std::make_unique<dsa::EventLog>();
+    log->record(dsa::EventId::DOUBLE_FREE, 0x10, 0, 0);
+    log->record(dsa::EventId::ALLOC_TAGGED, 0x20, 7, 0);
+
+    std::vector<dsa::EventRecord> events;
+    EXPECT_EQ(log->drain(collect, &events), 2u);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].id, dsa::EventId::DOUBLE_FREE);
+    EXPECT_EQ(events[0].args[0], 0x10u);
+    EXPECT_EQ(events[1].id, dsa::EventId::ALLOC_TAGGED);
+    EXPECT_EQ(events[1].args[1], 7u);
+    EXPECT_EQ(log->drain(collect, &events), 0u);
+}
+
+TEST(EventLogTest, FullRingDropsNewEvents)
+{
+    auto log = std::make_unique<dsa::EventLog>();
+    for(size_t i = 0; i < dsa::EVENT_LOG_CAPACITY; ++i)
+        EXPECT_TRUE(log->record(dsa::EventId::LOCK_TAKEN, i, 0, 0));
+    EXPECT_FALSE(log->record(dsa::EventId::LOCK_TAKEN, 999, 0, 0));
+    EXPECT_EQ(log->dropped(), 1u);
+
+    std::vector<dsa::EventRecord> events;
+    EXPECT_EQ(log->drain(collect, &events), dsa::EVENT_LOG_CAPACITY);
+    EXPECT_EQ(events.back().args[0], dsa::EVENT_LOG_CAPACITY - 1);
+    EXPECT_TRUE(log->record(dsa::EventId::LOCK_TAKEN, 1, 0, 0)); // room again after the drain
+}
+
+TEST(EventLogTest, FormatsMessagesOnDemand)
+{
+    dsa::EventRecord event{{0x1234, 3, 5}, dsa::EventId::OWNER_TAG_MISMATCH};
+    char line[128];
+    const size_t n = dsa::EventLog::format(event, line, sizeof(line));
+    EXPECT_EQ(n, std::string(line).size());
+    EXPECT_NE(std::string(line).find("mismatched owner tag 3 (expected 5)"), std::string::npos);
+}
+
+TEST(EventLogTest, ConcurrentProducersLoseNothingThatFits)
+{
+    auto log = std::make_unique<dsa::EventLog>();
+    const size_t per_thread = dsa::EVENT_LOG_CAPACITY / 4;
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < 4; ++t)
+        threads.emplace_back([&log, t, per_thread] {
+            for(size_t i = 0; i < per_thread; ++i) log->record(dsa::EventId::LOCK_TAKEN, t, i, 0);
+        });
+    for(std::thread& th : threads) th.join();
+
+    std::vector<dsa::EventRecord> events;
+    EXPECT_EQ(log->drain(collect, &events), 4 * per_thread);
+    EXPECT_EQ(log->dropped(), 0u);
+    size_t next[4] = {};
+    for(const dsa::EventRecord& e : events)
+    {
+        ASSERT_LT(e.args[0], 4u);
+        EXPECT_EQ(e.args[1], next[e.args[0]]++); // each producer's events stay in order
+    }
+}
+
+#if EALLOC_LOG_LEVEL >= EALLOC_LOG_LEVEL_ERROR
+TEST(EventLogTest, DoubleFreeIsRecordedNotFormatted)
+{
+    alignas(16) static uint8_t pool[dsa::eAlloc::pool_control_bytes() + 4096];
+    dsa::eAlloc heap(pool, sizeof(pool));
+    dsa::event_log().drain(nullptr, nullptr);
+
+    void* a = heap.malloc(64);
+    heap.malloc(64); // keeps a's block from merging away
+    heap.free(a);
+    heap.free(a);
+
+    std::vector<dsa::EventRecord> events;
+    dsa::event_log().drain(collect, &events);
+    size_t double_frees = 0;
+    for(const dsa::EventRecord& e : events)
+        if(e.id == dsa::EventId::DOUBLE_FREE && e.args[0] == reinterpret_cast<uintptr_t>(a)) double_frees++;
+    EXPECT_EQ(double_frees, 1u);
+}
+#endif
@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+#include "eAlloc.hpp"
+#include "eObserver.hpp"
+#include <type_traits>
+
+static_assert(std::is_empty<dsa::NullObserver>::value, "the default observer must carry no state");
+
+TEST(ObserverTest, CountingObserverSeesEveryEvent)
+{
+    using Counting = dsa::CountingObserver;
+    if(!std::is_same<dsa::eAlloc::Observer, Counting>::value)
+        GTEST_SKIP() << "build with -DEALLOC_OBSERVER=dsa::CountingObserver";
+
+    Counting::reset();
+    alignas(16) static uint8_t first[dsa::eAlloc::pool_control_bytes() + 4096];
+    alignas(16) static uint8_t second[dsa::eAlloc::pool_control_bytes() + 4096];
+    dsa::eAlloc heap(first, sizeof(first));
+    heap.add_pool(second, sizeof(second));
+    EXPECT_EQ(Counting::pools_added.load(), 2u);
+
+    void* a = heap.malloc(100);
+    void* b = heap.calloc(4, 8);
+    void* c = heap.memalign(64, 40);
+    void* d = heap.realloc(a, 300);
+    EXPECT_EQ(Counting::mallocs.load(), 3u);
+    EXPECT_EQ(Counting::reallocs.load(), 1u);
+    EXPECT_EQ(Counting::requested_bytes.load(), 100u + 32u + 40u + 300u);
+
+    EXPECT_EQ(heap.malloc(1 << 20), nullptr);
+    EXPECT_EQ(Counting::failures.load(), 1u);
+    EXPECT_EQ(Counting::mallocs.load(), 3u);
+
+    heap.free(b);
+    heap.free(c);
+    heap.free(d);
+    int foreign;
+    heap.free(&foreign); // not ours: not reported
+    EXPECT_EQ(Counting::frees.load(), 3u);
+}
@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+#include "eAlloc.hpp"
+#include "eProfiler.hpp"
+#include <memory>
+#include <string>
+
+namespace
+{
+
+// Fake call sites: the unwinder reports whichever stack the test selected
+void* current_site[2] = {reinterpret_cast<void*>(0x1000), reinterpret_cast<void*>(0x2000)};
+
+size_t fake_unwinder(void** frames, size_t max)
+{
+    const size_t depth = max < 2 ? max : 2;
+    for(size_t i = 0; i < depth; ++i) frames[i] = current_site[i];
+    return depth;
+}
+
+void select_site(uintptr_t inner)
+{
+    current_site[0] = reinterpret_cast<void*>(inner);
+}
+
+void append(const char* text, size_t bytes, void* user)
+{
+    static_cast<std::string*>(user)->append(text, bytes);
+}
+
+const dsa::HeapProfiler::Site* find_site(const dsa::HeapProfiler& profiler, uintptr_t inner)
+{
+    for(size_t i = 0; i < profiler.site_count(); ++i)
+        if(profiler.site(i).frames[0] == reinterpret_cast<void*>(inner)) return &profiler.site(i);
+    return nullptr;
+}
+
+void* addr(uintptr_t value) { return reinterpret_cast<void*>(value); }
+
+} // namespace
+
+TEST(HeapProfilerTest, ChargesAndUnchargesCallSites)
+{
+    auto profiler = std::make_unique<dsa::HeapProfiler>(1, fake_unwinder); // sample everything
+    select_site(0x1000);
+    profiler->on_alloc(addr(0x10), 100);
+    profiler->on_alloc(addr(0x20), 50);
+    select_site(0x1100);
+    profiler->on_alloc(addr(0x30), 1000);
+    ASSERT_EQ(profiler->site_count(), 2u);
+
+    const dsa::HeapProfiler::Site* a = find_site(*profiler, 0x1000);
+    const dsa::HeapProfiler::Site* b = find_site(*profiler, 0x1100);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(a->depth, 2u);
+    EXPECT_EQ(a->live_samples, 2u);
+    EXPECT_EQ(a->live_bytes, 150u);
+    EXPECT_EQ(b->live_bytes, 1000u);
+
+    profiler->on_free(addr(0x10));
+    profiler->on_free(addr(0x40)); // never sampled: ignored
+    EXPECT_EQ(a->live_samples, 1u);
+    EXPECT_EQ(a->live_bytes, 50u);
+    EXPECT_EQ(a->alloc_samples, 2u);
+    EXPECT_EQ(a->alloc_bytes, 150u);
+    EXPECT_NEAR(a->live_estimate, 50.0, 1e-6); // weight 1 when every byte triggers a sample
+}
+
+TEST(HeapProfilerTest, PoissonEstimateIsUnbiased)
+{
+    auto profiler = std::make_unique<dsa::HeapProfiler>(4096, fake_unwinder, 42);
+    select_site(0x1000);
+    const size_t blocks = 200000;
+    for(size_t i = 0; i < blocks; ++i) profiler->on_alloc(addr(16 * (i + 1)), 64);
+    const dsa::HeapProfiler::Site* site = find_site(*profiler, 0x1000);
+    ASSERT_NE(site, nullptr);
+
+    const double truth = 64.0 * blocks;
+    EXPECT_NEAR(site->alloc_estimate, truth, truth * 0.1);
+    // Roughly one sample per 4 KiB allocated
+    EXPECT_NEAR(static_cast<double>(site->alloc_samples), truth / 4096, truth / 4096 * 0.2);
+}
+
+TEST(HeapProfilerTest, SideTableSurvivesChurn)
+{
+    auto profiler = std::make_unique<dsa::HeapProfiler>(1, fake_unwinder);
+    select_site(0x1000);
+    // Addresses sharing low bits collide in the table; removal must keep probe chains intact
+    for(uintptr_t i = 1; i <= 600; ++i) profiler->on_alloc(addr(i << 12), 8);
+    for(uintptr_t i = 1; i <= 600; i += 2) profiler->on_free(addr(i << 12));
+    for(uintptr_t i = 2; i <= 600; i += 2) profiler->on_free(addr(i << 12));
+    const dsa::HeapProfiler::Site* site = find_site(*profiler, 0x1000);
+    ASSERT_NE(site, nullptr);
+    EXPECT_EQ(site->live_samples, 0u);
+    EXPECT_EQ(site->live_bytes, 0u);
+    EXPECT_EQ(profiler->dropped(), 0u);
+}
+
+TEST(HeapProfilerTest, WritesTextAndPprofProfiles)
+{
+    auto profiler = std::make_unique<dsa::HeapProfiler>(1, fake_unwinder);
+    select_site(0x1000);
+    profiler->on_alloc(addr(0x10), 300);
+    select_site(0x1100);
+    profiler->on_alloc(addr(0x20), 700);
+    profiler->on_free(addr(0x10));
+
+    std::string pprof;
+    profiler->write_pprof(append, &pprof);
+    EXPECT_EQ(pprof.rfind("heap profile: 1: 700 [2: 1000] @ heap_v2/1\n", 0), 0u);
+    EXPECT_NE(pprof.find("0: 0 [1: 300] @ 0x1000 0x2000\n"), std::string::npos);
+    EXPECT_NE(pprof.find("1: 700 [1: 700] @ 0x1100 0x2000\n"), std::string::npos);
+
+    std::string text;
+    profiler->write_text(append, &text);
+    // The site still holding memory is listed first
+    const size_t heavy = text.find("0x1100");
+    ASSERT_NE(heavy, std::string::npos);
+    EXPECT_LT(heavy, text.find("0x1000 "));
+}
+
+#if EALLOC_ENABLE_PROFILER
+TEST(HeapProfilerTest, AllocatorReportsLiveSamples)
+{
+    alignas(16) static uint8_t pool[dsa::eAlloc::pool_control_bytes() + 16384];
+    dsa::eAlloc heap(pool, sizeof(pool));
+    auto profiler = std::make_unique<dsa::HeapProfiler>(1, fake_unwinder);
+    heap.setHeapProfiler(profiler.get());
+    select_site(0x1000);
+
+    void* a = heap.malloc(100);
+    void* b = heap.realloc(heap.malloc(10), 200);
+    heap.free(a);
+    const dsa::HeapProfiler::Site* site = find_site(*profiler, 0x1000);
+    ASSERT_NE(site, nullptr);
+    EXPECT_EQ(site->live_bytes, 200u);
+    EXPECT_EQ(site->alloc_samples, 3u);
+    heap.free(b);
+    EXPECT_EQ(site->live_bytes, 0u);
+    heap.setHeapProfiler(nullptr);
+}
+#endif
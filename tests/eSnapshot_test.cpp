@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+#include "eAlloc.hpp"
+#include "eSnapshot.hpp"
+#include <vector>
+
+namespace
+{
+
+void append(const void* data, size_t bytes, void* user)
+{
+    auto* out = static_cast<std::vector<uint8_t>*>(user);
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    out->insert(out->end(), p, p + bytes);
+}
+
+struct WalkedBlock
+{
+    char* ptr;
+    size_t size;
+    bool used;
+};
+
+void collect(void* ptr, size_t size, int used, void* user)
+{
+    static_cast<std::vector<WalkedBlock>*>(user)->push_back({static_cast<char*>(ptr), size, used != 0});
+}
+
+} // namespace
+
+TEST(SnapshotTest, MatchesTheBlockWalkOfEveryPool)
+{
+    alignas(16) static uint8_t first[dsa::eAlloc::pool_control_bytes() + 8192];
+    alignas(16) static uint8_t second[dsa::eAlloc::pool_control_bytes() + 4096];
+    dsa::eAlloc heap(first, sizeof(first));
+    void* second_pool = heap.add_pool(second, sizeof(second));
+    ASSERT_NE(second_pool, nullptr);
+
+    std::vector<void*> blocks;
+    for(size_t i = 0; i < 40; ++i) blocks.push_back(heap.malloc(24 + 40 * (i % 5)));
+    for(size_t i = 0; i < blocks.size(); i += 3) heap.free(blocks[i]); // punch holes
+
+    std::vector<uint8_t> bytes;
+    const size_t produced = heap.snapshot(append, &bytes);
+    EXPECT_EQ(produced, bytes.size());
+    EXPECT_LT(bytes.size(), 2 * blocks.size() + 64); // a few bytes per block
+
+    dsa::SnapshotReader reader(bytes.data(), bytes.size());
+    ASSERT_TRUE(reader.ok());
+    size_t pools = 0;
+    for(dsa::SnapshotPool pool; reader.next_pool(pool);)
+    {
+        ASSERT_EQ(pool.index, pools);
+        std::vector<WalkedBlock> walked;
+        heap.walk_pool(pool.index == 0 ? static_cast<void*>(first) : static_cast<void*>(second),
+                       collect, &walked);
+        size_t n = 0;
+        for(dsa::SnapshotBlock block; reader.next_block(block); ++n)
+        {
+            ASSERT_LT(n, walked.size());
+            EXPECT_EQ(reinterpret_cast<char*>(pool.address) + block.offset, walked[n].ptr);
+            EXPECT_EQ(block.size, walked[n].size);
+            EXPECT_EQ(block.used, walked[n].used);
+        }
+        EXPECT_EQ(n, walked.size());
+        pools++;
+    }
+    EXPECT_TRUE(reader.ok());
+    EXPECT_EQ(pools, 2u);
+
+    for(size_t i = 0; i < blocks.size(); ++i)
+        if(i % 3) heap.free(blocks[i]);
+}
+
+TEST(SnapshotTest, PoolsCanBeSkipped)
+{
+    alignas(16) static uint8_t first[dsa::eAlloc::pool_control_bytes() + 4096];
+    alignas(16) static uint8_t second[dsa::eAlloc::pool_control_bytes() + 4096];
+    dsa::eAlloc heap(first, sizeof(first));
+    heap.add_pool(second, sizeof(second));
+    void* a = heap.malloc(100);
+
+    std::vector<uint8_t> bytes;
+    heap.snapshot(append, &bytes);
+    dsa::SnapshotReader reader(bytes.data(), bytes.size());
+    dsa::SnapshotPool pool;
+    ASSERT_TRUE(reader.next_pool(pool)); // blocks left unread
+    ASSERT_TRUE(reader.next_pool(pool));
+    EXPECT_EQ(pool.index, 1u);
+    dsa::SnapshotBlock block;
+    ASSERT_TRUE(reader.next_block(block));
+    EXPECT_FALSE(block.used);
+    EXPECT_FALSE(reader.next_pool(pool));
+    EXPECT_TRUE(reader.ok());
+    heap.free(a);
+}
+
+TEST(SnapshotTest, RejectsTruncatedData)
+{
+    alignas(16) static uint8_t pool[dsa::eAlloc::pool_control_bytes() + 4096];
+    dsa::eAlloc heap(pool, sizeof(pool));
+    void* a = heap.malloc(100);
+    std::vector<uint8_t> bytes;
+    heap.snapshot(append, &bytes);
+    heap.free(a);
+
+    bytes.pop_back(); // drop the end-of-pool marker
+    dsa::SnapshotReader reader(bytes.data(), bytes.size());
+    dsa::SnapshotPool p;
+    ASSERT_TRUE(reader.next_pool(p));
+    for(dsa::SnapshotBlock block; reader.next_block(block);) {}
+    EXPECT_FALSE(reader.ok());
+
+    const uint8_t junk[] = {'E', 'A', 'T', 'R', 1};
+    EXPECT_FALSE(dsa::SnapshotReader(junk, sizeof(junk)).ok());
+}
@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+#include "eAlloc.hpp"
+#if defined(__linux__)
+    #include "eStatsExport.hpp"
+    #include <mutex>
+    #include <stdio.h>
+
+namespace
+{
+
+bool attach(dsa::StatsReader& reader, const dsa::StatsExporter& exporter)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", exporter.fd());
+    return reader.attach_path(path);
+}
+
+} // namespace
+
+TEST(StatsExportTest, PublishesPoolCounters)
+{
+    alignas(16) static uint8_t first[dsa::eAlloc::pool_control_bytes() + 4096];
+    alignas(16) static uint8_t second[dsa::eAlloc::pool_control_bytes() + 2048];
+    dsa::eAlloc heap(first, sizeof(first));
+    heap.add_pool(second, sizeof(second));
+
+    dsa::StatsExporter exporter(heap);
+    ASSERT_TRUE(exporter.create_anonymous());
+    dsa::StatsReader reader;
+    ASSERT_TRUE(attach(reader, exporter));
+
+    void* a = heap.malloc(500);
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(heap.malloc(100000), nullptr);
+    exporter.publish();
+
+    dsa::StatsSample sample;
+    ASSERT_TRUE(reader.read(sample));
+    EXPECT_EQ(sample.publishes, 1u);
+    EXPECT_EQ(sample.pid, static_cast<uint32_t>(getpid()));
+    ASSERT_EQ(sample.pool_count, 2u);
+    ASSERT_EQ(sample.published_pools(), 2u);
+    dsa::eAlloc::PoolStats expected[2];
+    heap.pool_report(expected, 2);
+    for(size_t i = 0; i < 2; ++i)
+    {
+        EXPECT_EQ(sample.pools[i].memory, reinterpret_cast<uintptr_t>(expected[i].memory));
+        EXPECT_EQ(sample.pools[i].in_use, expected[i].in_use);
+        EXPECT_EQ(sample.pools[i].peak_in_use, expected[i].peak_in_use);
+        EXPECT_EQ(sample.pools[i].allocations, expected[i].allocations);
+        EXPECT_EQ(sample.pools[i].failures, expected[i].failures);
+    }
+    EXPECT_EQ(sample.class_stats, EALLOC_ENABLE_CLASS_STATS != 0);
+    #if EALLOC_ENABLE_CLASS_STATS
+    const dsa::eAlloc::SizeClassStats cls = heap.size_class_stats_for(500);
+    EXPECT_EQ(sample.classes[cls.fl * dsa::TLSF<>::shelves() + cls.sl].live, cls.live);
+    #endif
+    heap.free(a);
+}
+
+TEST(StatsExportTest, NamedSegmentIsUnlinkedOnClose)
+{
+    alignas(16) static uint8_t pool[dsa::eAlloc::pool_control_bytes() + 2048];
+    dsa::eAlloc heap(pool, sizeof(pool));
+    char name[64];
+    snprintf(name, sizeof(name), "/ealloc-test.%d", static_cast<int>(getpid()));
+
+    dsa::StatsExporter exporter(heap);
+    ASSERT_TRUE(exporter.create(name));
+    exporter.publish();
+    dsa::StatsReader reader;
+    ASSERT_TRUE(reader.attach_shm(name));
+    dsa::StatsSample sample;
+    ASSERT_TRUE(reader.read(sample));
+    EXPECT_EQ(sample.publishes, 1u);
+
+    exporter.close();
+    ASSERT_TRUE(reader.read(sample)); // an attached viewer keeps its mapping
+    dsa::StatsReader late;
+    EXPECT_FALSE(late.attach_shm(name));
+}
+
+TEST(StatsExportTest, RejectsForeignSegments)
+{
+    dsa::StatsReader reader;
+    EXPECT_FALSE(reader.attach_path("/proc/self/status"));
+    EXPECT_FALSE(reader.attach_shm("/ealloc-stats-that-does-not-exist"));
+    EXPECT_FALSE(reader.attached());
+}
+
+TEST(StatsExportTest, BackgroundPublishingIsReadConsistently)
+{
+    alignas(16) static uint8_t pool[dsa::eAlloc::pool_control_bytes() + 8192];
+    static std::timed_mutex mutex;
+    static elock::StdMutex lock(mutex);
+    dsa::eAlloc heap(pool, sizeof(pool));
+    heap.setLock(&lock); // the exporter thread reads the counters under the allocator's lock
+    dsa::StatsExporter exporter(heap);
+    ASSERT_TRUE(exporter.create_anonymous());
+    dsa::StatsReader reader;
+    ASSERT_TRUE(attach(reader, exporter));
+    ASSERT_TRUE(exporter.start(1));
+
+    // The peak never drops below usage in any copy the reader accepts
+    dsa::StatsSample sample;
+    uint64_t seen = 0;
+    for(int round = 0; round < 200; ++round)
+    {
+        void* p = heap.malloc(64 + 16 * (round % 50));
+        ASSERT_TRUE(reader.read(sample));
+        EXPECT_GE(sample.pools[0].peak_in_use, sample.pools[0].in_use);
+        EXPECT_GE(sample.publishes, seen);
+        seen = sample.publishes;
+        heap.free(p);
+    }
+    exporter.stop();
+    ASSERT_TRUE(reader.read(sample));
+    EXPECT_GT(sample.publishes, 0u);
+    EXPECT_EQ(sample.pools[0].allocations, 200u);
+    EXPECT_EQ(sample.pools[0].in_use, heap.pool_stats(0).in_use);
+}
+#endif
@@ -0,0 +1,170 @@
+#include "gtest/gtest.h"
+#include "eAlloc.hpp"
+#include "eTrace.hpp"
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+uint64_t fake_now = 0;
+uint64_t fake_clock() { return fake_now; }
+uint32_t fake_thread() { return 7; }
+
+void append(const void* data, size_t bytes, void* user)
+{
+    auto* out = static_cast<std::vector<uint8_t>*>(user);
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    out->insert(out->end(), p, p + bytes);
+}
+
+std::vector<dsa::TraceEvent> decode(const std::vector<uint8_t>& log)
+{
+    std::vector<dsa::TraceEvent> events;
+    dsa::TraceReader reader(log.data(), log.size());
+    for(dsa::TraceEvent e; reader.next(e);) events.push_back(e);
+    EXPECT_TRUE(reader.ok());
+    return events;
+}
+
+void* addr(uintptr_t value) { return reinterpret_cast<void*>(value); }
+
+} // namespace
+
+TEST(TraceRecorderTest, RoundTripsEveryOperation)
+{
+    alignas(std::max_align_t) static uint8_t ring[64 * dsa::TraceRecorder::slot_size()];
+    dsa::TraceRecorder recorder(ring, sizeof(ring), fake_clock, fake_thread);
+    ASSERT_EQ(recorder.capacity(), 64u);
+
+    fake_now = 1000;
+    recorder.record(dsa::TraceOp::MALLOC, addr(0x10000), nullptr, 24, 0);
+    fake_now = 1500;
+    recorder.record(dsa::TraceOp::MEMALIGN, addr(0x10400), nullptr, 100, 256);
+    fake_now = 1400; // clocks of different threads need not be ordered
+    recorder.record(dsa::TraceOp::REALLOC, addr(0x8000), addr(0x10000), 4096, 0);
+    recorder.record(dsa::TraceOp::CALLOC, nullptr, nullptr, 1u << 20, 0);
+    recorder.record(dsa::TraceOp::FREE, addr(0x8000), nullptr, 0, 0);
+
+    std::vector<uint8_t> log;
+    EXPECT_EQ(recorder.drain(append, &log), 5u);
+    EXPECT_LT(log.size(), 5 * sizeof(dsa::TraceEvent) / 4); // varint deltas, not raw events
+
+    const std::vector<dsa::TraceEvent> events = decode(log);
+    ASSERT_EQ(events.size(), 5u);
+    EXPECT_EQ(events[0].op, dsa::TraceOp::MALLOC);
+    EXPECT_EQ(events[0].ptr, 0x10000u);
+    EXPECT_EQ(events[0].size, 24u);
+    EXPECT_EQ(events[0].timestamp, 1000u);
+    EXPECT_EQ(events[0].thread, 7u);
+    EXPECT_EQ(events[1].align, 256u);
+    EXPECT_EQ(events[2].timestamp, 1400u);
+    EXPECT_EQ(events[2].old_ptr, 0x10000u);
+    EXPECT_EQ(events[2].ptr, 0x8000u);
+    EXPECT_EQ(events[3].op, dsa::TraceOp::CALLOC);
+    EXPECT_EQ(events[3].ptr, 0u);
+    EXPECT_EQ(events[3].size, 1u << 20);
+    EXPECT_EQ(events[4].op, dsa::TraceOp::FREE);
+    EXPECT_EQ(events[4].ptr, 0x8000u);
+
+    // Later drains continue the same log without a second header
+    recorder.record(dsa::TraceOp::FREE, addr(0x10400), nullptr, 0, 0);
+    EXPECT_EQ(recorder.drain(append, &log), 1u);
+    EXPECT_EQ(decode(log).size(), 6u);
+}
+
+TEST(TraceRecorderTest, FullRingDropsInsteadOfBlocking)
+{
+    alignas(std::max_align_t) static uint8_t ring[4 * dsa::TraceRecorder::slot_size()];
+    dsa::TraceRecorder recorder(ring, sizeof(ring), fake_clock, fake_thread);
+    for(int i = 0; i < 6; ++i) recorder.record(dsa::TraceOp::MALLOC, addr(16 * (i + 1)), nullptr, 8, 0);
+    EXPECT_EQ(recorder.dropped(), 2u);
+
+    std::vector<uint8_t> log;
+    EXPECT_EQ(recorder.drain(append, &log), 4u);
+    EXPECT_TRUE(recorder.record(dsa::TraceOp::MALLOC, addr(4096), nullptr, 8, 0));
+}
+
+TEST(TraceRecorderTest, RejectsForeignData)
+{
+    const uint8_t junk[] = {'E', 'A', 'T', 'X', 1, 1, 0};
+    dsa::TraceReader reader(junk, sizeof(junk));
+    dsa::TraceEvent e;
+    EXPECT_FALSE(reader.next(e));
+    EXPECT_FALSE(reader.ok());
+}
+
+#if defined(EALLOC_PC_HOST)
+TEST(TraceRecorderTest, ConcurrentProducersLoseNothing)
+{
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 2000;
+    std::vector<uint8_t> ring(8192 * dsa::TraceRecorder::slot_size());
+    dsa::TraceRecorder recorder(ring.data(), ring.size());
+
+    std::vector<std::thread> workers;
+    for(int t = 0; t < THREADS; ++t)
+    {
+        workers.emplace_back([&recorder, t]() {
+            for(int i = 1; i <= PER_THREAD; ++i)
+                recorder.record(dsa::TraceOp::MALLOC, addr(i), nullptr, static_cast<size_t>(t), 0);
+        });
+    }
+    std::vector<uint8_t> log;
+    size_t drained = 0;
+    while(drained < size_t(THREADS) * PER_THREAD)
+    {
+        drained += recorder.drain(append, &log); // drain concurrently with the producers
+    }
+    for(std::thread& worker : workers) worker.join();
+    EXPECT_EQ(recorder.dropped(), 0u);
+
+    // Each producer's events arrive complete and in program order
+    uint64_t last[THREADS] = {};
+    for(const dsa::TraceEvent& e : decode(log))
+    {
+        ASSERT_LT(e.size, uint64_t(THREADS));
+        EXPECT_EQ(e.ptr, last[e.size] + 1);
+        last[e.size] = e.ptr;
+    }
+    for(int t = 0; t < THREADS; ++t) EXPECT_EQ(last[t], uint64_t(PER_THREAD));
+}
+#endif
+
+#if EALLOC_ENABLE_TRACE
+TEST(TraceRecorderTest, AllocatorRecordsItsCalls)
+{
+    alignas(16) static uint8_t pool[dsa::eAlloc::pool_control_bytes() + 8192];
+    alignas(std::max_align_t) static uint8_t ring[32 * dsa::TraceRecorder::slot_size()];
+    dsa::eAlloc heap(pool, sizeof(pool));
+    dsa::TraceRecorder recorder(ring, sizeof(ring));
+    heap.setTraceRecorder(&recorder);
+
+    void* a = heap.malloc(40);
+    void* b = heap.memalign(64, 32);
+    void* c = heap.realloc(a, 400);
+    void* d = heap.calloc(4, 8);
+    heap.free(b);
+    heap.free(c);
+    heap.free(d);
+    heap.setTraceRecorder(nullptr);
+    heap.free(heap.malloc(8)); // not recorded
+
+    std::vector<uint8_t> log;
+    recorder.drain(append, &log);
+    const std::vector<dsa::TraceEvent> events = decode(log);
+    ASSERT_EQ(events.size(), 7u);
+    EXPECT_EQ(events[0].op, dsa::TraceOp::MALLOC);
+    EXPECT_EQ(events[0].ptr, reinterpret_cast<uintptr_t>(a));
+    EXPECT_EQ(events[1].op, dsa::TraceOp::MEMALIGN);
+    EXPECT_EQ(events[1].align, 64u);
+    EXPECT_EQ(events[2].op, dsa::TraceOp::REALLOC);
+    EXPECT_EQ(events[2].old_ptr, reinterpret_cast<uintptr_t>(a));
+    EXPECT_EQ(events[2].ptr, reinterpret_cast<uintptr_t>(c));
+    EXPECT_EQ(events[3].op, dsa::TraceOp::CALLOC);
+    EXPECT_EQ(events[3].size, 32u);
+    EXPECT_EQ(events[6].op, dsa::TraceOp::FREE);
+    EXPECT_EQ(events[6].ptr, reinterpret_cast<uintptr_t>(d));
+}
+#endif
@@ -0,0 +1,259 @@
+/**
+ * @file ealloc_replay.cpp
+ * @brief Re-executes a recorded allocation trace (see eTrace.hpp) against an eAlloc build.
+ *
+ * Capture once in production:
+ *   static uint8_t ring[64 * 1024];
+ *   dsa::TraceRecorder recorder(ring, sizeof(ring));
+ *   heap.setTraceRecorder(&recorder);            // built with EALLOC_ENABLE_TRACE=1
+ *   ... periodically: recorder.drain(write_to_file, file);
+ *
+ * then replay offline, as often as needed:
+ *   ealloc_replay trace.eatr [--pool BYTES]... [--placement priority|fullest|least|round_robin]
+ *                            [--check]
+ *
+ * Events are replayed in log order on one thread; recorded addresses serve as block ids and are
+ * mapped to the blocks this run hands out. Runtime options pick the pool layout and placement;
+ * compile-time ones (EALLOC_MAX_SLI, EALLOC_ALIGN_EXP, EALLOC_FREE_LIST_ORDER) are fixed per
+ * binary, e.g. configure a second build directory with
+ *   -DCMAKE_CXX_FLAGS="-DEALLOC_MAX_SLI=4 -DEALLOC_ALIGN_EXP=3"
+ * and compare the outputs. The result is a single JSON object on stdout.
+ */
+#include "eAlloc.hpp"
+#include "eTrace.hpp"
+#include "bench_common.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+
+using Placement = dsa::eAlloc::PlacementStrategy;
+
+const char* order_name()
+{
+    switch(dsa::DEFAULT_FREE_LIST_ORDER)
+    {
+        case dsa::FreeListOrder::FIFO: return "FIFO";
+        case dsa::FreeListOrder::ADDRESS_ORDERED: return "ADDRESS_ORDERED";
+        default: return "LIFO";
+    }
+}
+
+bool read_file(const char* path, std::vector<uint8_t>& out)
+{
+    FILE* file = std::fopen(path, "rb");
+    if(!file) return false;
+    uint8_t chunk[1 << 16];
+    size_t n;
+    while((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) out.insert(out.end(), chunk, chunk + n);
+    std::fclose(file);
+    return true;
+}
+
+bool parse_placement(const char* name, Placement& out)
+{
+    const struct
+    {
+        const char* name;
+        Placement value;
+    } table[] = {{"priority", Placement::PRIORITY},
+                 {"fullest", Placement::FULLEST_FIRST},
+                 {"least", Placement::LEAST_LOADED},
+                 {"round_robin", Placement::ROUND_ROBIN}};
+    for(const auto& entry : table)
+    {
+        if(std::strcmp(name, entry.name) == 0)
+        {
+            out = entry.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+int usage()
+{
+    std::fprintf(stderr, "usage: ealloc_replay TRACE [--pool BYTES]... "
+                         "[--placement priority|fullest|least|round_robin] [--check]\n");
+    return 2;
+}
+
+/// Counters gathered while replaying.
+struct Stats
+{
+    size_t events = 0;
+    size_t failures = 0;          // replay failed where the recording succeeded
+    size_t recorded_failures = 0; // the recording itself failed
+    size_t unknown_blocks = 0;    // free/realloc of an address with no live block
+    size_t live = 0;
+    size_t live_bytes = 0;        // requested bytes currently allocated
+    size_t peak_live_bytes = 0;
+    size_t peak_heap_bytes = 0;   // pool bytes in use, overhead and fragmentation included
+    size_t check_errors = 0;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if(argc < 2) return usage();
+    const char* path = argv[1];
+    std::vector<size_t> pool_sizes;
+    Placement placement = Placement::PRIORITY;
+    bool check = false;
+    for(int i = 2; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--pool") == 0 && i + 1 < argc)
+            pool_sizes.push_back(std::strtoull(argv[++i], nullptr, 0));
+        else if(std::strcmp(argv[i], "--placement") == 0 && i + 1 < argc)
+        {
+            if(!parse_placement(argv[++i], placement)) return usage();
+        }
+        else if(std::strcmp(argv[i], "--check") == 0)
+            check = true;
+        else
+            return usage();
+    }
+    if(pool_sizes.empty()) pool_sizes.push_back(64u << 20);
+
+    std::vector<uint8_t> log;
+    if(!read_file(path, log))
+    {
+        std::perror(path);
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<uint8_t[]>> pools;
+    for(size_t bytes : pool_sizes) pools.emplace_back(new uint8_t[bytes]);
+    dsa::eAlloc heap(pools[0].get(), pool_sizes[0]);
+    for(size_t i = 1; i < pools.size(); ++i) heap.add_pool(pools[i].get(), pool_sizes[i]);
+    heap.setPlacementStrategy(placement);
+    size_t capacity = 0;
+    for(size_t bytes : pool_sizes) capacity += bytes;
+
+    struct Block
+    {
+        void* ptr;
+        size_t size;
+    };
+    std::unordered_map<uint64_t, Block> blocks; // recorded address -> replayed block
+    std::unordered_set<uint64_t> lost;          // recorded blocks this run failed to allocate
+    Stats stats;
+
+    auto take = [&](uint64_t id, Block& out) {
+        auto it = blocks.find(id);
+        if(it == blocks.end())
+        {
+            if(!lost.erase(id)) stats.unknown_blocks++;
+            return false;
+        }
+        out = it->second;
+        blocks.erase(it);
+        stats.live--;
+        stats.live_bytes -= out.size;
+        return true;
+    };
+    auto put = [&](const dsa::TraceEvent& e, void* ptr) {
+        if(!e.ptr)
+        {
+            // The recording failed; keep the heap as it was there
+            stats.recorded_failures++;
+            if(ptr) heap.free(ptr);
+            return;
+        }
+        if(!ptr)
+        {
+            stats.failures++;
+            lost.insert(e.ptr);
+            return;
+        }
+        blocks[e.ptr] = Block{ptr, static_cast<size_t>(e.size)};
+        stats.live++;
+        stats.live_bytes += static_cast<size_t>(e.size);
+    };
+
+    dsa::TraceReader reader(log.data(), log.size());
+    for(dsa::TraceEvent e; reader.next(e);)
+    {
+        stats.events++;
+        const size_t size = static_cast<size_t>(e.size);
+        switch(e.op)
+        {
+            case dsa::TraceOp::MALLOC: put(e, heap.malloc(size)); break;
+            case dsa::TraceOp::CALLOC: put(e, heap.calloc(1, size)); break;
+            case dsa::TraceOp::MEMALIGN:
+                put(e, heap.memalign(static_cast<size_t>(e.align), size));
+                break;
+            case dsa::TraceOp::FREE:
+            {
+                Block block;
+                if(take(e.ptr, block)) heap.free(block.ptr);
+                break;
+            }
+            case dsa::TraceOp::REALLOC:
+            {
+                Block block = {nullptr, 0};
+                if(e.old_ptr && !take(e.old_ptr, block))
+                {
+                    if(e.ptr && size) lost.insert(e.ptr); // carry the missing block to its new id
+                    break;
+                }
+                void* ptr = heap.realloc(block.ptr, size);
+                if(!size) break;
+                if(!e.ptr && block.ptr)
+                {
+                    // Recorded realloc failed and left the old block alive: keep it under its id
+                    stats.recorded_failures++;
+                    dsa::TraceEvent keep = e;
+                    keep.ptr = e.old_ptr;
+                    keep.size = ptr ? size : block.size;
+                    put(keep, ptr ? ptr : block.ptr);
+                    break;
+                }
+                if(!ptr && block.ptr)
+                {
+                    stats.failures++;
+                    dsa::TraceEvent keep = e;
+                    keep.size = block.size;
+                    put(keep, block.ptr); // the old block survives under the new id
+                    break;
+                }
+                put(e, ptr);
+                break;
+            }
+        }
+        if(stats.live_bytes > stats.peak_live_bytes) stats.peak_live_bytes = stats.live_bytes;
+        const size_t free_bytes = heap.report(dsa::eAlloc::ReportMode::FAST).totalFreeSpace;
+        if(capacity - free_bytes > stats.peak_heap_bytes) stats.peak_heap_bytes = capacity - free_bytes;
+        if(check && heap.check() != 0) stats.check_errors++;
+    }
+    const dsa::eAlloc::StorageReport sr = heap.report(dsa::eAlloc::ReportMode::EXACT);
+
+    bench::Result("replay")
+        .str("trace", path)
+        .str("trace_ok", reader.ok() ? "true" : "false")
+        .num("sli", dsa::MAX_SLI)
+        .num("align_exp", dsa::DEFAULT_ALIGN_EXP)
+        .str("free_list_order", order_name())
+        .num("pools", static_cast<double>(pool_sizes.size()))
+        .num("capacity", static_cast<double>(capacity))
+        .num("events", static_cast<double>(stats.events))
+        .num("failures", static_cast<double>(stats.failures))
+        .num("recorded_failures", static_cast<double>(stats.recorded_failures))
+        .num("unknown_blocks", static_cast<double>(stats.unknown_blocks))
+        .num("peak_live_bytes", static_cast<double>(stats.peak_live_bytes))
+        .num("peak_heap_bytes", static_cast<double>(stats.peak_heap_bytes))
+        .num("overhead_ratio", stats.peak_live_bytes
+                                   ? static_cast<double>(stats.peak_heap_bytes) / stats.peak_live_bytes
+                                   : 0.0)
+        .num("final_live_blocks", static_cast<double>(stats.live))
+        .num("final_fragmentation", sr.fragmentationFactor)
+        .num("check_errors", static_cast<double>(stats.check_errors));
+    return reader.ok() ? 0 : 1;
+}
@@ -0,0 +1,299 @@
+/**
+ * @file ealloc_snapshot.cpp
+ * @brief Offline viewer for heap snapshots written by eAlloc::snapshot() (see eSnapshot.hpp).
+ *
+ * Capture on the device, into RAM first so the pools are only locked for the walk:
+ *   heap.snapshot(append_to_buffer, &buffer);   ... later: write buffer to a file
+ *
+ * then inspect offline:
+ *   ealloc_snapshot [--width N] SNAPSHOT            fragmentation map, free-size distribution,
+ *                                                   owner tags
+ *   ealloc_snapshot [--width N] --diff OLD NEW      what changed between two snapshots
+ *
+ * Map legend: each column covers pool_size / N bytes; ' ' free, '.' under a third in use,
+ * '+' under two thirds, '#' above. In diff maps '+' marks columns that gained used bytes, '-'
+ * columns that lost some and '=' columns with the same usage.
+ */
+#include "eSnapshot.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct Pool
+{
+    dsa::SnapshotPool info;
+    std::vector<dsa::SnapshotBlock> blocks;
+};
+
+struct Snapshot
+{
+    std::vector<Pool> pools;
+    bool owner_tags = false;
+};
+
+/// Free-space figures of one pool, computed the way eAlloc::report() does.
+struct Summary
+{
+    size_t used_bytes = 0;
+    size_t used_blocks = 0;
+    size_t free_bytes = 0;
+    size_t free_blocks = 0;
+    size_t largest_free = 0;
+    double fragmentation = 0.0;
+};
+
+constexpr int BUCKETS = 33; // free blocks by floor(log2(size))
+
+bool load(const char* path, Snapshot& out)
+{
+    FILE* file = std::fopen(path, "rb");
+    if(!file)
+    {
+        std::perror(path);
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[1 << 16];
+    size_t n;
+    while((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) bytes.insert(bytes.end(), chunk, chunk + n);
+    std::fclose(file);
+
+    dsa::SnapshotReader reader(bytes.data(), bytes.size());
+    out.owner_tags = reader.has_owner_tags();
+    for(dsa::SnapshotPool info; reader.next_pool(info);)
+    {
+        Pool pool;
+        pool.info = info;
+        for(dsa::SnapshotBlock block; reader.next_block(block);) pool.blocks.push_back(block);
+        out.pools.push_back(pool);
+    }
+    if(!reader.ok()) std::fprintf(stderr, "%s: not a heap snapshot or truncated\n", path);
+    return reader.ok();
+}
+
+Summary summarize(const Pool& pool)
+{
+    Summary s;
+    for(const dsa::SnapshotBlock& b : pool.blocks)
+    {
+        const size_t size = static_cast<size_t>(b.size);
+        if(b.used)
+        {
+            s.used_bytes += size;
+            s.used_blocks++;
+        }
+        else
+        {
+            s.free_bytes += size;
+            s.free_blocks++;
+            if(size > s.largest_free) s.largest_free = size;
+        }
+    }
+    if(s.free_bytes) s.fragmentation = static_cast<double>(s.free_bytes - s.largest_free) / s.free_bytes;
+    return s;
+}
+
+/// Used bytes falling into each of @p width equal slices of the pool.
+std::vector<double> usage(const Pool& pool, size_t width)
+{
+    std::vector<double> columns(width, 0.0);
+    const double span = static_cast<double>(pool.info.size) / width;
+    for(const dsa::SnapshotBlock& b : pool.blocks)
+    {
+        if(!b.used) continue;
+        double begin = static_cast<double>(b.offset);
+        const double end = begin + static_cast<double>(b.size);
+        for(size_t c = static_cast<size_t>(begin / span); c < width && begin < end; ++c)
+        {
+            const double stop = (c + 1) * span < end ? (c + 1) * span : end;
+            columns[c] += stop - begin;
+            begin = stop;
+        }
+    }
+    return columns;
+}
+
+int bucket_of(uint64_t size)
+{
+    int b = 0;
+    while(size > 1 && b < BUCKETS - 1)
+    {
+        size >>= 1;
+        b++;
+    }
+    return b;
+}
+
+std::vector<size_t> free_histogram(const Pool& pool)
+{
+    std::vector<size_t> counts(BUCKETS, 0);
+    for(const dsa::SnapshotBlock& b : pool.blocks)
+        if(!b.used) counts[bucket_of(b.size)]++;
+    return counts;
+}
+
+void print_summary(const char* label, const Summary& s)
+{
+    std::printf("  %-6s used %zu B in %zu blocks, free %zu B in %zu blocks, largest free %zu B, "
+                "fragmentation %.3f\n",
+                label, s.used_bytes, s.used_blocks, s.free_bytes, s.free_blocks, s.largest_free,
+                s.fragmentation);
+}
+
+void print_map(const char* label, const std::string& map)
+{
+    std::printf("  %-6s |%s|\n", label, map.c_str());
+}
+
+void show(const Snapshot& snap, size_t width)
+{
+    for(const Pool& pool : snap.pools)
+    {
+        std::printf("pool %llu at 0x%llx, %llu bytes, %zu blocks\n",
+                    static_cast<unsigned long long>(pool.info.index),
+                    static_cast<unsigned long long>(pool.info.address),
+                    static_cast<unsigned long long>(pool.info.size), pool.blocks.size());
+        print_summary("", summarize(pool));
+
+        const double span = static_cast<double>(pool.info.size) / width;
+        std::string map;
+        for(double used : usage(pool, width))
+            map += used <= 0.0 ? ' ' : used < span / 3 ? '.' : used < 2 * span / 3 ? '+' : '#';
+        print_map("map", map);
+
+        std::printf("  free blocks by size:\n");
+        const std::vector<size_t> hist = free_histogram(pool);
+        for(int b = 0; b < BUCKETS; ++b)
+        {
+            if(!hist[b]) continue;
+            std::printf("    [%10llu, %10llu) %zu\n", 1ull << b, 2ull << b, hist[b]);
+        }
+
+        if(snap.owner_tags)
+        {
+            std::map<uint32_t, std::pair<size_t, size_t>> owners; // tag -> bytes, blocks
+            for(const dsa::SnapshotBlock& b : pool.blocks)
+            {
+                if(!b.used) continue;
+                owners[b.owner_tag].first += static_cast<size_t>(b.size);
+                owners[b.owner_tag].second++;
+            }
+            std::printf("  used bytes by owner tag:\n");
+            for(const auto& owner : owners)
+                std::printf("    %10u %zu B in %zu blocks\n", owner.first, owner.second.first,
+                            owner.second.second);
+        }
+    }
+}
+
+void diff(const Snapshot& before, const Snapshot& after, size_t width)
+{
+    const size_t pools = before.pools.size() > after.pools.size() ? before.pools.size()
+                                                                   : after.pools.size();
+    for(size_t i = 0; i < pools; ++i)
+    {
+        if(i >= before.pools.size() || i >= after.pools.size())
+        {
+            std::printf("pool %zu only in the %s snapshot\n", i, i >= before.pools.size() ? "new" : "old");
+            continue;
+        }
+        const Pool& a = before.pools[i];
+        const Pool& b = after.pools[i];
+        std::printf("pool %zu at 0x%llx, %llu bytes\n", i, static_cast<unsigned long long>(b.info.address),
+                    static_cast<unsigned long long>(b.info.size));
+        if(a.info.address != b.info.address || a.info.size != b.info.size)
+        {
+            std::printf("  pool moved or resized (was 0x%llx, %llu bytes); block comparison skipped\n",
+                        static_cast<unsigned long long>(a.info.address),
+                        static_cast<unsigned long long>(a.info.size));
+            continue;
+        }
+        print_summary("old", summarize(a));
+        print_summary("new", summarize(b));
+
+        // Used blocks are matched by offset and size
+        std::map<uint64_t, uint64_t> old_used;
+        for(const dsa::SnapshotBlock& blk : a.blocks)
+            if(blk.used) old_used[blk.offset] = blk.size;
+        size_t allocated = 0, allocated_bytes = 0, kept = 0;
+        for(const dsa::SnapshotBlock& blk : b.blocks)
+        {
+            if(!blk.used) continue;
+            auto it = old_used.find(blk.offset);
+            if(it != old_used.end() && it->second == blk.size)
+            {
+                kept++;
+                old_used.erase(it);
+                continue;
+            }
+            allocated++;
+            allocated_bytes += static_cast<size_t>(blk.size);
+        }
+        size_t freed_bytes = 0;
+        for(const auto& gone : old_used) freed_bytes += static_cast<size_t>(gone.second);
+        std::printf("  blocks kept %zu, new %zu (%zu B), gone %zu (%zu B)\n", kept, allocated,
+                    allocated_bytes, old_used.size(), freed_bytes);
+
+        const std::vector<double> ua = usage(a, width);
+        const std::vector<double> ub = usage(b, width);
+        std::string map;
+        for(size_t c = 0; c < width; ++c)
+            map += ub[c] > ua[c] ? '+' : ub[c] < ua[c] ? '-' : ub[c] > 0.0 ? '=' : ' ';
+        print_map("change", map);
+
+        std::printf("  free blocks by size (old -> new):\n");
+        const std::vector<size_t> ha = free_histogram(a);
+        const std::vector<size_t> hb = free_histogram(b);
+        for(int k = 0; k < BUCKETS; ++k)
+        {
+            if(!ha[k] && !hb[k]) continue;
+            std::printf("    [%10llu, %10llu) %zu -> %zu\n", 1ull << k, 2ull << k, ha[k], hb[k]);
+        }
+    }
+}
+
+int usage_error()
+{
+    std::fprintf(stderr, "usage: ealloc_snapshot [--width N] SNAPSHOT\n"
+                         "       ealloc_snapshot [--width N] --diff OLD NEW\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t width = 64;
+    bool diff_mode = false;
+    std::vector<const char*> files;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--width") == 0 && i + 1 < argc)
+            width = std::strtoull(argv[++i], nullptr, 0);
+        else if(std::strcmp(argv[i], "--diff") == 0)
+            diff_mode = true;
+        else if(argv[i][0] == '-')
+            return usage_error();
+        else
+            files.push_back(argv[i]);
+    }
+    if(!width || files.size() != (diff_mode ? 2u : 1u)) return usage_error();
+
+    Snapshot first;
+    if(!load(files[0], first)) return 1;
+    if(!diff_mode)
+    {
+        show(first, width);
+        return 0;
+    }
+    Snapshot second;
+    if(!load(files[1], second)) return 1;
+    diff(first, second, width);
+    return 0;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file ealloc_top.cpp
+ * @brief Live viewer for the statistics a process publishes with StatsExporter (eStatsExport.hpp).
+ *
+ * In the allocating process:
+ *   dsa::StatsExporter exporter(heap);
+ *   exporter.create("/ealloc.app");   // or create_anonymous(), then attach to /proc/PID/fd/FD
+ *   exporter.start(500);              // publish every 500 ms
+ *
+ * then, from any shell on the same host:
+ *   ealloc_top [--interval MS] [--count N] [--classes N] [--batch] /ealloc.app
+ *   ealloc_top ... --path /proc/PID/fd/FD
+ *
+ * Every interval the viewer takes a consistent copy of the segment and prints, per pool, usage,
+ * peak and allocation/failure rates since the previous copy, then the busiest size classes when
+ * the process was built with EALLOC_ENABLE_CLASS_STATS. Rates use the exporter's publish
+ * timestamps, so they stay correct when the viewer falls behind. Reading never blocks or locks
+ * the observed process.
+ */
+#include "eStatsExport.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Options
+{
+    unsigned interval_ms = 1000;
+    unsigned long count = 0; // frames to print; 0 runs until interrupted
+    size_t classes = 10;
+    bool batch = false;       // append frames instead of redrawing the screen
+    const char* shm_name = nullptr;
+    const char* path = nullptr;
+};
+
+double rate(uint64_t now, uint64_t before, double seconds)
+{
+    return seconds > 0.0 && now >= before ? static_cast<double>(now - before) / seconds : 0.0;
+}
+
+void print_frame(const dsa::StatsSample& now, const dsa::StatsSample* before, const Options& opt)
+{
+    const double seconds = before && now.timestamp_ns > before->timestamp_ns
+                               ? (now.timestamp_ns - before->timestamp_ns) / 1e9
+                               : 0.0;
+    const uint64_t age_ns = dsa::StatsExporter::now_ns() - now.timestamp_ns;
+    if(!opt.batch) std::printf("\x1b[H\x1b[2J");
+    std::printf("ealloc-top  pid %u  publish #%llu  %.1f s ago  window %.2f s\n", now.pid,
+                static_cast<unsigned long long>(now.publishes), age_ns / 1e9, seconds);
+
+    std::printf("%4s %18s %10s %10s %10s %6s %11s %9s %8s\n", "pool", "address", "size", "in use",
+                "peak", "peak%", "allocs/s", "fails/s", "fails");
+    const size_t pools = now.published_pools();
+    for(size_t i = 0; i < pools; ++i)
+    {
+        const dsa::StatsPoolSample& p = now.pools[i];
+        const dsa::StatsPoolSample* q = before && i < before->published_pools() ? &before->pools[i] : nullptr;
+        const bool same = q && q->memory == p.memory;
+        std::printf("%4zu %#18llx %10llu %10llu %10llu %5.1f%% %11.1f %9.1f %8llu\n", i,
+                    static_cast<unsigned long long>(p.memory), static_cast<unsigned long long>(p.size),
+                    static_cast<unsigned long long>(p.in_use), static_cast<unsigned long long>(p.peak_in_use),
+                    p.size ? 100.0 * p.peak_in_use / p.size : 0.0,
+                    same ? rate(p.allocations, q->allocations, seconds) : 0.0,
+                    same ? rate(p.failures, q->failures, seconds) : 0.0,
+                    static_cast<unsigned long long>(p.failures));
+    }
+    if(now.pool_count > pools)
+        std::printf("  ... %llu more pools not published (STATS_EXPORT_MAX_POOLS)\n",
+                    static_cast<unsigned long long>(now.pool_count - pools));
+
+    if(!now.class_stats)
+    {
+        std::printf("\nsize classes: not published (build with EALLOC_ENABLE_CLASS_STATS)\n");
+        return;
+    }
+    struct Row
+    {
+        size_t index;
+        double per_second;
+    };
+    std::vector<Row> rows;
+    for(size_t c = 0; c < dsa::StatsSegment::CLASSES; ++c)
+    {
+        const dsa::StatsClassSample& k = now.classes[c];
+        if(!k.allocations && !k.live) continue;
+        rows.push_back({c, before ? rate(k.allocations, before->classes[c].allocations, seconds) : 0.0});
+    }
+    std::sort(rows.begin(), rows.end(), [&](const Row& a, const Row& b) {
+        if(a.per_second != b.per_second) return a.per_second > b.per_second;
+        return now.classes[a.index].live > now.classes[b.index].live;
+    });
+    std::printf("\n%10s %10s %11s %14s %7s\n", "class >=", "live", "allocs/s", "allocations", "waste%");
+    for(size_t r = 0; r < rows.size() && r < opt.classes; ++r)
+    {
+        const dsa::StatsClassSample& k = now.classes[rows[r].index];
+        const double waste = k.granted_bytes
+                                 ? 100.0 * (k.granted_bytes - k.requested_bytes) / k.granted_bytes
+                                 : 0.0;
+        std::printf("%10llu %10llu %11.1f %14llu %6.1f%%\n", static_cast<unsigned long long>(k.min_size),
+                    static_cast<unsigned long long>(k.live), rows[r].per_second,
+                    static_cast<unsigned long long>(k.allocations), waste);
+    }
+}
+
+int usage_error()
+{
+    std::fprintf(stderr, "usage: ealloc_top [--interval MS] [--count N] [--classes N] [--batch] SHM_NAME\n"
+                         "       ealloc_top [options] --path FILE\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--interval") == 0 && i + 1 < argc)
+            opt.interval_ms = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 0));
+        else if(std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            opt.count = std::strtoul(argv[++i], nullptr, 0);
+        else if(std::strcmp(argv[i], "--classes") == 0 && i + 1 < argc)
+            opt.classes = std::strtoull(argv[++i], nullptr, 0);
+        else if(std::strcmp(argv[i], "--batch") == 0)
+            opt.batch = true;
+        else if(std::strcmp(argv[i], "--path") == 0 && i + 1 < argc)
+            opt.path = argv[++i];
+        else if(argv[i][0] == '-' || opt.shm_name)
+            return usage_error();
+        else
+            opt.shm_name = argv[i];
+    }
+    if(!opt.interval_ms || !(opt.shm_name || opt.path) || (opt.shm_name && opt.path)) return usage_error();
+
+    dsa::StatsReader reader;
+    const char* source = opt.path ? opt.path : opt.shm_name;
+    if(!(opt.path ? reader.attach_path(opt.path) : reader.attach_shm(opt.shm_name)))
+    {
+        std::fprintf(stderr, "%s: no eAlloc statistics segment of this build's layout\n", source);
+        return 1;
+    }
+
+    dsa::StatsSample previous, now;
+    bool have_previous = false;
+    for(unsigned long frame = 0; !opt.count || frame < opt.count; ++frame)
+    {
+        if(frame) std::this_thread::sleep_for(std::chrono::milliseconds(opt.interval_ms));
+        if(!reader.read(now))
+        {
+            std::fprintf(stderr, "%s: exporter kept the segment busy; skipping a frame\n", source);
+            continue;
+        }
+        print_frame(now, have_previous ? &previous : nullptr, opt);
+        std::fflush(stdout);
+        previous = now;
+        have_previous = true;
+    }
+    return 0;
+}